@@ -0,0 +1,444 @@
+#include "BMPEncoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include "Profiler.h"
+
+const size_t BMPRle8Encoder::kStripPixels;
+
+namespace {
+
+// Размер блока, который накапливается перед записью в поток
+const size_t kWriteBlockBytes = 1 << 20;
+
+// Таблицы подстановки: байт битовой карты (8 пикселей, младший бит — левый пиксель) в байты формата
+struct ExpansionTables {
+    uint8_t rgb[256][24]; // 8 пикселей по 3 байта BGR
+    uint8_t index[256][8]; // 8 индексов палитры
+    uint8_t gray[256][8]; // 8 яркостей для палитры оттенков серого
+    uint8_t reversed[256]; // Порядок бит для 1-битного BMP: старший бит — левый пиксель
+
+    ExpansionTables() {
+        for (int value = 0; value < 256; ++value) {
+            uint8_t bits = 0;
+            for (int pixel = 0; pixel < 8; ++pixel) {
+                bool black = (value >> pixel) & 1;
+                std::memset(rgb[value] + pixel * 3, black ? 0 : 255, 3);
+                index[value][pixel] = black ? 1 : 0;
+                gray[value][pixel] = black ? 0 : 255;
+                bits |= (black ? 1 : 0) << (7 - pixel);
+            }
+            reversed[value] = bits;
+        }
+    }
+};
+
+const ExpansionTables& expansionTables() {
+    static const ExpansionTables tables;
+    return tables;
+}
+
+void putLittleEndian(uint8_t*& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        *out++ = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// Наибольший заголовок: файл, информация об изображении и палитра из 256 цветов
+const size_t kMaxHeaderBytes = 14 + 40 + 256 * 4;
+
+// Заголовок файла, информационный заголовок и палитра (цвета BGR, старший байт не пишется) в header;
+// возвращает число байт
+size_t buildHeader(uint8_t* header, int width, int height, int bitsPerPixel, uint32_t compression,
+    uint32_t imageDataSize, const Color* palette, size_t colors) {
+    uint8_t* out = header;
+    uint32_t dataOffset = static_cast<uint32_t>(14 + 40 + 4 * colors);
+
+    // Заголовок файла
+    *out++ = 'B';
+    *out++ = 'M';
+    putLittleEndian(out, dataOffset + imageDataSize, 4); // Размер файла
+    putLittleEndian(out, 0, 4); // Зарезервированное поле
+    putLittleEndian(out, dataOffset, 4); // Смещение до начала данных изображения
+
+    // Информационный заголовок
+    putLittleEndian(out, 40, 4); // Размер информационного заголовка
+    putLittleEndian(out, static_cast<uint32_t>(width), 4); // Ширина изображения
+    putLittleEndian(out, static_cast<uint32_t>(height), 4); // Высота изображения
+    putLittleEndian(out, 1, 2); // Число плоскостей
+    putLittleEndian(out, static_cast<uint32_t>(bitsPerPixel), 2); // Глубина цвета
+    putLittleEndian(out, compression, 4); // Тип сжатия
+    putLittleEndian(out, imageDataSize, 4); // Размер данных изображения
+    putLittleEndian(out, 2835, 4); // Горизонтальное разрешение (пикселей на метр)
+    putLittleEndian(out, 2835, 4); // Вертикальное разрешение (пикселей на метр)
+    putLittleEndian(out, static_cast<uint32_t>(colors), 4); // Количество используемых цветов
+    putLittleEndian(out, 0, 4); // Количество основных цветов
+
+    for (size_t i = 0; i < colors; ++i) {
+        putLittleEndian(out, palette[i] & 0x00FFFFFF, 4);
+    }
+    return out - header;
+}
+
+void grayPalette(Color* palette) {
+    for (uint32_t level = 0; level < 256; ++level) {
+        palette[level] = level | (level << 8) | (level << 16);
+    }
+}
+
+} // namespace
+
+BMPEncoder::BMPEncoder(BMPFormat format) : m_format(format) {}
+
+int BMPEncoder::bitsPerPixel() const {
+    switch (m_format) {
+    case BMPFormat::Palette8:
+    case BMPFormat::Gray8:
+        return 8;
+    case BMPFormat::Palette1:
+        return 1;
+    default:
+        return 24;
+    }
+}
+
+size_t BMPEncoder::paletteBytes() const {
+    return 4 * paletteColors();
+}
+
+size_t BMPEncoder::paletteColors() const {
+    switch (m_format) {
+    case BMPFormat::Rgb24:
+        return 0;
+    case BMPFormat::Gray8:
+        return 256;
+    default:
+        return 2;
+    }
+}
+
+size_t BMPEncoder::rowBytes(int width) const {
+    size_t bits = static_cast<size_t>(std::max(width, 0)) * bitsPerPixel();
+    return (bits + 31) / 32 * 4;
+}
+
+size_t BMPEncoder::fileSize(int width, int height) const {
+    return 14 + 40 + paletteBytes() + rowBytes(width) * std::max(height, 0);
+}
+
+void BMPEncoder::writeHeader(std::ostream& file, int width, int height) const {
+    // Палитра: оттенки серого по возрастанию яркости или индекс 0 — белый, индекс 1 — чёрный
+    Color palette[256] = { kWhite, kBlack };
+    if (m_format == BMPFormat::Gray8) {
+        grayPalette(palette);
+    }
+    uint8_t header[kMaxHeaderBytes];
+    size_t bytes = buildHeader(header, width, height, bitsPerPixel(), 0,
+        static_cast<uint32_t>(rowBytes(width) * height), palette, paletteColors());
+    file.write(reinterpret_cast<const char*>(header), bytes);
+    GRAPH_PROFILE_COUNT("bytes.written", bytes);
+}
+
+void BMPEncoder::encodeRow(const uint64_t* words, int width, uint8_t* destination) const {
+    encodeSpan(words, 0, width, destination);
+
+    // Дополнение строки нулями до кратной 4 байтам длины
+    size_t usedBytes = (static_cast<size_t>(std::max(width, 0)) * bitsPerPixel() + 7) / 8;
+    std::memset(destination + usedBytes, 0, rowBytes(width) - usedBytes);
+}
+
+void BMPEncoder::encodeSpan(const uint64_t* words, int x0, int x1, uint8_t* destination) const {
+    const ExpansionTables& tables = expansionTables();
+    const int bytesPerGroup = bitsPerPixel(); // Байт на группу из 8 пикселей
+    uint8_t* out = destination + static_cast<size_t>(x0 / 8) * bytesPerGroup;
+
+    for (int i = x0 / 8; i < (x1 + 7) / 8; ++i) {
+        uint8_t value = static_cast<uint8_t>(words[i >> 3] >> (8 * (i & 7)));
+        int pixels = std::min(8, x1 - i * 8);
+        switch (m_format) {
+        case BMPFormat::Rgb24:
+            std::memcpy(out, tables.rgb[value], pixels * 3);
+            out += pixels * 3;
+            break;
+        case BMPFormat::Palette8:
+            std::memcpy(out, tables.index[value], pixels);
+            out += pixels;
+            break;
+        case BMPFormat::Gray8:
+            std::memcpy(out, tables.gray[value], pixels);
+            out += pixels;
+            break;
+        case BMPFormat::Palette1:
+            *out++ = tables.reversed[value];
+            break;
+        }
+    }
+}
+
+void BMPEncoder::writeImageData(std::ostream& file, const Bitmap& bitmap) {
+    GRAPH_PROFILE_SCOPE("encode.image");
+    const size_t bytesPerRow = rowBytes(bitmap.width());
+    if (bytesPerRow == 0) {
+        return;
+    }
+    const size_t rowsPerBlock = std::max<size_t>(kWriteBlockBytes / bytesPerRow, 1);
+    m_buffer.resize(rowsPerBlock * bytesPerRow);
+
+    // Строки BMP идут снизу вверх; у полосы — от её последней строки к первой
+    size_t rowsInBuffer = 0;
+    for (int y = bitmap.top() + bitmap.height() - 1; y >= bitmap.top(); --y) {
+        encodeRow(bitmap.row(y), bitmap.width(), m_buffer.data() + rowsInBuffer * bytesPerRow);
+        if (++rowsInBuffer == rowsPerBlock || y == bitmap.top()) {
+            file.write(reinterpret_cast<const char*>(m_buffer.data()), rowsInBuffer * bytesPerRow);
+            GRAPH_PROFILE_COUNT("bytes.written", rowsInBuffer * bytesPerRow);
+            rowsInBuffer = 0;
+        }
+    }
+}
+
+void BMPEncoder::writeImageData(std::ostream& file, const Framebuffer& framebuffer) {
+    GRAPH_PROFILE_SCOPE("encode.image");
+    const int width = framebuffer.width();
+    const size_t bytesPerRow = (static_cast<size_t>(width) * 3 + 3) & ~size_t(3);
+    if (width == 0) {
+        return;
+    }
+    const size_t rowsPerBlock = std::max<size_t>(kWriteBlockBytes / bytesPerRow, 1);
+    m_buffer.resize(rowsPerBlock * bytesPerRow);
+
+    // Пиксели BGRA переписываются в BGR, строки снизу вверх
+    size_t rowsInBuffer = 0;
+    for (int y = framebuffer.height() - 1; y >= 0; --y) {
+        const Color* pixels = framebuffer.row(y);
+        uint8_t* out = m_buffer.data() + rowsInBuffer * bytesPerRow;
+        for (int x = 0; x < width; ++x) {
+            out[0] = static_cast<uint8_t>(pixels[x]);
+            out[1] = static_cast<uint8_t>(pixels[x] >> 8);
+            out[2] = static_cast<uint8_t>(pixels[x] >> 16);
+            out += 3;
+        }
+        std::memset(out, 0, m_buffer.data() + (rowsInBuffer + 1) * bytesPerRow - out);
+        if (++rowsInBuffer == rowsPerBlock || y == 0) {
+            file.write(reinterpret_cast<const char*>(m_buffer.data()), rowsInBuffer * bytesPerRow);
+            GRAPH_PROFILE_COUNT("bytes.written", rowsInBuffer * bytesPerRow);
+            rowsInBuffer = 0;
+        }
+    }
+}
+
+void BMPEncoder::writeImageData(std::ostream& file, const GrayImage& image) {
+    GRAPH_PROFILE_SCOPE("encode.image");
+    const int width = image.width();
+    const size_t bytesPerRow = (static_cast<size_t>(width) + 3) & ~size_t(3);
+    if (width == 0) {
+        return;
+    }
+    const size_t rowsPerBlock = std::max<size_t>(kWriteBlockBytes / bytesPerRow, 1);
+    m_buffer.resize(rowsPerBlock * bytesPerRow);
+
+    // Яркости совпадают с индексами палитры, строки снизу вверх
+    size_t rowsInBuffer = 0;
+    for (int y = image.height() - 1; y >= 0; --y) {
+        uint8_t* out = m_buffer.data() + rowsInBuffer * bytesPerRow;
+        std::memcpy(out, image.row(y), width);
+        std::memset(out + width, 0, bytesPerRow - width);
+        if (++rowsInBuffer == rowsPerBlock || y == 0) {
+            file.write(reinterpret_cast<const char*>(m_buffer.data()), rowsInBuffer * bytesPerRow);
+            GRAPH_PROFILE_COUNT("bytes.written", rowsInBuffer * bytesPerRow);
+            rowsInBuffer = 0;
+        }
+    }
+}
+
+bool BMPEncoder::encode(std::ostream& file, const Bitmap& bitmap) {
+    writeHeader(file, bitmap.width(), bitmap.height());
+    writeImageData(file, bitmap);
+    return file.good();
+}
+
+bool BMPEncoder::encode(std::ostream& file, const Framebuffer& framebuffer) {
+    BMPFormat format = m_format;
+    m_format = BMPFormat::Rgb24;
+    writeHeader(file, framebuffer.width(), framebuffer.height());
+    m_format = format;
+    writeImageData(file, framebuffer);
+    return file.good();
+}
+
+bool BMPEncoder::encode(std::ostream& file, const GrayImage& image) {
+    BMPFormat format = m_format;
+    m_format = BMPFormat::Gray8;
+    writeHeader(file, image.width(), image.height());
+    m_format = format;
+    writeImageData(file, image);
+    return file.good();
+}
+
+BMPRle8Encoder::BMPRle8Encoder(ThreadPool* pool) : m_pool(pool) {}
+
+void BMPRle8Encoder::encodeRow(const uint8_t* indices, int width, std::vector<uint8_t>& out) {
+    auto runAt = [&](int x) {
+        int run = 1;
+        while (x + run < width && run < 255 && indices[x + run] == indices[x]) {
+            ++run;
+        }
+        return run;
+    };
+    for (int x = 0; x < width;) {
+        int run = runAt(x);
+        if (run >= 3) {
+            out.push_back(static_cast<uint8_t>(run));
+            out.push_back(indices[x]);
+            x += run;
+            continue;
+        }
+        // Участок без серий длиннее двух пикселей. Неупакованный отрезок короче трёх пикселей
+        // записать нельзя (0, 1 и 2 после нуля — управляющие коды), такие участки идут парами
+        const int start = x;
+        while (x < width && x - start < 255) {
+            run = runAt(x);
+            if (run >= 3) {
+                break;
+            }
+            x += std::min(run, 255 - (x - start));
+        }
+        const int count = x - start;
+        if (count >= 3) {
+            out.push_back(0);
+            out.push_back(static_cast<uint8_t>(count));
+            out.insert(out.end(), indices + start, indices + x);
+            if (count % 2 != 0) {
+                out.push_back(0); // Отрезок выравнивается до чётной длины
+            }
+            continue;
+        }
+        for (int i = start; i < x;) {
+            int repeat = (i + 1 < x && indices[i + 1] == indices[i]) ? 2 : 1;
+            out.push_back(static_cast<uint8_t>(repeat));
+            out.push_back(indices[i]);
+            i += repeat;
+        }
+    }
+    out.push_back(0); // Конец строки
+    out.push_back(0);
+}
+
+bool BMPRle8Encoder::encodeIndexed(std::ostream& file, int width, int height, const std::vector<Color>& palette, const RowSource& rowSource) {
+    GRAPH_PROFILE_SCOPE("encode.image");
+    width = std::max(width, 0);
+    height = std::max(height, 0);
+    const int rowsPerStrip = static_cast<int>(std::max<size_t>(kStripPixels / std::max(width, 1), 1));
+    const size_t stripCount = (static_cast<size_t>(height) + rowsPerStrip - 1) / rowsPerStrip;
+
+    // Строки BMP идут снизу вверх: полоса strip содержит строки файла начиная с strip * rowsPerStrip
+    std::vector<std::vector<uint8_t>> strips(stripCount);
+    auto compressStrip = [&](size_t strip) {
+        std::vector<uint8_t> indices(width);
+        const int first = static_cast<int>(strip) * rowsPerStrip;
+        const int last = std::min(first + rowsPerStrip, height);
+        for (int fileRow = first; fileRow < last; ++fileRow) {
+            rowSource(height - 1 - fileRow, indices.data());
+            encodeRow(indices.data(), width, strips[strip]);
+        }
+    };
+    if (m_pool != nullptr) {
+        m_pool->run(stripCount, compressStrip);
+    }
+    else {
+        for (size_t strip = 0; strip < stripCount; ++strip) {
+            compressStrip(strip);
+        }
+    }
+
+    size_t dataBytes = 2; // Код конца изображения
+    for (const std::vector<uint8_t>& strip : strips) {
+        dataBytes += strip.size();
+    }
+    uint8_t header[kMaxHeaderBytes];
+    const uint32_t kRle8 = 1;
+    size_t headerBytes = buildHeader(header, width, height, 8, kRle8, static_cast<uint32_t>(dataBytes), palette.data(), palette.size());
+    file.write(reinterpret_cast<const char*>(header), headerBytes);
+    for (const std::vector<uint8_t>& strip : strips) {
+        file.write(reinterpret_cast<const char*>(strip.data()), strip.size());
+    }
+    const char endOfBitmap[2] = { 0, 1 };
+    file.write(endOfBitmap, 2);
+    GRAPH_PROFILE_COUNT("bytes.written", headerBytes + dataBytes);
+    return file.good();
+}
+
+bool BMPRle8Encoder::encode(std::ostream& file, const Bitmap& bitmap) {
+    const BMPEncoder expander(BMPFormat::Palette8);
+    std::vector<Color> palette = { kWhite, kBlack };
+    return encodeIndexed(file, bitmap.width(), bitmap.height(), palette, [&](int y, uint8_t* indices) {
+        expander.encodeSpan(bitmap.row(bitmap.top() + y), 0, bitmap.width(), indices);
+    });
+}
+
+bool BMPRle8Encoder::encode(std::ostream& file, const GrayImage& image) {
+    std::vector<Color> palette(256);
+    grayPalette(palette.data());
+    return encodeIndexed(file, image.width(), image.height(), palette, [&](int y, uint8_t* indices) {
+        std::memcpy(indices, image.row(y), image.width());
+    });
+}
+
+bool BMPRle8Encoder::encode(std::ostream& file, const Framebuffer& framebuffer) {
+    // Частоты цветов; соседние пиксели обычно одного цвета, поэтому считаются серии
+    std::unordered_map<Color, uint64_t> frequencies;
+    for (int y = 0; y < framebuffer.height(); ++y) {
+        const Color* pixels = framebuffer.row(y);
+        for (int x = 0; x < framebuffer.width();) {
+            int end = x + 1;
+            while (end < framebuffer.width() && pixels[end] == pixels[x]) {
+                ++end;
+            }
+            frequencies[pixels[x] | 0xFF000000u] += end - x;
+            x = end;
+        }
+    }
+    std::vector<std::pair<uint64_t, Color>> colors;
+    for (const auto& entry : frequencies) {
+        colors.emplace_back(entry.second, entry.first);
+    }
+    std::sort(colors.begin(), colors.end(), [](const std::pair<uint64_t, Color>& a, const std::pair<uint64_t, Color>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    std::vector<Color> palette;
+    std::unordered_map<Color, uint8_t> indexOf;
+    for (size_t i = 0; i < colors.size(); ++i) {
+        const Color color = colors[i].second;
+        if (i < 256) {
+            indexOf[color] = static_cast<uint8_t>(i);
+            palette.push_back(color);
+            continue;
+        }
+        // Цвет вне палитры — ближайший по сумме квадратов разностей каналов
+        int64_t bestDistance = INT64_MAX;
+        for (size_t j = 0; j < palette.size(); ++j) {
+            int64_t distance = 0;
+            for (int shift = 0; shift < 24; shift += 8) {
+                int64_t delta = static_cast<int64_t>((color >> shift) & 0xFF) - ((palette[j] >> shift) & 0xFF);
+                distance += delta * delta;
+            }
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                indexOf[color] = static_cast<uint8_t>(j);
+            }
+        }
+    }
+    return encodeIndexed(file, framebuffer.width(), framebuffer.height(), palette, [&](int y, uint8_t* indices) {
+        const Color* pixels = framebuffer.row(y);
+        Color last = 0;
+        uint8_t index = 0;
+        for (int x = 0; x < framebuffer.width(); ++x) {
+            const Color color = pixels[x] | 0xFF000000u;
+            if (x == 0 || color != last) {
+                last = color;
+                index = indexOf.find(color)->second;
+            }
+            indices[x] = index;
+        }
+    });
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+#include "Bitmap.h"
+#include "Framebuffer.h"
+#include "ImageEncoder.h"
+
+// Формат пикселей выходного BMP
+enum class BMPFormat {
+    Rgb24, // 24 бита на пиксель, без палитры
+    Palette8, // 8 бит на пиксель, палитра из двух цветов
+    Palette1, // 1 бит на пиксель, палитра из двух цветов
+    Gray8 // 8 бит на пиксель, палитра из 256 оттенков серого (индекс — яркость)
+};
+
+// Кодировщик монохромной битовой карты (или цветного буфера кадра) в BMP. Строки дополняются до кратной 4 байтам длины,
+// биты разворачиваются в байты по таблицам подстановки, а данные пишутся крупными блоками
+// через переиспользуемый буфер. Установленный бит — чёрный пиксель, сброшенный — белый.
+class BMPEncoder : public ImageEncoder {
+public:
+    explicit BMPEncoder(BMPFormat format = BMPFormat::Rgb24);
+
+    void setFormat(BMPFormat format) { m_format = format; }
+    BMPFormat format() const { return m_format; }
+
+    // Размер строки пикселей в байтах с учётом выравнивания до 4 байт
+    size_t rowBytes(int width) const;
+    // Полный размер файла для изображения заданного размера
+    size_t fileSize(int width, int height) const;
+
+    void writeHeader(std::ostream& file, int width, int height) const;
+    // Строки карты снизу вверх. Полосы изображения, переданные по очереди снизу вверх,
+    // дают те же данные, что и вся карта целиком
+    void writeImageData(std::ostream& file, const Bitmap& bitmap);
+    // Цветной буфер пишется всегда в 24 бита, заголовок должен быть записан в формате Rgb24
+    void writeImageData(std::ostream& file, const Framebuffer& framebuffer);
+    // Полутоновое изображение пишется в 8 бит, заголовок должен быть записан в формате Gray8
+    void writeImageData(std::ostream& file, const GrayImage& image);
+
+    // Заголовок и данные изображения; возвращает false при ошибке записи. Буфер кадра пишется
+    // в формате Rgb24, полутоновое изображение — в Gray8, выбранный формат при этом не меняется
+    bool encode(std::ostream& file, const Bitmap& bitmap) override;
+    bool encode(std::ostream& file, const Framebuffer& framebuffer) override;
+    bool encode(std::ostream& file, const GrayImage& image) override;
+
+    // Разворачивание одной строки битовой карты в байты выбранного формата (с дополнением нулями)
+    void encodeRow(const uint64_t* words, int width, uint8_t* destination) const;
+    // Разворачивание пикселей [x0, x1) строки: x0 кратен 8, байты пишутся на свои места
+    // в строке destination, остальная часть строки не меняется
+    void encodeSpan(const uint64_t* words, int x0, int x1, uint8_t* destination) const;
+    // Смещение данных изображения от начала файла
+    size_t dataOffset() const { return 14 + 40 + paletteBytes(); }
+
+private:
+    size_t paletteBytes() const;
+    size_t paletteColors() const;
+    int bitsPerPixel() const;
+
+    BMPFormat m_format;
+    std::vector<uint8_t> m_buffer; // Буфер для записи нескольких строк за один вызов
+};
+
+// Кодировщик в 8-битный BMP с палитрой и сжатием RLE8: серии одинаковых пикселей записываются парами
+// «число повторов, индекс», участки без повторов — неупакованными отрезками. Пустая строка шириной
+// 3160 пикселей занимает 28 байт вместо 3160. Монохромная карта пишется с палитрой из двух цветов,
+// полутоновое изображение — с палитрой оттенков серого, буфер кадра — с палитрой своих цветов;
+// если цветов больше 256, в палитру входят 256 самых частых, а остальные заменяются ближайшими из них.
+// Размер сжатых данных нужен в заголовке, поэтому полосы строк сжимаются в память (параллельно на pool)
+// и записываются после заголовка
+class BMPRle8Encoder : public ImageEncoder {
+public:
+    explicit BMPRle8Encoder(ThreadPool* pool = nullptr);
+
+    bool encode(std::ostream& file, const Bitmap& bitmap) override;
+    bool encode(std::ostream& file, const Framebuffer& framebuffer) override;
+    bool encode(std::ostream& file, const GrayImage& image) override;
+
+    // Сжатие строки индексов палитры вместе с кодом конца строки
+    static void encodeRow(const uint8_t* indices, int width, std::vector<uint8_t>& out);
+
+    static const size_t kStripPixels = 1 << 20; // Пикселей в полосе, которую сжимает одно задание
+
+private:
+    // rowSource записывает индексы палитры строки y (сверху вниз) в indices
+    typedef std::function<void(int, uint8_t*)> RowSource;
+    bool encodeIndexed(std::ostream& file, int width, int height, const std::vector<Color>& palette, const RowSource& rowSource);
+
+    ThreadPool* m_pool;
+};
@@ -1,74 +1,445 @@
 #include "BMPGenerator.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include "DensityMap.h"
+#include "Font5x5.h"
+#include "Profiler.h"
+
+const size_t BMPGenerator::kColorMasks;
+const int BMPGenerator::kColorBlendRows;
+
+namespace {
+
+// Деление с округлением вниз (знаменатель положителен)
+int64_t floorDiv(int64_t numerator, int64_t denominator) {
+    int64_t quotient = numerator / denominator;
+    return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+}
+
+int64_t ceilDiv(int64_t numerator, int64_t denominator) {
+    return -floorDiv(-numerator, denominator);
+}
+
+// Круг вершины: пиксель (xc + dx, yc + dy) закрашен при dx^2 + dy^2 <= 7^2,
+// то есть при |dx| <= kCircleHalfWidth[dy + 7] = floor(sqrt(49 - dy^2))
+constexpr int kCircleRadius = 7;
+constexpr int kCircleHalfWidth[2 * kCircleRadius + 1] = { 0, 3, 4, 5, 6, 6, 6, 7, 6, 6, 6, 5, 4, 3, 0 };
+
+// Покрытия сглаженного круга вершины: clamp(7.5 - расстояние до центра, 0, 1) в долях 255
+struct CircleStamp {
+    static const int kSize = 2 * kCircleRadius + 3;
+    uint8_t coverage[kSize][kSize];
+
+    CircleStamp() {
+        for (int i = 0; i < kSize; ++i) {
+            for (int j = 0; j < kSize; ++j) {
+                int dx = j - kSize / 2;
+                int dy = i - kSize / 2;
+                double value = kCircleRadius + 0.5 - std::sqrt(static_cast<double>(dx * dx + dy * dy));
+                coverage[i][j] = static_cast<uint8_t>(std::min(std::max(value, 0.0), 1.0) * 255 + 0.5);
+            }
+        }
+    }
+};
+
+const CircleStamp& circleStamp() {
+    static const CircleStamp stamp;
+    return stamp;
+}
+
+// Округления без вызова библиотечных floor и ceil (значения заведомо лежат в диапазоне int)
+int floorToInt(float value) {
+    int result = static_cast<int>(value);
+    return result - (value < result ? 1 : 0);
+}
+
+int ceilToInt(float value) {
+    int result = static_cast<int>(value);
+    return result + (value > result ? 1 : 0);
+}
+
+// Пара (плитка, номер ребра или вершины)
+typedef std::pair<uint32_t, uint32_t> TileRef;
+
+// Корзины плиток в формате CSR по парам из всех частей: подсчёт, префиксные суммы, заполнение
+void buildTileBins(size_t tiles, const std::vector<std::vector<TileRef>>& refs, std::vector<uint32_t>& offsets, std::vector<uint32_t>& bins) {
+    offsets.assign(tiles + 1, 0);
+    for (const auto& part : refs) {
+        for (const auto& ref : part) {
+            ++offsets[ref.first + 1];
+        }
+    }
+    for (size_t tile = 0; tile < tiles; ++tile) {
+        offsets[tile + 1] += offsets[tile];
+    }
+    bins.resize(offsets[tiles]);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& part : refs) {
+        for (const auto& ref : part) {
+            bins[fill[ref.first]++] = ref.second;
+        }
+    }
+}
+
+} // namespace
+
+// На шаге i отрезок находится на главной оси в a0 + sa * i, на второй — в b0 + sb * k(i),
+// где k(i) = floor((2 * minor * i + major - 1) / (2 * major)); это замкнутая форма того же
+// целочисленного алгоритма Брезенхэма, поэтому отсечение не меняет ни одного пикселя
+BresenhamLine::BresenhamLine(int x0, int y0, int x1, int y1) : x0(x0), y0(y0) {
+    int dx = std::abs(x1 - x0);
+    int dy = std::abs(y1 - y0);
+    sx = x0 < x1 ? 1 : -1;
+    sy = y0 < y1 ? 1 : -1;
+    steep = dy > dx;
+    major = std::max(dx, dy);
+    minor = std::min(dx, dy);
+}
+
+void BresenhamLine::pixel(int64_t i, int& x, int& y) const {
+    int64_t offset = floorDiv(2 * minor * i + major - 1, 2 * major);
+    x = x0 + sx * static_cast<int>(steep ? offset : i);
+    y = y0 + sy * static_cast<int>(steep ? i : offset);
+}
+
+bool BresenhamLine::clip(const ClipRect& rect, int64_t& first, int64_t& last) const {
+    if (major == 0 || rect.x0 >= rect.x1 || rect.y0 >= rect.y1) {
+        return false;
+    }
+    // Главная ось ограничивает номера шагов напрямую
+    int a0 = steep ? y0 : x0;
+    int sa = steep ? sy : sx;
+    int aMin = steep ? rect.y0 : rect.x0;
+    int aMax = (steep ? rect.y1 : rect.x1) - 1;
+    first = sa > 0 ? int64_t(aMin) - a0 : int64_t(a0) - aMax;
+    last = sa > 0 ? int64_t(aMax) - a0 : int64_t(a0) - aMin;
+    first = std::max<int64_t>(first, 0);
+    last = std::min<int64_t>(last, major - 1);
+
+    // Вторая ось ограничивает смещение k, а k(i) не убывает — обращаем формулу шага
+    int b0 = steep ? x0 : y0;
+    int sb = steep ? sx : sy;
+    int bMin = steep ? rect.x0 : rect.y0;
+    int bMax = (steep ? rect.x1 : rect.y1) - 1;
+    int64_t kMin = std::max<int64_t>(sb > 0 ? int64_t(bMin) - b0 : int64_t(b0) - bMax, 0);
+    int64_t kMax = std::min<int64_t>(sb > 0 ? int64_t(bMax) - b0 : int64_t(b0) - bMin, minor);
+    if (kMin > kMax) {
+        return false;
+    }
+    if (minor > 0) {
+        first = std::max(first, ceilDiv(2 * major * kMin - major + 1, 2 * minor));
+        last = std::min(last, ceilDiv(2 * major * kMax + major + 1, 2 * minor) - 1);
+    }
+    return first <= last;
+}
+
 //Конструктор класса BMPGenerator, который инициализирует объект генератора изображения BMP с заданными шириной и высотой, а также векторами вершин и рёбер.
 BMPGenerator::BMPGenerator(int width, int height, const std::vector<Vertex>& vertices, const std::vector<Edge>& edges)  
-    : m_width(width), m_height(height), m_vertices(vertices), m_edges(edges) {} 
+    : BMPGenerator(width, height, GraphStorage(vertices, edges)) {} 
+
+BMPGenerator::BMPGenerator(int width, int height, GraphStorage&& graph)
+    : m_width(width), m_height(height), m_graph(std::move(graph)), m_indexStale(false), m_strokeWidth(1.0f), m_imageFormat(BMPFormat::Rgb24), m_outputFormat(ImageFormat::Bmp), m_externalPool(nullptr) {
+    m_index.build(m_graph.vertexCount(), m_graph.endpoints());
+}
 
 //Функция которая создаёт и записывает изображение в файл
-void BMPGenerator::generate(const std::string& filename) {
+void BMPGenerator::generate(const std::string& filename, BMPFormat format) {
+    if (m_outputFormat != ImageFormat::Bmp) {
+        Bitmap bitmap(m_width, m_height);
+        renderBitmap(bitmap);
+        writeEncoded(filename, bitmap);
+        return;
+    }
+    // Карта огромного холста не помещается в память целиком — такие изображения пишутся полосами
+    if (static_cast<uint64_t>(std::max(m_width, 0)) * std::max(m_height, 0) / 8 > kStreamingThreshold) {
+        generateStreaming(filename, format);
+        return;
+    }
     std::ofstream file(filename, std::ios::binary);
+    m_encoder.setFormat(format);
     writeHeader(file);
     writeImageData(file);
     file.close();
 }
 
-void BMPGenerator::writeHeader(std::ofstream& file) {
-    int imageDataSize = m_width * m_height * 3; // Вычисление размера данных изображения
+void BMPGenerator::generateStreaming(const std::string& filename, BMPFormat format, int bandHeight) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return;
+    }
+    encodeStreaming(file, format, bandHeight);
+}
 
-    // Запись заголовка BMP
-    file.put('B').put('M'); // Числа для определения формата файла
-    writeInt(file, 14 + 40 + imageDataSize); // Размер файла
-    writeInt(file, 0); // Зарезервированное поле
-    writeInt(file, 14 + 40); // Смещение до начала данных изображения
+void BMPGenerator::encodeStreaming(std::ostream& file, BMPFormat format, int bandHeight) {
+    GRAPH_PROFILE_SCOPE("render.streaming");
+    m_encoder.setFormat(format);
+    m_encoder.writeHeader(file, m_width, m_height);
+    if (m_width <= 0 || m_height <= 0) {
+        return;
+    }
+    if (bandHeight <= 0) {
+        size_t rowBytes = (static_cast<size_t>(m_width) + 63) / 64 * sizeof(uint64_t);
+        bandHeight = static_cast<int>(std::min<size_t>(std::max<size_t>(kStreamingBandBytes / rowBytes, 1), m_height));
+    }
 
-    // Запись информации о заголовке изображения
-    writeInt(file, 40); // Размер информационного заголовка
-    writeInt(file, m_width); // Ширина изображения
-    writeInt(file, m_height); // Высота изображения
-    writeShort(file, 1); // Число плоскостей
-    writeShort(file, 24); // Глубина цвета (24 бита на пиксель)
-    writeInt(file, 0); // Тип сжатия 
-    writeInt(file, imageDataSize); // Размер данных изображения
-    writeInt(file, 2835); // Горизонтальное разрешение (пикселей на метр)
-    writeInt(file, 2835); // Вертикальное разрешение (пикселей на метр)
-    writeInt(file, 0); // Количество используемых цветов (0 - все цвета)
-    writeInt(file, 0); // Количество основных цветов (0 - все цвета)
+    Bitmap band;
+    sweepBands(bandHeight, 0, [&](const ClipRect& clip, const std::vector<uint32_t>& edges, const std::vector<uint32_t>& vertices) {
+        band.reset(m_width, clip.y1 - clip.y0, clip.y0);
+        for (uint32_t i : edges) {
+            Edge edge = m_graph.edge(i);
+            drawLine(band, clip, m_graph.x(edge.vertex1), m_graph.y(edge.vertex1),
+                m_graph.x(edge.vertex2), m_graph.y(edge.vertex2));
+        }
+        for (uint32_t i : vertices) {
+            drawVertex(band, clip, i);
+        }
+        m_encoder.writeImageData(file, band);
+    });
 }
 
+void BMPGenerator::sweepBands(int bandHeight, int edgeMargin, const BandCallback& drawBand) const {
+    // Полосы идут снизу вверх, как строки BMP. Рёбра и вершины отсортированы по убыванию нижней строки:
+    // элемент становится активным, когда очередная полоса доходит до его нижнего края,
+    // и удаляется из активных, когда полоса поднимается выше его верхнего края
+    std::vector<uint32_t> edgeOrder(m_graph.edgeCount()), vertexOrder(m_graph.vertexCount());
+    std::vector<ClipRect> vertexBox(m_graph.vertexCount());
+    // Границы рёбер считаются один раз: сортировка обращается к ним O(E log E) раз
+    std::vector<int> edgeTops(m_graph.edgeCount()), edgeBottoms(m_graph.edgeCount());
+    for (size_t i = 0; i < m_graph.edgeCount(); ++i) {
+        edgeOrder[i] = static_cast<uint32_t>(i);
+        const int y1 = m_graph.y(m_graph.vertex1(i)), y2 = m_graph.y(m_graph.vertex2(i));
+        edgeTops[i] = std::min(y1, y2) - edgeMargin;
+        edgeBottoms[i] = std::max(y1, y2) + edgeMargin;
+    }
+    for (size_t i = 0; i < m_graph.vertexCount(); ++i) {
+        vertexOrder[i] = static_cast<uint32_t>(i);
+        vertexBox[i] = vertexBounds(i);
+    }
+    std::sort(edgeOrder.begin(), edgeOrder.end(), [&](uint32_t a, uint32_t b) { return edgeBottoms[a] > edgeBottoms[b]; });
+    std::sort(vertexOrder.begin(), vertexOrder.end(), [&](uint32_t a, uint32_t b) { return vertexBox[a].y1 > vertexBox[b].y1; });
 
+    std::vector<uint32_t> activeEdges, activeVertices;
+    size_t nextEdge = 0, nextVertex = 0;
+    for (int bandTop = (m_height - 1) / bandHeight * bandHeight; bandTop >= 0; bandTop -= bandHeight) {
+        int bandBottom = std::min(bandTop + bandHeight, m_height);
+        ClipRect clip = { 0, bandTop, m_width, bandBottom };
 
+        while (nextEdge < edgeOrder.size() && edgeBottoms[edgeOrder[nextEdge]] >= bandTop) {
+            activeEdges.push_back(edgeOrder[nextEdge++]);
+        }
+        activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(),
+            [&](uint32_t i) { return edgeTops[i] >= bandBottom; }), activeEdges.end());
+        while (nextVertex < vertexOrder.size() && vertexBox[vertexOrder[nextVertex]].y1 > bandTop) {
+            activeVertices.push_back(vertexOrder[nextVertex++]);
+        }
+        activeVertices.erase(std::remove_if(activeVertices.begin(), activeVertices.end(),
+            [&](uint32_t i) { return vertexBox[i].y0 >= bandBottom; }), activeVertices.end());
+
+        drawBand(clip, activeEdges, activeVertices);
+    }
+}
+
+void BMPGenerator::writeHeader(std::ofstream& file) {
+    // Заголовок BMP собирается в памяти и записывается одним вызовом
+    m_encoder.writeHeader(file, m_width, m_height);
+}
 
 void BMPGenerator::writeImageData(std::ofstream& file) {
-    std::vector<std::vector<bool>> bitmap(m_height, std::vector<bool>(m_width, false)); // Создание битовой карты
+    Bitmap bitmap(m_width, m_height); // Создание битовой карты
+    renderBitmap(bitmap);
+
+    // Запись данных изображения в файл блоками строк с выравниванием до 4 байт
+    m_encoder.writeImageData(file, bitmap);
+}
+
+void BMPGenerator::renderBitmap(Bitmap& bitmap) {
+    // Большие графы рисуются по плиткам на всех ядрах, небольшие — в одном потоке
+    if (m_graph.edgeCount() + m_graph.vertexCount() >= kTiledRenderThreshold && threadPool().size() > 1) {
+        renderTiled(bitmap, threadPool());
+    }
+    else {
+        render(bitmap);
+    }
+}
+
+template<typename Image>
+void BMPGenerator::writeEncoded(const std::string& filename, const Image& image) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return;
+    }
+    if (!createImageEncoder(m_outputFormat, &threadPool())->encode(file, image)) {
+        std::cerr << "Error writing file: " << filename << std::endl;
+    }
+}
+
+//Отрисовка рёбер и вершин графа в битовую карту размером m_width x m_height
+void BMPGenerator::render(Bitmap& bitmap) {
+    ClipRect canvas = { 0, 0, m_width, m_height };
 
     // Отрисовка ребер графа на изображении
-    for (const auto& edge : m_edges) {
-        drawLine(bitmap, m_vertices[edge.vertex1].x, m_vertices[edge.vertex1].y,
-            m_vertices[edge.vertex2].x, m_vertices[edge.vertex2].y);
+    {
+        GRAPH_PROFILE_SCOPE("render.edges");
+        for (size_t i = 0; i < m_graph.edgeCount(); ++i) {
+            const uint32_t v1 = m_graph.vertex1(i), v2 = m_graph.vertex2(i);
+            drawLine(bitmap, canvas, m_graph.x(v1), m_graph.y(v1), m_graph.x(v2), m_graph.y(v2));
+        }
     }
 
     // Отрисовка вершин графа на изображении
-    for (size_t i = 0; i < m_vertices.size(); ++i) {
-        drawCircle(bitmap, m_vertices[i].x, m_vertices[i].y); // Отрисовка вершины графа
+    GRAPH_PROFILE_SCOPE("render.vertices");
+    for (size_t i = 0; i < m_graph.vertexCount(); ++i) {
+        drawVertex(bitmap, canvas, i);
+    }
+}
 
-        int labelX = m_vertices[i].x + 7;
-        int labelY = m_vertices[i].y + 7;
+//Параллельная отрисовка по плиткам. Рёбра и вершины раскладываются по плиткам, которых касаются,
+//и каждая плитка рисуется своим заданием с отсечением по своему прямоугольнику. Разные плитки пишут
+//в разные слова битовой карты, поэтому блокировки не нужны. Результат совпадает с render.
+void BMPGenerator::renderTiled(Bitmap& bitmap, ThreadPool& pool) {
+    GRAPH_PROFILE_SCOPE("render.tiled");
+    if (m_width <= 0 || m_height <= 0) {
+        return;
+    }
+    // Почти квадратные плитки, около kTilesPerThread на поток: мелкие плитки режут рёбра на большее
+    // число отрезков, каждый со своей настройкой, а крупные хуже распределяются между потоками
+    const double side = std::sqrt(static_cast<double>(m_width) * m_height / (kTilesPerThread * pool.size()));
+    const int tileWidth = std::max(64, (static_cast<int>(side) + 63) / 64 * 64); // Кратна 64: плитки не делят слова битовой карты
+    const int tileHeight = std::max(1, static_cast<int>(side));
+    const int columns = (m_width + tileWidth - 1) / tileWidth;
+    const int rows = (m_height + tileHeight - 1) / tileHeight;
+    const size_t tiles = static_cast<size_t>(std::max(columns, 0)) * std::max(rows, 0);
+    if (tiles == 0) {
+        return;
+    }
 
-        drawText(bitmap, m_vertices[i].label, labelX, labelY); // Отрисовка метки вершины
+    // Раскладка по плиткам параллельна по частям списков: каждая часть собирает свои пары (плитка, номер)
+    const size_t chunks = pool.size();
+    std::vector<std::vector<TileRef>> edgeRefs(chunks), vertexRefs(chunks);
+    pool.run(chunks, [&](size_t chunk) {
+        std::vector<uint32_t> touched;
+        for (size_t i = m_graph.edgeCount() * chunk / chunks; i < m_graph.edgeCount() * (chunk + 1) / chunks; ++i) {
+            touched.clear();
+            edgeTiles(i, tileWidth, tileHeight, columns, touched);
+            for (uint32_t tile : touched) {
+                edgeRefs[chunk].push_back(TileRef(tile, static_cast<uint32_t>(i)));
+            }
+        }
+        for (size_t i = m_graph.vertexCount() * chunk / chunks; i < m_graph.vertexCount() * (chunk + 1) / chunks; ++i) {
+            touched.clear();
+            vertexTiles(i, tileWidth, tileHeight, columns, touched);
+            for (uint32_t tile : touched) {
+                vertexRefs[chunk].push_back(TileRef(tile, static_cast<uint32_t>(i)));
+            }
+        }
+    });
+    std::vector<uint32_t> edgeOffsets, edgeBins, vertexOffsets, vertexBins;
+    buildTileBins(tiles, edgeRefs, edgeOffsets, edgeBins);
+    buildTileBins(tiles, vertexRefs, vertexOffsets, vertexBins);
+
+    pool.run(tiles, [&](size_t tile) {
+        int column = static_cast<int>(tile % columns);
+        int row = static_cast<int>(tile / columns);
+        ClipRect clip = { column * tileWidth, row * tileHeight,
+            std::min((column + 1) * tileWidth, m_width), std::min((row + 1) * tileHeight, m_height) };
+        for (uint32_t i = edgeOffsets[tile]; i < edgeOffsets[tile + 1]; ++i) {
+            Edge edge = m_graph.edge(edgeBins[i]);
+            drawLine(bitmap, clip, m_graph.x(edge.vertex1), m_graph.y(edge.vertex1),
+                m_graph.x(edge.vertex2), m_graph.y(edge.vertex2));
+        }
+        for (uint32_t i = vertexOffsets[tile]; i < vertexOffsets[tile + 1]; ++i) {
+            drawVertex(bitmap, clip, vertexBins[i]);
+        }
+    });
+}
+
+void BMPGenerator::edgeTiles(size_t edge, int tileWidth, int tileHeight, int columns, std::vector<uint32_t>& tiles) const {
+    // По столбцам плиток отрезок отсекается точно, строки плиток берутся по y первого
+    // и последнего пикселя в столбце
+    const int ax = m_graph.x(m_graph.vertex1(edge)), ay = m_graph.y(m_graph.vertex1(edge));
+    const int bx = m_graph.x(m_graph.vertex2(edge)), by = m_graph.y(m_graph.vertex2(edge));
+    BresenhamLine line(ax, ay, bx, by);
+    int firstColumn = std::max(std::min(ax, bx), 0) / tileWidth;
+    int lastColumn = std::min(std::max(ax, bx), m_width - 1) / tileWidth;
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+        ClipRect strip = { column * tileWidth, 0, std::min((column + 1) * tileWidth, m_width), m_height };
+        int64_t first, last;
+        if (!line.clip(strip, first, last)) {
+            continue;
+        }
+        int xFirst, yFirst, xLast, yLast;
+        line.pixel(first, xFirst, yFirst);
+        line.pixel(last, xLast, yLast);
+        for (int row = std::min(yFirst, yLast) / tileHeight; row <= std::max(yFirst, yLast) / tileHeight; ++row) {
+            tiles.push_back(static_cast<uint32_t>(row * columns + column));
+        }
     }
+}
 
-    // Запись данных изображения в файл
-    for (int y = m_height - 1; y >= 0; --y) {
-        for (int x = 0; x < m_width; ++x) {
-            file.put(bitmap[y][x] ? static_cast<char>(0) : static_cast<char>(255)) // Запись цвета пикселя
-                .put(bitmap[y][x] ? static_cast<char>(0) : static_cast<char>(255)) 
-                .put(bitmap[y][x] ? static_cast<char>(0) : static_cast<char>(255));
+void BMPGenerator::vertexTiles(size_t vertex, int tileWidth, int tileHeight, int columns, std::vector<uint32_t>& tiles) const {
+    ClipRect bounds = vertexBounds(vertex);
+    if (bounds.x1 <= 0 || bounds.y1 <= 0 || bounds.x0 >= m_width || bounds.y0 >= m_height) {
+        return;
+    }
+    int lastColumn = (std::min(bounds.x1, m_width) - 1) / tileWidth;
+    int lastRow = (std::min(bounds.y1, m_height) - 1) / tileHeight;
+    for (int row = std::max(bounds.y0, 0) / tileHeight; row <= lastRow; ++row) {
+        for (int column = std::max(bounds.x0, 0) / tileWidth; column <= lastColumn; ++column) {
+            tiles.push_back(static_cast<uint32_t>(row * columns + column));
         }
     }
 }
 
-void BMPGenerator::drawText(std::vector<std::vector<bool>>& bitmap, const std::string& text, int x, int y) {
-    int labelWidth = text.length() * 10;
+void BMPGenerator::drawVertex(Bitmap& bitmap, const ClipRect& clip, size_t vertex) {
+    drawCircle(bitmap, clip, m_graph.x(vertex), m_graph.y(vertex)); // Отрисовка вершины графа
+
+    LabelOffset offset = labelOffset(vertex);
+    if (!offset.visible) {
+        return;
+    }
+    int labelX = m_graph.x(vertex) + offset.dx;
+    int labelY = m_graph.y(vertex) + offset.dy;
+
+    drawText(bitmap, clip, m_graph.label(vertex), m_graph.labelLength(vertex), labelX, labelY); // Отрисовка метки вершины
+}
+
+ClipRect BMPGenerator::vertexBounds(size_t vertex) const {
+    // Круг радиусом 7 и рамка метки (см. drawVertex и drawText), с запасом в один пиксель
+    const int vx = m_graph.x(vertex), vy = m_graph.y(vertex);
+    const size_t labelLength = m_graph.labelLength(vertex);
+    LabelOffset offset = labelOffset(vertex);
+    if (!offset.visible) {
+        ClipRect bounds = { vx - 7 - 1, vy - 7 - 1, vx + 7 + 2, vy + 7 + 2 };
+        return bounds;
+    }
+    int labelWidth = static_cast<int>(labelLength) * 10;
+    int labelX = vx + offset.dx - labelWidth / 10;
+    int labelY = vy + offset.dy - 1;
+    ClipRect bounds = { std::min(vx - 7, labelX) - 1, std::min(vy - 7, labelY) - 1,
+        std::max(vx + 7, labelX + labelWidth) + 2, std::max(vy + 7, labelY + 12) + 2 };
+    return bounds;
+}
+
+size_t BMPGenerator::placeLabels() {
+    LabelPlacer placer(m_width, m_height);
+    size_t visible = placer.place(m_graph, m_labelOffsets);
+    m_tiles.columns = 0; // Инкрементальное изображение строится заново с новыми метками
+    return visible;
+}
+
+uint64_t BMPGenerator::countCrossings(std::vector<std::pair<size_t, size_t>>* pairs) const {
+    return countEdgeCrossings(m_graph, threadPool(), pairs);
+}
+
+CrossingEstimate BMPGenerator::estimateCrossings(uint64_t pairBudget) const {
+    return estimateEdgeCrossings(m_graph, threadPool(), pairBudget);
+}
+
+void BMPGenerator::drawText(Bitmap& bitmap, const ClipRect& clip, const char* text, size_t length, int x, int y) {
+    int labelWidth = static_cast<int>(length) * 10;
     int labelHeight = 12;
     int labelX = x - labelWidth / 10;
     int labelY = y - labelHeight / 10;
@@ -77,260 +448,821 @@ void BMPGenerator::drawText(std::vector<std::vector<bool>>& bitmap, const std::s
     if (labelX < 0 || labelX + labelWidth >= m_width || labelY < 0 || labelY + labelHeight >= m_height) {
         return;
     }
-    // Отрисовка рамки вокруг текста
-    for (int i = 0; i < labelWidth; ++i) {
-        bitmap[labelY][labelX + i] = true; // Верхняя граница
-        bitmap[labelY + labelHeight][labelX + i] = true; // Нижняя граница
+    GRAPH_PROFILE_COUNT("labels.drawn", 1);
+    // Отрисовка рамки вокруг текста (с отсечением по clip)
+    int spanX0 = std::max(labelX, clip.x0);
+    int spanX1 = std::min(labelX + labelWidth - 1, clip.x1 - 1);
+    if (labelY >= clip.y0 && labelY < clip.y1) {
+        bitmap.fillSpan(labelY, spanX0, spanX1); // Верхняя граница
     }
-    for (int i = 0; i < labelHeight; ++i) {
-        bitmap[labelY + i][labelX] = true; // Левая граница
-        bitmap[labelY + i][labelX + labelWidth] = true; // Правая граница
+    if (labelY + labelHeight >= clip.y0 && labelY + labelHeight < clip.y1) {
+        bitmap.fillSpan(labelY + labelHeight, spanX0, spanX1); // Нижняя граница
+    }
+    for (int i = std::max(0, clip.y0 - labelY); i < labelHeight && labelY + i < clip.y1; ++i) {
+        if (labelX >= clip.x0 && labelX < clip.x1) {
+            bitmap.set(labelX, labelY + i); // Левая граница
+        }
+        if (labelX + labelWidth >= clip.x0 && labelX + labelWidth < clip.x1) {
+            bitmap.set(labelX + labelWidth, labelY + i); // Правая граница
+        }
     }
     // Отрисовка символов текста
-    for (size_t i = 0; i < text.length(); ++i) {
-        drawCharacter(bitmap, text[i], labelX + i * 6, labelY + labelHeight / 2 - 3); // Отрисовка отдельного символа
-    }
-}
-
-
-void BMPGenerator::drawCharacter(std::vector<std::vector<bool>>& bitmap, char character, int x, int y) {
-    const std::vector<std::vector<std::vector<bool>>> charTemplates = {
-             {
-                {0, 1, 1, 1, 0},
-                {1, 0, 0, 0, 1},
-                {1, 0, 0, 0, 1},
-                {1, 0, 0, 0, 1},
-                {0, 1, 1, 1, 0}
-            },
-            {
-                {0, 0, 1, 0, 0},
-                {0, 1, 1, 0, 0},
-                {0, 0, 1, 0, 0},
-                {0, 0, 1, 0, 0},
-                {0, 1, 1, 1, 0}
-            },
-            {
-                {1, 1, 1, 0, 0},
-                {0, 0, 1, 0, 0},
-                {0, 1, 0, 0, 0},
-                {1, 0, 0, 0, 0},
-                {1, 1, 1, 1, 0}
-            },
-            {
-                {0, 1, 1, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 1, 1, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 1, 1, 1, 0}
-            },
-            {
-                {0, 1, 0, 1, 0},
-                {0, 1, 0, 1, 0},
-                {0, 1, 1, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 0, 0, 1, 0}
-            },
-            {
-                {0, 0, 1, 1, 0},
-                {0, 0, 1, 0, 0},
-                {0, 0, 1, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 0, 1, 1, 0}
-            },
-            {
-                {0, 1, 1, 1, 0},
-                {0, 1, 0, 0, 0},
-                {0, 1, 1, 1, 0},
-                {0, 1, 0, 1, 0},
-                {0, 1, 1, 1, 0}
-            },
-            {
-                {0, 1, 1, 1, 0},
-                {0, 1, 0, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 0, 0, 1, 0}
-            },
-            {
-                {0, 1, 1, 1, 0},
-                {0, 1, 0, 1, 0},
-                {0, 1, 1, 1, 0},
-                {0, 1, 0, 1, 0},
-                {0, 1, 1, 1, 0}
-            },
-            {
-                {0, 1, 1, 1, 0},
-                {0, 1, 0, 1, 0},
-                {0, 1, 1, 1, 0},
-                {0, 0, 0, 1, 0},
-                {0, 1, 1, 1, 0}
-            },
-    };
+    for (size_t i = 0; i < length; ++i) {
+        drawCharacter(bitmap, clip, text[i], labelX + i * 6, labelY + labelHeight / 2 - 3); // Отрисовка отдельного символа
+    }
+}
 
-    // Проверка на то, что символ является цифрой
-    if (character >= '0' && character <= '9') {
-        int index = character - '0'; // Индекс символа
-        // Отрисовка символа по матрице
-        for (size_t i = 0; i < charTemplates[index].size(); ++i) {
-            for (size_t j = 0; j < charTemplates[index][i].size(); ++j) {
-                if (charTemplates[index][i][j]) { // Если в матрице на данной позиции стоит единица
-                    if (x + j >= 0 && x + j < bitmap[0].size() && y + i >= 0 && y + i < bitmap.size()) {
-                        bitmap[y + i][x + j] = true; // Отрисовка пикселя
-                    }
+
+void BMPGenerator::drawCharacter(Bitmap& bitmap, const ClipRect& clip, char character, int x, int y) {
+    const uint8_t* rows = glyphRows(character);
+    if (rows == nullptr) {
+        return; // Непечатаемые символы пропускаются
+    }
+    // Столбцы глифа, попадающие в clip; дальше строка глифа переносится в слово карты сдвигом
+    int firstColumn = std::max(clip.x0 - x, 0);
+    int lastColumn = std::min(clip.x1 - x, kGlyphWidth) - 1;
+    if (firstColumn > lastColumn) {
+        return;
+    }
+    uint32_t columnMask = ((1u << (lastColumn + 1)) - 1) & ~((1u << firstColumn) - 1);
+    int left = x + firstColumn;
+    int shift = left & 63;
+    for (int i = std::max(clip.y0 - y, 0); i < kGlyphHeight && y + i < clip.y1; ++i) {
+        uint64_t bits = (rows[i] & columnMask) >> firstColumn;
+        if (bits == 0) {
+            continue;
+        }
+        uint64_t* words = bitmap.row(y + i) + (left >> 6);
+        words[0] |= bits << shift;
+        if (shift + kGlyphWidth > 64) {
+            words[1] |= bits >> (64 - shift); // Глиф на границе двух слов
+        }
+    }
+}
+
+void BMPGenerator::drawLine(Bitmap& bitmap, const ClipRect& clip, int x0, int y0, int x1, int y1) {
+    // Отрезок Брезенхэма без конечной точки; рисуются только шаги, попадающие в clip
+    BresenhamLine line(x0, y0, x1, y1);
+    int64_t first, last;
+    if (!line.clip(clip, first, last)) {
+        return;
+    }
+
+    // Состояние на шаге first: смещение по второй оси и остаток числителя формулы шага
+    const int64_t twoMajor = 2 * line.major;
+    const int64_t twoMinor = 2 * line.minor;
+    int64_t numerator = twoMinor * first + line.major - 1;
+    int64_t offset = floorDiv(numerator, twoMajor);
+    int64_t error = numerator - offset * twoMajor;
+    int64_t count = last - first + 1;
+    GRAPH_PROFILE_COUNT("edges.drawn", 1);
+    GRAPH_PROFILE_COUNT("pixels.touched", count);
+    std::ptrdiff_t rowStep = line.sy * static_cast<std::ptrdiff_t>(bitmap.stride());
+
+    if (!line.steep) {
+        // Пологая линия: на каждом шаге меняется x, строка — при переполнении остатка
+        int x = x0 + line.sx * static_cast<int>(first);
+        uint64_t* row = bitmap.row(y0 + line.sy * static_cast<int>(offset));
+        for (int64_t i = 0; i < count; ++i) {
+            row[x >> 6] |= uint64_t(1) << (x & 63);
+            x += line.sx;
+            error += twoMinor;
+            if (error >= twoMajor) {
+                error -= twoMajor;
+                row += rowStep;
+            }
+        }
+    }
+    else {
+        // Крутая линия: на каждом шаге меняется строка, x — при переполнении остатка
+        int x = x0 + line.sx * static_cast<int>(offset);
+        uint64_t* row = bitmap.row(y0 + line.sy * static_cast<int>(first));
+        for (int64_t i = 0; i < count; ++i) {
+            row[x >> 6] |= uint64_t(1) << (x & 63);
+            row += rowStep;
+            error += twoMinor;
+            if (error >= twoMajor) {
+                error -= twoMajor;
+                x += line.sx;
+            }
+        }
+    }
+}
+
+void BMPGenerator::drawCircle(Bitmap& bitmap, const ClipRect& clip, int xc, int yc) {
+    // Круг радиусом 7 пикселей рисуется строками-отрезками из таблицы полуширин
+    GRAPH_PROFILE_COUNT("circles.drawn", 1);
+    for (int dy = -kCircleRadius; dy <= kCircleRadius; ++dy) {
+        int y = yc + dy;
+        if (y < clip.y0 || y >= clip.y1) {
+            continue;
+        }
+        int halfWidth = kCircleHalfWidth[dy + kCircleRadius];
+        int x0 = std::max(xc - halfWidth, clip.x0);
+        int x1 = std::min(xc + halfWidth, clip.x1 - 1);
+        GRAPH_PROFILE_COUNT("pixels.touched", std::max(x1 - x0 + 1, 0));
+        bitmap.fillSpan(y, x0, x1);
+    }
+}
+
+void BMPGenerator::setEdgeColor(size_t edge, Color color) {
+    if (edge >= m_edgeColors.size()) {
+        m_edgeColors.resize(edge + 1, kBlack);
+    }
+    m_edgeColors[edge] = color;
+}
+
+void BMPGenerator::setVertexColor(size_t vertex, Color color) {
+    if (vertex >= m_vertexColors.size()) {
+        m_vertexColors.resize(vertex + 1, kBlack);
+    }
+    m_vertexColors[vertex] = color;
+}
+
+void BMPGenerator::highlightKuratowski(const KuratowskiSubgraph& kuratowski, Color color) {
+    for (size_t v : kuratowski.branchVertices) {
+        setVertexColor(v, color);
+    }
+    // Рёбра подразбиения ищутся в общем списке по упорядоченным парам концов
+    std::vector<std::pair<size_t, size_t>> witness;
+    for (const auto& edge : kuratowski.edges) {
+        witness.emplace_back(std::min(edge.vertex1, edge.vertex2), std::max(edge.vertex1, edge.vertex2));
+    }
+    std::sort(witness.begin(), witness.end());
+    for (size_t i = 0; i < m_graph.edgeCount(); ++i) {
+        std::pair<size_t, size_t> key(std::min(m_graph.vertex1(i), m_graph.vertex2(i)), std::max(m_graph.vertex1(i), m_graph.vertex2(i)));
+        if (std::binary_search(witness.begin(), witness.end(), key)) {
+            setEdgeColor(i, color);
+        }
+    }
+}
+
+void BMPGenerator::generateColor(const std::string& filename) {
+    if (m_outputFormat != ImageFormat::Bmp) {
+        Framebuffer framebuffer(m_width, m_height);
+        renderColor(framebuffer);
+        writeEncoded(filename, framebuffer);
+        return;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    Framebuffer framebuffer(m_width, m_height);
+    renderColor(framebuffer);
+    m_encoder.setFormat(BMPFormat::Rgb24);
+    m_encoder.writeHeader(file, m_width, m_height);
+    m_encoder.writeImageData(file, framebuffer);
+}
+
+void BMPGenerator::renderDensity(GrayImage& image, int cellSize) {
+    DensityMap density(m_width, m_height);
+    density.accumulate(m_graph, threadPool(), cellSize);
+    density.toGray(image);
+}
+
+void BMPGenerator::generateDensity(const std::string& filename, int cellSize) {
+    if (m_outputFormat != ImageFormat::Bmp) {
+        GrayImage image;
+        renderDensity(image, cellSize);
+        writeEncoded(filename, image);
+        return;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return;
+    }
+    GrayImage image;
+    renderDensity(image, cellSize);
+    m_encoder.setFormat(BMPFormat::Gray8);
+    m_encoder.writeHeader(file, m_width, m_height);
+    m_encoder.writeImageData(file, image);
+}
+
+//Цветная отрисовка рёбер и вершин в буфер кадра размером m_width x m_height
+void BMPGenerator::renderColor(Framebuffer& framebuffer) {
+    GRAPH_PROFILE_SCOPE("render.color");
+    if (m_width <= 0 || m_height <= 0) {
+        return;
+    }
+    // Крутые рёбра проходят по строкам и на большом холсте выходят за пределы кэша и TLB.
+    // Поэтому рисование идёт полосами по kColorBandBytes буфера кадра, маски цветов которых (байт
+    // на пиксель) остаются в кэше второго уровня: в каждой полосе
+    // рисуются только рёбра и вершины, которые её пересекают (тот же проход, что и при потоковой записи).
+    // Полосы не пересекаются по строкам, поэтому на больших графах они рисуются параллельно
+    int bandHeight = static_cast<int>(std::min<size_t>(std::max<size_t>(kColorBandBytes / (static_cast<size_t>(m_width) * sizeof(Color)), 1), m_height));
+    int edgeMargin = static_cast<int>(std::ceil(m_strokeWidth / 2)) + 1;
+    std::vector<ClipRect> bandClips;
+    std::vector<std::vector<uint32_t>> bandEdges, bandVertices;
+    sweepBands(bandHeight, edgeMargin, [&](const ClipRect& clip, const std::vector<uint32_t>& edges, const std::vector<uint32_t>& vertices) {
+        bandClips.push_back(clip);
+        bandEdges.push_back(edges);
+        bandVertices.push_back(vertices);
+    });
+
+    // Рёбра рисуются в маски покрытий полосы, по маске на цвет (CoverageMask), и маски смешиваются
+    // с буфером кадра: смешивание не повторяется для каждого ребра, а покрытые целиком пиксели просто
+    // записываются. До kColorMasks цветов смешиваются за один проход блоками по kColorBlendRows строк,
+    // пока блок буфера кадра лежит в кэше. Сначала смешивается цвет по умолчанию, затем остальные цвета
+    // в порядке первого появления, поэтому выделенные рёбра лежат поверх обычных
+    std::vector<Color> palette(1, kBlack);
+    std::vector<uint32_t> colorRank(m_graph.edgeCount(), 0);
+    std::unordered_map<Color, uint32_t> ranks;
+    ranks[kBlack] = 0;
+    for (size_t i = 0; i < m_edgeColors.size() && i < colorRank.size(); ++i) {
+        auto inserted = ranks.insert(std::make_pair(m_edgeColors[i], static_cast<uint32_t>(palette.size())));
+        if (inserted.second) {
+            palette.push_back(m_edgeColors[i]);
+        }
+        colorRank[i] = inserted.first->second;
+    }
+
+    // Отрезок, пересекающий несколько полос, настраивается один раз
+    std::vector<AntialiasedLine> lines;
+    lines.reserve(m_graph.edgeCount());
+    for (size_t i = 0; i < m_graph.edgeCount(); ++i) {
+        const uint32_t v1 = m_graph.vertex1(i), v2 = m_graph.vertex2(i);
+        lines.push_back(AntialiasedLine(m_graph.x(v1), m_graph.y(v1), m_graph.x(v2), m_graph.y(v2), m_strokeWidth));
+    }
+
+    const size_t maskCount = std::min(palette.size(), kColorMasks);
+    auto drawBand = [&](size_t band, std::vector<CoverageMask>& masks) {
+        const ClipRect& clip = bandClips[band];
+        for (CoverageMask& mask : masks) {
+            mask.reset(m_width, clip.y0, clip.y1 - clip.y0);
+        }
+        // Цвета обрабатываются партиями по masks.size(); если партий несколько, рёбра полосы
+        // упорядочиваются по цвету, и рёбра каждой партии идут подряд
+        std::vector<uint32_t>& edges = bandEdges[band];
+        if (palette.size() > masks.size()) {
+            std::sort(edges.begin(), edges.end(), [&](uint32_t a, uint32_t b) { return colorRank[a] < colorRank[b]; });
+        }
+        size_t next = 0;
+        for (size_t batch = 0; batch < palette.size(); batch += masks.size()) {
+            const size_t batchEnd = std::min(batch + masks.size(), palette.size());
+            for (; next < edges.size() && colorRank[edges[next]] < batchEnd; ++next) {
+                drawLineColor(masks[colorRank[edges[next]] - batch], clip, lines[edges[next]]);
+            }
+            for (int y = clip.y0; y < clip.y1; y += kColorBlendRows) {
+                for (size_t color = batch; color < batchEnd; ++color) {
+                    framebuffer.blendMask(masks[color - batch], palette[color], y, std::min(y + kColorBlendRows, clip.y1));
                 }
             }
+            for (CoverageMask& mask : masks) {
+                mask.clear();
+            }
+        }
+        for (uint32_t i : bandVertices[band]) {
+            drawVertexColor(framebuffer, clip, i);
+        }
+    };
+    if (m_graph.edgeCount() + m_graph.vertexCount() >= kTiledRenderThreshold && threadPool().size() > 1) {
+        threadPool().run(bandClips.size(), [&](size_t band) {
+            std::vector<CoverageMask> masks(maskCount);
+            drawBand(band, masks);
+        });
+    }
+    else {
+        // Маски очищаются после смешивания, поэтому одни и те же маски переходят к следующей полосе
+        std::vector<CoverageMask> masks(maskCount);
+        for (size_t band = 0; band < bandClips.size(); ++band) {
+            drawBand(band, masks);
         }
     }
 }
 
-void BMPGenerator::drawLine(std::vector<std::vector<bool>>& bitmap, int x0, int y0, int x1, int y1) {
-    int dx = std::abs(x1 - x0); // Приращение по X
-    int dy = std::abs(y1 - y0); // Приращение по Y
+AntialiasedLine::AntialiasedLine(int x0, int y0, int x1, int y1, float strokeWidth)
+    : x0(x0), y0(y0), dx(x1 - x0), dy(y1 - y0), yFirst(1), yLast(0), runFirst(1), runLast(0), window(0) {
+    // Покрытие пикселя — произведение покрытия поперёк отрезка, clamp(h + 0.5 - |d|) при расстоянии d
+    // до оси и полуширине h, и покрытий вдоль него, clamp(t + 0.5) и clamp(length - t + 0.5) по проекции t.
+    // При ширине 1 яркость делится между двумя соседними пикселями, как в алгоритме Ву.
+    // Для смещения o = x - x0 в строке ry = y - y0: d = ry * ux - o * uy, t = ry * uy + o * ux.
+    // Оба выражения линейны, поэтому границы пикселей строки с ненулевым покрытием тоже линейны по ry
+    length = std::sqrt(static_cast<float>(dx) * dx + static_cast<float>(dy) * dy);
+    ux = length == 0 ? 0 : dx / length;
+    uy = length == 0 ? 0 : dy / length;
+    reach = strokeWidth / 2 + 0.5f;
+    // Ненулевое покрытие выходит за концы отрезка по вертикали на 0.5 |uy| + reach |ux|
+    const float capReach = 0.5f * std::fabs(uy) + reach * std::fabs(ux);
+    if (length != 0) {
+        yFirst = static_cast<int>(std::floor(std::min(y0, y1) - capReach));
+        yLast = static_cast<int>(std::ceil(std::max(y0, y1) + capReach));
+    }
+
+    // |d| < reach: o в (ry * ux / uy -+ reach / |uy|); -0.5 < t < length + 0.5: o между (-0.5 - ry * uy) / ux
+    // и (length + 0.5 - ry * uy) / ux. Почти горизонтальные и вертикальные отрезки ограничиваются одним условием
+    const float kEpsilon = 1e-6f;
+    acrossBound = std::fabs(uy) > kEpsilon;
+    alongBound = std::fabs(ux) > kEpsilon;
+    acrossSlope = acrossBound ? ux / uy : 0;
+    acrossHalf = acrossBound ? reach / std::fabs(uy) : 0;
+    alongSlope = alongBound ? -uy / ux : 0;
+    alongStart = alongBound ? -0.5f / ux : 0;
+    alongEnd = alongBound ? (length + 0.5f) / ux : 0;
 
-    int sx = x0 < x1 ? 1 : -1; // Направление по X
-    int sy = y0 < y1 ? 1 : -1; // Направление по Y
-    int err = dx - dy; // Ошибка
+    // Покрытие поперёк отрезка в целых числах: расстояние в единицах 1/(255 * 256) пикселя
+    const float kScale = 255.0f * 256.0f;
+    stepFixed = static_cast<int32_t>(uy * kScale);
+    limitFixed = static_cast<int32_t>(reach * kScale) + 128;
 
-    // Отрисовка линии методом Брезенхэма
-    while (x0 != x1 || y0 != y1) {
-        if (x0 >= 0 && x0 < m_width && y0 >= 0 && y0 < m_height) {
-            bitmap[y0][x0] = true;
+    // Покрытие ненулевое только при |d| < reach, то есть на интервале длины 2 * acrossHalf без концов, и окно
+    // от ceil(center - acrossHalf) шириной ceil(2 * acrossHalf) накрывает все такие пиксели. Каждая строка
+    // рисуется окном постоянной ширины 4 или кратной 8 (по числу покрытий в регистре SSE). Строки дальше
+    // capReach от концов отрезка целиком лежат внутри него: на оси t = ry / uy, а в пределах окна
+    // t меняется не больше чем на reach * |ux| / |uy|; такие строки рисуются одним вызовом без проверок концов.
+    // Почти горизонтальные отрезки с окном шире kMaxWindow остаются общему циклу: у них мало строк
+    // и длинные отрезки в каждой
+    const int kMaxWindow = 64;
+    const int kMaxCoordinate = 1 << 24;
+    if (acrossBound && length != 0
+        && std::max(std::max(std::abs(x0), std::abs(x1)), std::max(std::abs(y0), std::abs(y1))) < kMaxCoordinate) {
+        int span = static_cast<int>(std::ceil(2 * acrossHalf));
+        span = span <= 4 ? 4 : (span + 7) & ~7;
+        if (span <= kMaxWindow) {
+            window = span;
+            runFirst = std::min(y0, y1) + static_cast<int>(capReach) + 1;
+            runLast = std::max(y0, y1) - static_cast<int>(capReach) - 1;
+            // Ось в строке runFirst и её сдвиг за строку в формате 32.32: полосы продолжают её без деления.
+            // Точности double (53 бита) хватает с запасом: координаты не длиннее kMaxCoordinate
+            const double kFixedOne = 4294967296.0;
+            double shift = static_cast<double>(dx) / dy;
+            runStep = static_cast<int64_t>(std::floor(shift * kFixedOne + 0.5));
+            runCenter = static_cast<int64_t>(x0) * (int64_t(1) << 32)
+                + static_cast<int64_t>(std::floor((runFirst - y0) * shift * kFixedOne + 0.5));
+            runSlope = (runStep + (1 << 15)) >> 16;
+            runHalfWidth = static_cast<int64_t>(std::floor(acrossHalf * 65536.0 + 0.5));
         }
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
+    }
+}
+
+void BMPGenerator::drawLineColor(CoverageMask& mask, const ClipRect& clip, const AntialiasedLine& line) const {
+    const int yFirst = std::max(clip.y0, line.yFirst);
+    const int yLast = std::min(clip.y1 - 1, line.yLast);
+    if (yFirst > yLast) {
+        return;
+    }
+    GRAPH_PROFILE_COUNT("edges.drawn", 1); // Пиксели считает Framebuffer
+    const int x0 = line.x0, y0 = line.y0;
+    const float ux = line.ux, uy = line.uy, length = line.length, reach = line.reach;
+
+    if (line.window > 0) {
+        // Ось в строке y в формате 16.16 с округлением
+        auto center = [&](int y) { return (line.runCenter + line.runStep * (y - line.runFirst) + (1 << 15)) >> 16; };
+        int64_t firstCenter = center(yFirst);
+        int64_t lastCenter = center(yLast);
+        // Окно сдвигается монотонно, поэтому достаточно проверить первую и последнюю строки (с запасом в пиксель)
+        if (std::min(firstCenter, lastCenter) - line.runHalfWidth - 65536 >= static_cast<int64_t>(clip.x0) << 16
+            && std::max(firstCenter, lastCenter) - line.runHalfWidth + static_cast<int64_t>(line.window + 1) * 65536 <= static_cast<int64_t>(clip.x1) << 16) {
+            // Строки у концов отрезка рисуются тем же окном, но с покрытием по полной формуле
+            const int runFirst = std::max(yFirst, line.runFirst);
+            const int runLast = std::min(yLast, line.runLast);
+            if (runFirst > runLast) {
+                mask.addSegmentWindows(yFirst, yLast - yFirst + 1, line.window, firstCenter, line.runSlope, line.runHalfWidth,
+                    x0, y0, ux, uy, reach, length);
+                return;
+            }
+            mask.addSegmentWindows(yFirst, runFirst - yFirst, line.window, firstCenter, line.runSlope, line.runHalfWidth,
+                x0, y0, ux, uy, reach, length);
+            mask.addSteepLine(runFirst, runLast - runFirst + 1, line.window, center(runFirst), line.runSlope,
+                line.runHalfWidth, line.stepFixed, line.limitFixed);
+            mask.addSegmentWindows(runLast + 1, yLast - runLast, line.window, center(runLast + 1), line.runSlope, line.runHalfWidth,
+                x0, y0, ux, uy, reach, length);
+            return;
+        }
+    }
+
+    const float clipLow = static_cast<float>(clip.x0 - x0);
+    const float clipHigh = static_cast<float>(clip.x1 - 1 - x0);
+    for (int y = yFirst; y <= yLast; ++y) {
+        float ry = static_cast<float>(y - y0);
+        float low = clipLow, high = clipHigh;
+        if (line.acrossBound) {
+            low = std::max(low, ry * line.acrossSlope - line.acrossHalf);
+            high = std::min(high, ry * line.acrossSlope + line.acrossHalf);
+        }
+        if (line.alongBound) {
+            float a = line.alongStart + ry * line.alongSlope;
+            float b = line.alongEnd + ry * line.alongSlope;
+            low = std::max(low, std::min(a, b));
+            high = std::min(high, std::max(a, b));
+        }
+        if (low > high) {
+            continue;
+        }
+        int first = ceilToInt(low);
+        int last = floorToInt(high);
+        if (first > last) {
+            continue;
         }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
+        int count = last - first + 1;
+        float d = ry * ux - first * uy;
+        float t = ry * uy + first * ux;
+        if (count <= kExactSpan) {
+            mask.addSegmentSpan(y, x0 + first, count, d, uy, t, ux, reach, length);
+            continue;
         }
+
+        // Пиксели [inner, innerEnd) лежат дальше 0.5 от концов отрезка: там покрытие вдоль него равно 1
+        // и остаётся только покрытие поперёк. Остальные пиксели строки считаются по полной формуле
+        int inner = count, innerEnd = count;
+        if (line.alongBound) {
+            float a = (0.5f - t) / ux;
+            float b = (length - 0.5f - t) / ux;
+            inner = std::min(std::max(ceilToInt(std::min(a, b)), 0), count);
+            innerEnd = std::max(std::min(floorToInt(std::max(a, b)) + 1, count), inner);
+        }
+        else if (t >= 0.5f && t <= length - 0.5f) {
+            inner = 0;
+        }
+        mask.addSegmentSpan(y, x0 + first, inner, d, uy, t, ux, reach, length);
+        if (inner < innerEnd) {
+            const float kScale = 255.0f * 256.0f;
+            mask.addRamp(y, x0 + first + inner, innerEnd - inner,
+                static_cast<int32_t>((d - inner * uy) * kScale), line.stepFixed, line.limitFixed);
+        }
+        mask.addSegmentSpan(y, x0 + first + innerEnd, count - innerEnd, d - innerEnd * uy, uy, t + innerEnd * ux, ux, reach, length);
     }
 }
 
-void BMPGenerator::drawCircle(std::vector<std::vector<bool>>& bitmap, int xc, int yc) {
-    // Отрисовка круга с радиусом 7 пикселей
-    int radius = 7;
-    for (int y = yc - radius; y <= yc + radius; ++y) {
-        for (int x = xc - radius; x <= xc + radius; ++x) {
-            if (x >= 0 && x < m_width && y >= 0 && y < m_height) {
-                double distance = std::sqrt((x - xc) * (x - xc) + (y - yc) * (y - yc)); // Вычисление расстояния от центра круга
-                if (distance <= radius) { // Если расстояние меньше или равно радиусу круга
-                    bitmap[y][x] = true;
+void BMPGenerator::drawVertexColor(Framebuffer& framebuffer, const ClipRect& clip, size_t vertex) const {
+    const int vx = m_graph.x(vertex), vy = m_graph.y(vertex);
+    const size_t labelLength = m_graph.labelLength(vertex);
+    Color color = vertexColor(vertex);
+    GRAPH_PROFILE_COUNT("circles.drawn", 1);
+
+    // Сглаженный круг: строки таблицы покрытий, отсечённые по clip
+    const CircleStamp& stamp = circleStamp();
+    const int half = CircleStamp::kSize / 2;
+    for (int i = 0; i < CircleStamp::kSize; ++i) {
+        int y = vy - half + i;
+        if (y < clip.y0 || y >= clip.y1) {
+            continue;
+        }
+        int xFirst = std::max(vx - half, clip.x0);
+        int xLast = std::min(vx + half, clip.x1 - 1);
+        if (xFirst <= xLast) {
+            framebuffer.blendSpan(y, xFirst, xLast - xFirst + 1, color, stamp.coverage[i] + (xFirst - (vx - half)));
+        }
+    }
+
+    // Метка: та же рамка и тот же шрифт, что и в монохромной отрисовке, цветом вершины
+    LabelOffset offset = labelOffset(vertex);
+    if (!offset.visible) {
+        return;
+    }
+    int labelWidth = static_cast<int>(labelLength) * 10;
+    int labelHeight = 12;
+    int labelX = vx + offset.dx - labelWidth / 10;
+    int labelY = vy + offset.dy - labelHeight / 10;
+    if (labelX < 0 || labelX + labelWidth >= m_width || labelY < 0 || labelY + labelHeight >= m_height) {
+        return;
+    }
+    auto plot = [&](int x, int y) {
+        if (x >= clip.x0 && x < clip.x1 && y >= clip.y0 && y < clip.y1) {
+            framebuffer.row(y)[x] = color;
+        }
+    };
+    for (int x = labelX; x < labelX + labelWidth; ++x) {
+        plot(x, labelY);
+        plot(x, labelY + labelHeight);
+    }
+    for (int i = 0; i < labelHeight; ++i) {
+        plot(labelX, labelY + i);
+        plot(labelX + labelWidth, labelY + i);
+    }
+    for (size_t c = 0; c < labelLength; ++c) {
+        const uint8_t* rows = glyphRows(m_graph.label(vertex)[c]);
+        if (rows == nullptr) {
+            continue;
+        }
+        for (int i = 0; i < kGlyphHeight; ++i) {
+            for (int j = 0; j < kGlyphWidth; ++j) {
+                if ((rows[i] >> j) & 1) {
+                    plot(labelX + static_cast<int>(c) * 6 + j, labelY + labelHeight / 2 - 3 + i);
                 }
             }
         }
     }
 }
 
-void BMPGenerator::writeInt(std::ofstream& file, int value) {
-    file.put(static_cast<char>(value & 0xFF)) 
-        .put(static_cast<char>((value >> 8) & 0xFF)) 
-        .put(static_cast<char>((value >> 16) & 0xFF)) 
-        .put(static_cast<char>((value >> 24) & 0xFF)); 
+const GraphIndex& BMPGenerator::index() const {
+    if (m_indexStale) {
+        m_index.build(m_graph.vertexCount(), m_graph.endpoints());
+        m_indexStale = false;
+    }
+    return m_index;
 }
 
-void BMPGenerator::writeShort(std::ofstream& file, short value) {
-    file.put(static_cast<char>(value & 0xFF))
-        .put(static_cast<char>((value >> 8) & 0xFF));
+void BMPGenerator::buildIncidentEdges() {
+    m_incidentEdges.assign(m_graph.vertexCount(), std::vector<uint32_t>());
+    for (size_t i = 0; i < m_graph.edgeCount(); ++i) {
+        m_incidentEdges[m_graph.vertex1(i)].push_back(static_cast<uint32_t>(i));
+        if (m_graph.vertex2(i) != m_graph.vertex1(i)) {
+            m_incidentEdges[m_graph.vertex2(i)].push_back(static_cast<uint32_t>(i));
+        }
+    }
 }
 
-bool BMPGenerator::isGraphPlanar() const {
-    // Проверка наличия подграфа K5
-    if (containsK5())
+bool BMPGenerator::addEdge(size_t v1, size_t v2) {
+    if (v1 >= m_graph.vertexCount() || v2 >= m_graph.vertexCount()) {
+        std::cerr << "Error: edge (" << v1 << ", " << v2 << ") refers to a missing vertex" << std::endl;
         return false;
+    }
+    if (m_incidentEdges.size() != m_graph.vertexCount()) {
+        buildIncidentEdges();
+    }
+    uint32_t edge = static_cast<uint32_t>(m_graph.edgeCount());
+    m_graph.addEdge(static_cast<uint32_t>(v1), static_cast<uint32_t>(v2));
+    m_incidentEdges[v1].push_back(edge);
+    if (v2 != v1) {
+        m_incidentEdges[v2].push_back(edge);
+    }
+    attachEdge(edge);
+    m_indexStale = true;
+    return true;
+}
 
-    // Проверка наличия подграфа K3,3
-    if (containsK33())
+bool BMPGenerator::removeEdge(size_t edge) {
+    if (edge >= m_graph.edgeCount()) {
+        std::cerr << "Error: edge " << edge << " does not exist" << std::endl;
         return false;
+    }
+    if (m_incidentEdges.size() != m_graph.vertexCount()) {
+        buildIncidentEdges();
+    }
+    auto replace = [](std::vector<uint32_t>& list, uint32_t from, uint32_t to) {
+        auto it = std::find(list.begin(), list.end(), from);
+        if (it != list.end()) {
+            *it = to;
+        }
+    };
+    auto erase = [](std::vector<uint32_t>& list, uint32_t value) {
+        auto it = std::find(list.begin(), list.end(), value);
+        if (it != list.end()) {
+            *it = list.back();
+            list.pop_back();
+        }
+    };
 
-    return true; // Если не найдены K5 и K3,3, граф планарен
-}
+    detachEdge(edge);
+    erase(m_incidentEdges[m_graph.vertex1(edge)], static_cast<uint32_t>(edge));
+    erase(m_incidentEdges[m_graph.vertex2(edge)], static_cast<uint32_t>(edge));
 
-bool BMPGenerator::containsK5() const {
-    // Перебираем все возможные наборы 5 вершин
-    for (size_t v1 = 0; v1 < m_vertices.size(); ++v1) {
-        for (size_t v2 = v1 + 1; v2 < m_vertices.size(); ++v2) {
-            for (size_t v3 = v2 + 1; v3 < m_vertices.size(); ++v3) {
-                for (size_t v4 = v3 + 1; v4 < m_vertices.size(); ++v4) {
-                    for (size_t v5 = v4 + 1; v5 < m_vertices.size(); ++v5) {
-                        // Проверяем, существует ли хотя бы одно ребро между вершинами данного набора
-                        if (!hasEdgeBetween(v1, v2) && !hasEdgeBetween(v1, v3) && !hasEdgeBetween(v1, v4) && !hasEdgeBetween(v1, v5) &&
-                            !hasEdgeBetween(v2, v3) && !hasEdgeBetween(v2, v4) && !hasEdgeBetween(v2, v5) &&
-                            !hasEdgeBetween(v3, v4) && !hasEdgeBetween(v3, v5) &&
-                            !hasEdgeBetween(v4, v5)) {
-                            // Если нет ни одного ребра, то найден K5
-                            return true;
-                        }
-                    }
-                }
+    // Последнее ребро переносится на место удалённого: его номер меняется в списках вершин и в корзинах плиток
+    uint32_t last = static_cast<uint32_t>(m_graph.edgeCount() - 1);
+    if (edge != last) {
+        replace(m_incidentEdges[m_graph.vertex1(last)], last, static_cast<uint32_t>(edge));
+        replace(m_incidentEdges[m_graph.vertex2(last)], last, static_cast<uint32_t>(edge));
+        if (m_tiles.columns > 0) {
+            std::vector<uint32_t> touched;
+            edgeTiles(last, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+            for (uint32_t tile : touched) {
+                replace(m_tiles.edges[tile], last, static_cast<uint32_t>(edge));
             }
         }
+        m_graph.setEdge(edge, m_graph.vertex1(last), m_graph.vertex2(last));
+        if (edge < m_edgeColors.size() || last < m_edgeColors.size()) {
+            setEdgeColor(edge, edgeColor(last));
+        }
+    }
+    m_graph.removeLastEdge();
+    if (m_edgeColors.size() > m_graph.edgeCount()) {
+        m_edgeColors.resize(m_graph.edgeCount());
     }
-    // Если не найдено K5
-    return false;
+    m_indexStale = true;
+    return true;
 }
 
-bool BMPGenerator::hasEdgeBetween(size_t v1, size_t v2) const {
-    // Проверяем, есть ли ребро между вершинами v1 и v2
-   for (const auto& edge : m_edges) {
-        if ((edge.vertex1 == v1 && edge.vertex2 == v2) || (edge.vertex1 == v2 && edge.vertex2 == v1)) {
-            return true;
+bool BMPGenerator::moveVertex(size_t vertex, int x, int y) {
+    if (vertex >= m_graph.vertexCount()) {
+        std::cerr << "Error: vertex " << vertex << " does not exist" << std::endl;
+        return false;
+    }
+    if (m_incidentEdges.size() != m_graph.vertexCount()) {
+        buildIncidentEdges();
+    }
+    // Плитки старого положения вершины и её рёбер отмечаются до перемещения, нового — после
+    detachVertex(vertex);
+    for (uint32_t edge : m_incidentEdges[vertex]) {
+        detachEdge(edge);
+    }
+    m_graph.setPosition(vertex, x, y);
+    attachVertex(vertex);
+    for (uint32_t edge : m_incidentEdges[vertex]) {
+        attachEdge(edge);
+    }
+    return true;
+}
+
+void BMPGenerator::markDirty(uint32_t tile) {
+    if (!m_tiles.isDirty[tile]) {
+        m_tiles.isDirty[tile] = 1;
+        m_tiles.dirty.push_back(tile);
+    }
+}
+
+void BMPGenerator::attachEdge(size_t edge) {
+    if (m_tiles.columns == 0) {
+        return; // Изображение ещё не построено: раскладка будет собрана целиком
+    }
+    std::vector<uint32_t> touched;
+    edgeTiles(edge, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+    for (uint32_t tile : touched) {
+        m_tiles.edges[tile].push_back(static_cast<uint32_t>(edge));
+        markDirty(tile);
+    }
+}
+
+void BMPGenerator::detachEdge(size_t edge) {
+    if (m_tiles.columns == 0) {
+        return;
+    }
+    std::vector<uint32_t> touched;
+    edgeTiles(edge, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+    for (uint32_t tile : touched) {
+        std::vector<uint32_t>& bin = m_tiles.edges[tile];
+        auto it = std::find(bin.begin(), bin.end(), static_cast<uint32_t>(edge));
+        if (it != bin.end()) {
+            *it = bin.back();
+            bin.pop_back();
         }
+        markDirty(tile);
     }
-    return false;
 }
 
-bool BMPGenerator::containsK33() const {
-    // Перебираем все возможные наборы 6 вершин
-    for (size_t v1 = 0; v1 < m_vertices.size(); ++v1) {
-        for (size_t v2 = v1 + 1; v2 < m_vertices.size(); ++v2) {
-            for (size_t v3 = v2 + 1; v3 < m_vertices.size(); ++v3) {
-                // Проверяем, являются ли вершины v1, v2, v3 независимыми
-                if (hasEdgeBetween(v1, v2) || hasEdgeBetween(v1, v3) || hasEdgeBetween(v2, v3))
-                    continue; // Если не являются, пропускаем текущую тройку
-
-                for (size_t v4 = 0; v4 < m_vertices.size(); ++v4) {
-                    if (v4 == v1 || v4 == v2 || v4 == v3) continue; // Убеждаемся, что v4 не является частью первой тройки
-
-                    // Проверяем, являются ли вершины v1, v2, v3 и v4 независимыми
-                    if (hasEdgeBetween(v1, v4) || hasEdgeBetween(v2, v4) || hasEdgeBetween(v3, v4))
-                        continue; // Если не являются, пропускаем текущую четвёрку
-
-                    for (size_t v5 = v4 + 1; v5 < m_vertices.size(); ++v5) {
-                        if (v5 == v1 || v5 == v2 || v5 == v3) continue; // Убеждаемся, что v5 не является частью первой тройки
-
-                        // Проверяем, являются ли вершины v1, v2, v3, v4 и v5 независимыми
-                        if (hasEdgeBetween(v1, v5) || hasEdgeBetween(v2, v5) || hasEdgeBetween(v3, v5) || hasEdgeBetween(v4, v5))
-                            continue; // Если не являются, пропускаем текущую пятерку
-
-                        for (size_t v6 = v5 + 1; v6 < m_vertices.size(); ++v6) {
-                            if (v6 == v1 || v6 == v2 || v6 == v3) continue; // Убеждаемся, что v6 не является частью первой тройки
-
-                            // Проверяем, являются ли вершины v1, v2, v3, v4, v5 и v6 независимыми
-                            if (!hasEdgeBetween(v4, v6) && !hasEdgeBetween(v5, v6)) {
-                                // Если все условия выполнены, это K3,3
-                                return true;
-                            }
-                        }
-                    }
-                }
-            }
+void BMPGenerator::attachVertex(size_t vertex) {
+    if (m_tiles.columns == 0) {
+        return;
+    }
+    std::vector<uint32_t> touched;
+    vertexTiles(vertex, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+    for (uint32_t tile : touched) {
+        m_tiles.vertices[tile].push_back(static_cast<uint32_t>(vertex));
+        markDirty(tile);
+    }
+}
+
+void BMPGenerator::detachVertex(size_t vertex) {
+    if (m_tiles.columns == 0) {
+        return;
+    }
+    std::vector<uint32_t> touched;
+    vertexTiles(vertex, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+    for (uint32_t tile : touched) {
+        std::vector<uint32_t>& bin = m_tiles.vertices[tile];
+        auto it = std::find(bin.begin(), bin.end(), static_cast<uint32_t>(vertex));
+        if (it != bin.end()) {
+            *it = bin.back();
+            bin.pop_back();
         }
+        markDirty(tile);
     }
-    // Если не найдено K3,3
-    return false;
 }
 
-void BMPGenerator::modifyForK5() {
-    // Находим набор вершин, образующих K5
-    std::vector<size_t> k5Vertices = findK5Vertices();
+ClipRect BMPGenerator::tileRect(uint32_t tile) const {
+    int column = static_cast<int>(tile % m_tiles.columns);
+    int row = static_cast<int>(tile / m_tiles.columns);
+    ClipRect rect = { column * kDirtyTileSize, row * kDirtyTileSize,
+        std::min((column + 1) * kDirtyTileSize, m_width), std::min((row + 1) * kDirtyTileSize, m_height) };
+    return rect;
+}
+
+void BMPGenerator::buildTileGrid() {
+    m_tiles.columns = (m_width + kDirtyTileSize - 1) / kDirtyTileSize;
+    m_tiles.rows = (m_height + kDirtyTileSize - 1) / kDirtyTileSize;
+    size_t tiles = static_cast<size_t>(m_tiles.columns) * m_tiles.rows;
+    m_tiles.edges.assign(tiles, std::vector<uint32_t>());
+    m_tiles.vertices.assign(tiles, std::vector<uint32_t>());
+    m_tiles.dirty.clear();
+    m_tiles.isDirty.assign(tiles, 0);
 
+    std::vector<uint32_t> touched;
+    for (size_t i = 0; i < m_graph.edgeCount(); ++i) {
+        touched.clear();
+        edgeTiles(i, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+        for (uint32_t tile : touched) {
+            m_tiles.edges[tile].push_back(static_cast<uint32_t>(i));
+        }
+    }
+    for (size_t i = 0; i < m_graph.vertexCount(); ++i) {
+        touched.clear();
+        vertexTiles(i, kDirtyTileSize, kDirtyTileSize, m_tiles.columns, touched);
+        for (uint32_t tile : touched) {
+            m_tiles.vertices[tile].push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+void BMPGenerator::redrawTile(uint32_t tile) {
+    // Плитка очищается и рисуется заново по своим корзинам, затем её строки перекодируются
+    // на свои места в файле (строки BMP идут снизу вверх). Ширина плитки кратна 64, поэтому
+    // соседние плитки не делят ни слов карты, ни байтов файла
+    ClipRect clip = tileRect(tile);
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        m_canvas.clearSpan(y, clip.x0, clip.x1 - 1);
+    }
+    for (uint32_t i : m_tiles.edges[tile]) {
+        Edge edge = m_graph.edge(i);
+        drawLine(m_canvas, clip, m_graph.x(edge.vertex1), m_graph.y(edge.vertex1),
+            m_graph.x(edge.vertex2), m_graph.y(edge.vertex2));
+    }
+    for (uint32_t i : m_tiles.vertices[tile]) {
+        drawVertex(m_canvas, clip, i);
+    }
+    const size_t bytesPerRow = m_encoder.rowBytes(m_width);
+    uint8_t* data = m_image.data() + m_encoder.dataOffset();
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        m_encoder.encodeSpan(m_canvas.row(y), clip.x0, clip.x1, data + static_cast<size_t>(m_height - 1 - y) * bytesPerRow);
+    }
+}
+
+size_t BMPGenerator::updateImage(BMPFormat format) {
+    GRAPH_PROFILE_SCOPE("render.incremental");
+    if (m_width <= 0 || m_height <= 0) {
+        return 0;
+    }
+    if (m_tiles.columns == 0 || format != m_imageFormat) {
+        // Полное построение: раскладка по плиткам, отрисовка и кодирование всего изображения
+        m_imageFormat = format;
+        m_encoder.setFormat(format);
+        buildTileGrid();
+        m_canvas.reset(m_width, m_height);
+        if (m_graph.edgeCount() + m_graph.vertexCount() >= kTiledRenderThreshold && threadPool().size() > 1) {
+            renderTiled(m_canvas, threadPool());
+        }
+        else {
+            render(m_canvas);
+        }
+        std::ostringstream header;
+        m_encoder.writeHeader(header, m_width, m_height);
+        const std::string headerBytes = header.str();
+        m_image.assign(headerBytes.begin(), headerBytes.end());
+        m_image.resize(m_encoder.fileSize(m_width, m_height));
+        const size_t bytesPerRow = m_encoder.rowBytes(m_width);
+        for (int y = 0; y < m_height; ++y) {
+            m_encoder.encodeRow(m_canvas.row(y), m_width, m_image.data() + headerBytes.size() + static_cast<size_t>(m_height - 1 - y) * bytesPerRow);
+        }
+        return m_tiles.edges.size();
+    }
+
+    m_encoder.setFormat(format);
+    std::vector<uint32_t> dirty;
+    dirty.swap(m_tiles.dirty);
+    for (uint32_t tile : dirty) {
+        m_tiles.isDirty[tile] = 0;
+    }
+    // Плитки не пересекаются, поэтому большие обновления перерисовываются параллельно
+    if (dirty.size() >= static_cast<size_t>(kTilesPerThread) * 4 && threadPool().size() > 1) {
+        threadPool().run(dirty.size(), [&](size_t i) { redrawTile(dirty[i]); });
+    }
+    else {
+        for (uint32_t tile : dirty) {
+            redrawTile(tile);
+        }
+    }
+    return dirty.size();
+}
+
+void BMPGenerator::generateIncremental(const std::string& filename, BMPFormat format) {
+    updateImage(format);
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: unable to open file " << filename << std::endl;
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(m_image.data()), m_image.size());
+    GRAPH_PROFILE_COUNT("bytes.written", m_image.size());
+}
+
+bool BMPGenerator::isGraphPlanar() const {
+    // Линейная проверка left-right алгоритмом вместо перебора подмножеств вершин
+    return isPlanar(index());
+}
+
+PlanarityResult BMPGenerator::testPlanarity(bool extractWitness) const {
+    return ::testPlanarity(index(), extractWitness);
+}
+
+bool BMPGenerator::containsK5() const {
+    // Поиск клики из 5 вершин в 4-ядре графа
+    return !findK5Vertices().empty();
+}
+
+bool BMPGenerator::hasEdgeBetween(size_t v1, size_t v2) const {
+    // Проверяем, есть ли ребро между вершинами v1 и v2, по индексу смежности
+    return index().hasEdge(v1, v2);
+}
+
+bool BMPGenerator::containsK33() const {
+    // Поиск K3,3 в 3-ядре графа
+    return !findK33Edges().empty();
+}
+
+void BMPGenerator::modifyForK5(const KuratowskiSubgraph& kuratowski) {
     // Проверяем, найден ли K5
-    if (k5Vertices.empty()) {
+    if (kuratowski.type != KuratowskiType::K5) {
         std::cout << "No K5 found." << std::endl;
         return;
     }
+    const std::vector<size_t>& k5Vertices = kuratowski.branchVertices;
 
     // Выводим индексы вершин K5
     std::cout << "Vertices forming K5: ";
@@ -339,35 +1271,44 @@ void BMPGenerator::modifyForK5() {
     }
     std::cout << std::endl;
 
+    highlightKuratowski(kuratowski, makeColor(220, 0, 0)); // Подразбиение K5 выделяется красным
+
     // Меняем координаты вершин
     for (auto v : k5Vertices) {
-        // Здесь можно изменить координаты вершин, например:
-        m_vertices[v].x += 10; // Увеличиваем координату X на 10
-        m_vertices[v].y += 10; // Увеличиваем координату Y на 10
+        // Сдвигаем вершину на 10 по обеим осям
+        moveVertex(v, m_graph.x(v) + 10, m_graph.y(v) + 10);
     }
 }
 
-void BMPGenerator::modifyForK33() {
-    // Находим набор вершин, образующих K33
-    std::vector<std::pair<size_t, size_t>> k33Edges = findK33Edges();
+void BMPGenerator::modifyForK33(const KuratowskiSubgraph& kuratowski) {
+    if (kuratowski.type != KuratowskiType::K33) {
+        std::cout << "No K33 found." << std::endl;
+        return;
+    }
 
-    // Модификация структуры рёбер
-    for (const auto& edge : k33Edges) {
-        // Проверяем, существует ли уже такое ребро в нашей структуре
-        bool edgeExists = false;
-        for (const auto& existingEdge : m_edges) {
-            if ((existingEdge.vertex1 == edge.first && existingEdge.vertex2 == edge.second) ||
-                (existingEdge.vertex1 == edge.second && existingEdge.vertex2 == edge.first)) {
-                edgeExists = true;
-                break;
-            }
+    highlightKuratowski(kuratowski, makeColor(220, 0, 0)); // Подразбиение K3,3 выделяется красным
+
+    // Рёбра K3,3 между ветвящимися вершинами двух долей (пути подразбиения стягиваются в рёбра)
+    std::vector<std::pair<size_t, size_t>> k33Edges;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 3; j < 6; ++j) {
+            size_t v1 = kuratowski.branchVertices[i];
+            size_t v2 = kuratowski.branchVertices[j];
+            k33Edges.emplace_back(std::min(v1, v2), std::max(v1, v2));
         }
+    }
 
-        // Если такого ребра ещё нет, то добавляем его
-        if (!edgeExists) {
-            m_edges.push_back({ edge.first, edge.second });
+    // Модификация структуры рёбер: недостающие рёбра находятся по индексу до изменений
+    // (пары k33Edges различны), затем добавляются
+    std::vector<std::pair<size_t, size_t>> missing;
+    for (const auto& edge : k33Edges) {
+        if (!index().hasEdge(edge.first, edge.second)) {
+            missing.push_back(edge);
         }
     }
+    for (const auto& edge : missing) {
+        addEdge(edge.first, edge.second);
+    }
 
     // Вывод рёбер K33 (для демонстрации)
     std::cout << "Edges forming K33: ";
@@ -379,74 +1320,31 @@ void BMPGenerator::modifyForK33() {
 
 
 std::vector<size_t> BMPGenerator::findK5Vertices() const {
-    std::vector<size_t> k5Vertices; // Вектор для хранения индексов вершин, образующих K5
-    // Перебираем все возможные наборы 5 вершин
-    for (size_t v1 = 0; v1 < m_vertices.size(); ++v1) {
-        for (size_t v2 = v1 + 1; v2 < m_vertices.size(); ++v2) {
-            for (size_t v3 = v2 + 1; v3 < m_vertices.size(); ++v3) {
-                for (size_t v4 = v3 + 1; v4 < m_vertices.size(); ++v4) {
-                    for (size_t v5 = v4 + 1; v5 < m_vertices.size(); ++v5) {
-                        // Проверяем, существует ли хотя бы одно ребро между вершинами данного набора
-                        if (!hasEdgeBetween(v1, v2) && !hasEdgeBetween(v1, v3) && !hasEdgeBetween(v1, v4) && !hasEdgeBetween(v1, v5) &&
-                            !hasEdgeBetween(v2, v3) && !hasEdgeBetween(v2, v4) && !hasEdgeBetween(v2, v5) &&
-                            !hasEdgeBetween(v3, v4) && !hasEdgeBetween(v3, v5) &&
-                            !hasEdgeBetween(v4, v5)) {
-                            // Если нет ни одного ребра, то найден K5, добавляем вершины в вектор
-                            k5Vertices.push_back(v1);
-                            k5Vertices.push_back(v2);
-                            k5Vertices.push_back(v3);
-                            k5Vertices.push_back(v4);
-                            k5Vertices.push_back(v5);
-                            return k5Vertices; // Найден один набор вершин образующих K5, завершаем поиск
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    // Если не найдено K5, возвращаем пустой вектор
-    return k5Vertices;
+    // Пять попарно смежных вершин или пустой вектор
+    return findK5Clique(index(), threadPool());
 }
 
 std::vector<std::pair<size_t, size_t>> BMPGenerator::findK33Edges() const {
     std::vector<std::pair<size_t, size_t>> k33Edges;
+    std::vector<size_t> vertices = findK33Biclique(index(), threadPool());
 
-    // Перебираем все возможные комбинации вершин
-    for (size_t v1 = 0; v1 < m_vertices.size(); ++v1) {
-        for (size_t v2 = v1 + 1; v2 < m_vertices.size(); ++v2) {
-            for (size_t v3 = v2 + 1; v3 < m_vertices.size(); ++v3) {
-                // Формируем множества вершин
-                std::set<size_t> set1 = { v1, v2, v3 };
-                std::set<size_t> set2;
-                for (size_t i = 0; i < m_vertices.size(); ++i) {
-                    if (i != v1 && i != v2 && i != v3) {
-                        set2.insert(i);
-                    }
-                }
-
-                // Проверяем, являются ли два множества независимыми
-                bool isIndependent = true;
-                for (const auto& edge : m_edges) {
-                    size_t v1 = edge.vertex1;
-                    size_t v2 = edge.vertex2;
-                    if ((set1.count(v1) && set1.count(v2)) || (set2.count(v1) && set2.count(v2))) {
-                        isIndependent = false;
-                        break;
-                    }
-                }
-
-                // Если два множества независимы, то добавляем соответствующие рёбра в результат
-                if (isIndependent) {
-                    for (size_t v1 : set1) {
-                        for (size_t v2 : set2) {
-                            k33Edges.emplace_back(std::min(v1, v2), std::max(v1, v2));
-                        }
-                    }
-                }
+    // Девять рёбер между долями найденного K3,3
+    if (!vertices.empty()) {
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 3; j < 6; ++j) {
+                k33Edges.emplace_back(std::min(vertices[i], vertices[j]), std::max(vertices[i], vertices[j]));
             }
         }
     }
-
     return k33Edges;
 }
+
+ThreadPool& BMPGenerator::threadPool() const {
+    if (m_externalPool) {
+        return *m_externalPool;
+    }
+    if (!m_pool) {
+        m_pool.reset(new ThreadPool());
+    }
+    return *m_pool;
+}
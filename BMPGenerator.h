@@ -6,36 +6,218 @@
 #include <ctime>
 #include <cstdlib>
 #include <sstream>
-#include <set>
+#include <functional>
+#include <memory>
 #include "Vertex.h"
 #include "Edge.h"
+#include "Bitmap.h"
+#include "Framebuffer.h"
+#include "BMPEncoder.h"
+#include "CrossingCounter.h"
+#include "GraphIndex.h"
+#include "GraphStorage.h"
+#include "ImageEncoder.h"
+#include "KuratowskiSearch.h"
+#include "LabelPlacement.h"
+#include "PlanarityTest.h"
+#include "ThreadPool.h"
+
+// Целочисленный отрезок Брезенхэма от (x0, y0) к (x1, y1) без конечной точки: major шагов,
+// шаг i можно вычислить напрямую, что позволяет начинать отрисовку с любого места отрезка
+struct BresenhamLine {
+    BresenhamLine(int x0, int y0, int x1, int y1);
+
+    // Координаты пикселя шага i
+    void pixel(int64_t i, int& x, int& y) const;
+    // Диапазон шагов [first, last], пиксели которых лежат в rect; false, если таких нет
+    bool clip(const ClipRect& rect, int64_t& first, int64_t& last) const;
+
+    int x0, y0;
+    int sx, sy;
+    bool steep; // Главная ось — y
+    int64_t major, minor; // Приращения по главной и второй осям
+};
+
+// Сглаженный отрезок цветной отрисовки толщиной strokeWidth от (x0, y0) к (x1, y1). Настройка
+// (длина, направление, границы строк) считается один раз на кадр, а BMPGenerator::drawLineColor
+// рисует часть отрезка в каждой полосе без повторного расчёта
+struct AntialiasedLine {
+    AntialiasedLine(int x0, int y0, int x1, int y1, float strokeWidth);
+
+    int x0, y0;
+    int dx, dy;
+    int yFirst, yLast; // Строки с ненулевым покрытием; yFirst > yLast — отрезок нулевой длины
+    float length, ux, uy; // Длина и единичное направление
+    float reach; // Полуширина с запасом на сглаживание
+    bool acrossBound, alongBound; // Не почти горизонтальный и не почти вертикальный
+    float acrossSlope, acrossHalf, alongSlope, alongStart, alongEnd;
+    int32_t stepFixed, limitFixed; // Покрытие поперёк в целых числах (CoverageMask::addRamp)
+    // Строки рисуются окном из window пикселей, строки [runFirst, runLast] — без проверок концов
+    // (CoverageMask::addSteepLine); runFirst > runLast — таких строк нет, window == 0 — окно не используется
+    int runFirst, runLast, window;
+    int64_t runSlope, runHalfWidth; // Сдвиг оси за строку и полуширина окна в формате 16.16
+    int64_t runCenter, runStep; // Ось в строке runFirst и её сдвиг за строку в формате 32.32
+};
 
 class BMPGenerator {
 public:
     BMPGenerator(int width, int height, const std::vector<Vertex>& vertices, const std::vector<Edge>& edges);
+    // Граф принимается без копирования: BMPGenerator(w, h, GraphStorage(std::move(vertices), std::move(edges)))
+    BMPGenerator(int width, int height, GraphStorage&& graph);
     bool isGraphPlanar() const;
-    void generate(const std::string& filename);
+    PlanarityResult testPlanarity(bool extractWitness = false) const;
+    // Формат файлов generate, generateColor и generateDensity. По умолчанию — несжатый BMP в формате
+    // пикселей, переданном generate; сжатые форматы (ImageEncoder.h) кодируются из изображения
+    // целиком, поэтому огромные холсты полосами в них не пишутся
+    void setOutputFormat(ImageFormat format) { m_outputFormat = format; }
+    ImageFormat outputFormat() const { return m_outputFormat; }
+    // Пул для параллельного поиска и отрисовки вместо собственного (по числу ядер, создаётся при первом
+    // использовании); пул не переходит во владение генератора. С пулом из одного потока вся работа идёт
+    // в вызывающем потоке: так генератор используется внутри задания другого пула
+    void setThreadPool(ThreadPool* pool) { m_externalPool = pool; }
+    void generate(const std::string& filename, BMPFormat format = BMPFormat::Rgb24);
+    // Потоковая запись полосами по bandHeight строк (0 — по kStreamingBandBytes): каждая полоса рисуется
+    // и сразу пишется в файл, поэтому память зависит от высоты полосы и числа рёбер, а не от площади холста
+    void generateStreaming(const std::string& filename, BMPFormat format = BMPFormat::Rgb24, int bandHeight = 0);
+    void encodeStreaming(std::ostream& file, BMPFormat format, int bandHeight = 0);
+    void render(Bitmap& bitmap);
+    void renderTiled(Bitmap& bitmap, ThreadPool& pool);
     bool hasEdgeBetween(size_t v1, size_t v2) const;
+
+    // Расстановка меток без наложений (LabelPlacement.h) для текущих координат вершин; до вызова метки
+    // рисуются справа снизу от вершины. При перемещении вершины метка сдвигается вместе с ней.
+    // Возвращает число видимых меток
+    size_t placeLabels();
+
+    // Число пересечений рёбер при текущих координатах (CrossingCounter.h); pairs получает пары
+    // номеров пересекающихся рёбер
+    uint64_t countCrossings(std::vector<std::pair<size_t, size_t>>* pairs = nullptr) const;
+    // То же с ограничением работы pairBudget проверками пар: сверх него — оценка по случайной выборке пар
+    CrossingEstimate estimateCrossings(uint64_t pairBudget) const;
+
+    // Цветная отрисовка со сглаживанием в 24-битный BMP. Рёбра и вершины по умолчанию чёрные,
+    // толщина линий задаётся в пикселях
+    void setEdgeColor(size_t edge, Color color);
+    void setVertexColor(size_t vertex, Color color);
+    void setStrokeWidth(float width) { m_strokeWidth = width; }
+    // Выделение цветом рёбер и ветвящихся вершин подграфа Куратовского
+    void highlightKuratowski(const KuratowskiSubgraph& kuratowski, Color color);
+    void renderColor(Framebuffer& framebuffer);
+    void generateColor(const std::string& filename);
+
+    // Отрисовка с понижением детализации для очень плотных графов (DensityMap.h): вместо линий и вершин —
+    // полутоновая карта плотности рёбер в 8-битный BMP с палитрой оттенков серого. cellSize — сторона
+    // ячейки карты в пикселях, 0 — по суммарной длине рёбер
+    void renderDensity(GrayImage& image, int cellSize = 0);
+    void generateDensity(const std::string& filename, int cellSize = 0);
+
+    // Изменение графа после создания. Новое ребро получает номер edgeCount() - 1, а при удалении
+    // на место удалённого ребра переносится последнее. Каждое изменение отмечает плитки изображения,
+    // которых касаются старое и новое положение рёбер и вершин, и updateImage перерисовывает только их.
+    // Возвращают false при неверных номерах
+    bool addEdge(size_t v1, size_t v2);
+    bool removeEdge(size_t edge);
+    bool moveVertex(size_t vertex, int x, int y);
+    size_t edgeCount() const { return m_graph.edgeCount(); }
+    const GraphStorage& graph() const { return m_graph; }
+    // Обновление изображения BMP в памяти: первый вызов (и смена формата) строит его целиком, следующие
+    // перерисовывают и перекодируют только отмеченные плитки. Возвращает число перерисованных плиток
+    size_t updateImage(BMPFormat format = BMPFormat::Rgb24);
+    const std::vector<uint8_t>& image() const { return m_image; }
+    void generateIncremental(const std::string& filename, BMPFormat format = BMPFormat::Rgb24);
+
     bool containsK5() const;
     bool containsK33() const;
-    void modifyForK5();
-    void modifyForK33();
+    // Изменение графа по подразбиению, уже найденному testPlanarity (PlanarityResult::kuratowski):
+    // подразбиение выделяется цветом, вершины K5 сдвигаются, недостающие рёбра K3,3 добавляются
+    void modifyForK5(const KuratowskiSubgraph& kuratowski);
+    void modifyForK33(const KuratowskiSubgraph& kuratowski);
+
+    static const int kTilesPerThread = 4; // Плиток на поток при отрисовке по плиткам
+    static const size_t kTiledRenderThreshold = 20000; // Число рёбер и вершин, начиная с которого generate рисует по плиткам
+    static const size_t kStreamingBandBytes = 16 << 20; // Размер полосы по умолчанию при потоковой записи
+    static const size_t kStreamingThreshold = 256 << 20; // Размер карты, начиная с которого generate пишет полосами
+    static const size_t kColorBandBytes = 2 << 20; // Размер полосы буфера кадра при цветной отрисовке (маска цвета вчетверо меньше)
+    static const size_t kColorMasks = 4; // Масок покрытий (цветов), смешиваемых с полосой за один проход
+    static const int kColorBlendRows = 16; // Строк в блоке смешивания масок с буфером кадра
+    static const int kExactSpan = 32; // Строки отрезка не длиннее считаются целиком по полной формуле покрытия
+    static const int kDirtyTileSize = 128; // Сторона плитки при инкрементальной перерисовке (кратна 64)
+    static const size_t kDensityRenderThreshold = 2000000; // Число рёбер, начиная с которого main рисует карту плотности
+    static const int kDensityLayoutIterations = 5; // Итераций силовой укладки графа, который main рисует картой плотности
+    static const uint64_t kCrossingPairBudget = 50000000; // Проверок пар рёбер, сверх которых main оценивает число пересечений
 
 private:
     void writeHeader(std::ofstream& file);
     void writeImageData(std::ofstream& file);
-    void drawText(std::vector<std::vector<bool>>& bitmap, const std::string& text, int x, int y);
-    void drawCharacter(std::vector<std::vector<bool>>& bitmap, char character, int x, int y);
-    void drawLine(std::vector<std::vector<bool>>& bitmap, int x0, int y0, int x1, int y1);
-    void drawCircle(std::vector<std::vector<bool>>& bitmap, int xc, int yc);
-    void writeInt(std::ofstream& file, int value);
-    void writeShort(std::ofstream& file, short value);
+    void renderBitmap(Bitmap& bitmap); // По плиткам на всех ядрах для больших графов
+    // Запись изображения кодировщиком выбранного сжатого формата
+    template<typename Image>
+    void writeEncoded(const std::string& filename, const Image& image);
+    // Примитивы рисуют только пиксели внутри clip; clip всегда лежит внутри битовой карты
+    void drawVertex(Bitmap& bitmap, const ClipRect& clip, size_t vertex);
+    void drawText(Bitmap& bitmap, const ClipRect& clip, const char* text, size_t length, int x, int y);
+    void drawCharacter(Bitmap& bitmap, const ClipRect& clip, char character, int x, int y);
+    void drawLine(Bitmap& bitmap, const ClipRect& clip, int x0, int y0, int x1, int y1);
+    void drawCircle(Bitmap& bitmap, const ClipRect& clip, int xc, int yc);
+    ClipRect vertexBounds(size_t vertex) const; // Прямоугольник, накрывающий круг и метку вершины
+    LabelOffset labelOffset(size_t vertex) const { return vertex < m_labelOffsets.size() ? m_labelOffsets[vertex] : LabelOffset(); }
+    // Номера плиток (row * columns + column) сетки с шагом tileWidth x tileHeight, которых касаются
+    // пиксели ребра или прямоугольник вершины; номера добавляются в tiles
+    void edgeTiles(size_t edge, int tileWidth, int tileHeight, int columns, std::vector<uint32_t>& tiles) const;
+    void vertexTiles(size_t vertex, int tileWidth, int tileHeight, int columns, std::vector<uint32_t>& tiles) const;
+    // Обход холста полосами по bandHeight строк снизу вверх: для каждой полосы вызывается drawBand
+    // с её прямоугольником и списками пересекающих её рёбер (с запасом edgeMargin строк) и вершин
+    typedef std::function<void(const ClipRect&, const std::vector<uint32_t>&, const std::vector<uint32_t>&)> BandCallback;
+    void sweepBands(int bandHeight, int edgeMargin, const BandCallback& drawBand) const;
+    // Покрытия сглаженного отрезка в маску (строки clip лежат внутри маски)
+    void drawLineColor(CoverageMask& mask, const ClipRect& clip, const AntialiasedLine& line) const;
+    void drawVertexColor(Framebuffer& framebuffer, const ClipRect& clip, size_t vertex) const;
+    Color edgeColor(size_t edge) const { return edge < m_edgeColors.size() ? m_edgeColors[edge] : kBlack; }
+    Color vertexColor(size_t vertex) const { return vertex < m_vertexColors.size() ? m_vertexColors[vertex] : kBlack; }
+    // Инкрементальное изображение: раскладка рёбер и вершин по плиткам и отметка изменённых плиток
+    void buildTileGrid();
+    void attachEdge(size_t edge);
+    void detachEdge(size_t edge);
+    void attachVertex(size_t vertex);
+    void detachVertex(size_t vertex);
+    void markDirty(uint32_t tile);
+    ClipRect tileRect(uint32_t tile) const;
+    void redrawTile(uint32_t tile);
+    void buildIncidentEdges();
+    const GraphIndex& index() const; // Индекс смежности, перестроенный после изменений рёбер
 
 private:
     int m_width;
     int m_height;
-    std::vector<Vertex> m_vertices;
-    std::vector<Edge> m_edges;
+    GraphStorage m_graph; // Координаты, метки и рёбра
+    mutable GraphIndex m_index; // Индекс смежности по рёбрам m_graph для всех запросов о рёбрах
+    mutable bool m_indexStale; // Рёбра менялись после построения индекса
+    BMPEncoder m_encoder; // Кодировщик с буфером, переиспользуемым между вызовами generate
+    std::vector<Color> m_edgeColors; // Цвета рёбер; рёбра за концом списка чёрные
+    std::vector<Color> m_vertexColors;
+    float m_strokeWidth;
+    std::vector<LabelOffset> m_labelOffsets; // Положения меток после placeLabels; пусто — все метки справа снизу
+
+    // Раскладка по плиткам kDirtyTileSize x kDirtyTileSize для инкрементальной перерисовки;
+    // columns == 0, пока изображение не построено
+    struct TileGrid {
+        int columns;
+        int rows;
+        std::vector<std::vector<uint32_t>> edges; // Рёбра, задевающие плитку
+        std::vector<std::vector<uint32_t>> vertices; // Вершины, круг или метка которых задевает плитку
+        std::vector<uint32_t> dirty; // Плитки, ожидающие перерисовки
+        std::vector<uint8_t> isDirty;
+        TileGrid() : columns(0), rows(0) {}
+    };
+    TileGrid m_tiles;
+    std::vector<std::vector<uint32_t>> m_incidentEdges; // Рёбра каждой вершины (петля учитывается один раз)
+    Bitmap m_canvas; // Битовая карта инкрементального изображения
+    std::vector<uint8_t> m_image; // Закодированный файл BMP
+    BMPFormat m_imageFormat;
+    ImageFormat m_outputFormat;
+    mutable std::unique_ptr<ThreadPool> m_pool; // Создаётся при первом параллельном поиске или отрисовке
+    ThreadPool* m_externalPool; // Пул, заданный setThreadPool, или nullptr
     std::vector<size_t> findK5Vertices() const;
     std::vector<std::pair<size_t, size_t>> findK33Edges() const;
+    ThreadPool& threadPool() const;
 };
@@ -0,0 +1,276 @@
+#include "BatchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include "BMPGenerator.h"
+#include "FileReader.h"
+#include "ForceLayout.h"
+#include "GraphIndex.h"
+#include "ImageEncoder.h"
+#include "PlanarLayout.h"
+#include "PlanarityTest.h"
+#include "ThreadPool.h"
+
+namespace {
+
+enum Stage {
+    Load,
+    Planarity,
+    Layout,
+    Render,
+    Encode
+};
+
+const char* const kStageNames[BatchRunner::kStageCount] = { "load", "planarity", "layout", "render", "encode" };
+
+// Граф на пути через конвейер; каждая стадия заполняет свои поля
+struct BatchJob {
+    const BatchEntry* entry;
+    bool failed;
+    int width;
+    int height;
+    std::vector<Vertex> vertices; // Координаты до переноса в хранилище после укладки
+    GraphStorage graph; // Рёбра читаются прямо в хранилище
+    PlanarityResult planarity;
+    Bitmap bitmap; // Планарный граф рисуется монохромно
+    Framebuffer framebuffer; // Непланарный — в цвете, с выделенным подграфом Куратовского
+
+    BatchJob() : entry(nullptr), failed(false), width(0), height(0) {}
+};
+
+void loadGraph(BatchJob& job) {
+    if (job.entry->malformed) {
+        job.failed = true; // Ошибка уже сообщена при чтении манифеста
+        return;
+    }
+    int numVertices = 0;
+    readInputFromFile(job.entry->headerFile, numVertices, job.width, job.height);
+    if (numVertices <= 0 || job.width <= 0 || job.height <= 0) {
+        std::cerr << "Error: invalid graph header in " << job.entry->headerFile << std::endl;
+        job.failed = true;
+        return;
+    }
+    job.vertices.resize(numVertices); // Метки (номера вершин) назначаются при отрисовке
+    // Неоткрывшийся файл рёбер или рёбра с неверными номерами (они пропускаются) — ошибка графа:
+    // иначе изображение без рёбер записалось бы как успешное
+    if (!readEdgesFromFileFast(job.entry->edgeFile, job.graph, job.vertices.size())) {
+        job.failed = true;
+    }
+}
+
+void checkPlanarity(BatchJob& job) {
+    job.planarity = testPlanarity(GraphIndex(job.vertices.size(), job.graph.endpoints()), true);
+}
+
+void layoutGraph(BatchJob& job) {
+    if (job.planarity.planar) {
+        if (!PlanarLayout().run(job.vertices, job.planarity.embedding, job.width, job.height)) {
+            std::cerr << "Warning: the planar grid layout of " << job.entry->edgeFile << " does not fit "
+                << job.width << "x" << job.height << " pixels; rounding to pixels may introduce edge crossings." << std::endl;
+        }
+        return;
+    }
+    ForceLayout layout;
+    layout.run(job.vertices, job.graph.endpoints(), job.width, job.height);
+}
+
+void renderGraph(BatchJob& job) {
+    // Граф переходит в хранилище BMPGenerator; следующей стадии нужны только изображение и результат проверки
+    job.graph.appendVertices(job.vertices);
+    std::vector<Vertex>().swap(job.vertices);
+    job.graph.setIndexLabels();
+    BMPGenerator generator(job.width, job.height, std::move(job.graph));
+    // Графы отрисовываются параллельно друг другу, поэтому генератор работает в потоке стадии,
+    // а не создаёт свой пул по числу ядер в каждом задании
+    ThreadPool serial(1);
+    generator.setThreadPool(&serial);
+    generator.placeLabels();
+    if (job.planarity.planar) {
+        job.bitmap.reset(job.width, job.height);
+        generator.render(job.bitmap);
+    }
+    else {
+        generator.highlightKuratowski(job.planarity.kuratowski, makeColor(220, 0, 0));
+        job.framebuffer.reset(job.width, job.height);
+        generator.renderColor(job.framebuffer);
+    }
+}
+
+void encodeGraph(BatchJob& job) {
+    std::ofstream file(job.entry->outputFile, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: unable to open file " << job.entry->outputFile << std::endl;
+        job.failed = true;
+        return;
+    }
+    // Формат — по расширению выходного файла. Графы кодируются параллельно друг другу,
+    // поэтому полосы одного изображения сжимаются в том же потоке
+    std::unique_ptr<ImageEncoder> encoder = createImageEncoder(imageFormatForFile(job.entry->outputFile));
+    bool written = job.planarity.planar ? encoder->encode(file, job.bitmap) : encoder->encode(file, job.framebuffer);
+    job.failed = !written;
+}
+
+void runStage(int stage, BatchJob& job) {
+    if (job.failed) {
+        return; // Граф с ошибкой проходит оставшиеся стадии без работы
+    }
+    switch (stage) {
+    case Load:
+        loadGraph(job);
+        break;
+    case Planarity:
+        checkPlanarity(job);
+        break;
+    case Layout:
+        layoutGraph(job);
+        break;
+    case Render:
+        renderGraph(job);
+        break;
+    case Encode:
+        encodeGraph(job);
+        break;
+    }
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(const BatchSettings& settings)
+    : m_settings(settings), m_wallSeconds(0), m_succeeded(0), m_failed(0), m_threads(0) {
+    for (size_t i = 0; i < kStageCount; ++i) {
+        m_stats.push_back({ kStageNames[i], 0, 0.0 });
+    }
+}
+
+bool BatchRunner::readManifest(const std::string& filename, std::vector<BatchEntry>& entries) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        BatchEntry entry;
+        if (!(fields >> entry.headerFile) || entry.headerFile[0] == '#') {
+            continue;
+        }
+        if (!(fields >> entry.edgeFile >> entry.outputFile)) {
+            std::cerr << "Error: " << filename << ":" << lineNumber << ": expected header, edge and output files" << std::endl;
+            entry.malformed = true;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+size_t BatchRunner::run(const std::vector<BatchEntry>& entries) {
+    for (auto& stats : m_stats) {
+        stats.items = 0;
+        stats.busySeconds = 0;
+    }
+    m_succeeded = 0;
+    m_failed = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // queues[s] — графы, прошедшие стадию s и ожидающие стадию s + 1; reserved[s] — места,
+    // занятые графами, которые сейчас обрабатываются стадией s. Последняя стадия выходной очереди не имеет
+    const size_t capacity = std::max<size_t>(m_settings.queueCapacity, 1);
+    std::deque<std::unique_ptr<BatchJob>> queues[kStageCount - 1];
+    size_t reserved[kStageCount - 1] = {};
+    size_t nextEntry = 0;
+    size_t finished = 0;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    auto worker = [&](size_t) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (finished < entries.size()) {
+            // Самая поздняя стадия, у которой есть вход и место на выходе
+            int stage = -1;
+            for (int s = static_cast<int>(kStageCount) - 1; s >= 0 && stage < 0; --s) {
+                bool hasInput = s == Load ? nextEntry < entries.size() : !queues[s - 1].empty();
+                bool hasRoom = s == Encode || queues[s].size() + reserved[s] < capacity;
+                if (hasInput && hasRoom) {
+                    stage = s;
+                }
+            }
+            if (stage < 0) {
+                changed.wait(lock);
+                continue;
+            }
+
+            std::unique_ptr<BatchJob> job;
+            if (stage == Load) {
+                job.reset(new BatchJob());
+                job->entry = &entries[nextEntry++];
+            }
+            else {
+                job = std::move(queues[stage - 1].front());
+                queues[stage - 1].pop_front();
+            }
+            if (stage != Encode) {
+                ++reserved[stage];
+            }
+            changed.notify_all(); // Освободилось место во входной очереди
+            lock.unlock();
+
+            auto stageStart = std::chrono::steady_clock::now();
+            runStage(stage, *job);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stageStart).count();
+
+            lock.lock();
+            m_stats[stage].items++;
+            m_stats[stage].busySeconds += seconds;
+            if (stage == Encode) {
+                if (job->failed) {
+                    ++m_failed;
+                }
+                else {
+                    ++m_succeeded;
+                }
+                ++finished;
+            }
+            else {
+                --reserved[stage];
+                queues[stage].push_back(std::move(job));
+            }
+            changed.notify_all();
+        }
+    };
+
+    ThreadPool pool(m_settings.threads);
+    m_threads = pool.size();
+    pool.run(pool.size(), worker);
+
+    m_wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return m_succeeded;
+}
+
+void BatchRunner::printReport(std::ostream& out) const {
+    out << "Batch: " << m_succeeded << " graphs written, " << m_failed << " failed, "
+        << m_wallSeconds << " s on " << m_threads << " threads";
+    if (m_wallSeconds > 0) {
+        out << " (" << (m_succeeded + m_failed) / m_wallSeconds << " graphs/s)";
+    }
+    out << std::endl;
+    // Пропускная способность стадии — графов в секунду на один поток, занятый этой стадией
+    for (const auto& stats : m_stats) {
+        out << "  " << stats.name << ": " << stats.items << " graphs, " << stats.busySeconds * 1000 << " ms busy";
+        if (stats.busySeconds > 0) {
+            out << ", " << stats.items / stats.busySeconds << " graphs/s per thread";
+        }
+        if (m_wallSeconds > 0 && m_threads > 0) {
+            out << ", " << 100.0 * stats.busySeconds / (m_wallSeconds * m_threads) << "% of pool time";
+        }
+        out << std::endl;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Один граф пакетного задания: файл заголовка, файл рёбер и выходной файл (.png — PNG, иначе BMP)
+struct BatchEntry {
+    std::string headerFile;
+    std::string edgeFile;
+    std::string outputFile;
+    bool malformed; // Строка манифеста не разобрана: запись не обрабатывается и считается неудачной
+
+    BatchEntry() : malformed(false) {}
+};
+
+// Параметры пакетной обработки
+struct BatchSettings {
+    size_t threads; // Рабочие потоки общего пула (0 — по числу аппаратных потоков)
+    size_t queueCapacity; // Вместимость очереди между соседними стадиями
+
+    BatchSettings() : threads(0), queueCapacity(16) {}
+};
+
+// Статистика стадии конвейера
+struct BatchStageStats {
+    const char* name;
+    size_t items; // Обработано графов
+    double busySeconds; // Суммарное время работы стадии во всех потоках
+};
+
+// Пакетная обработка многих графов в одном процессе. Каждый граф проходит стадии
+// загрузка → проверка планарности → укладка → отрисовка → кодирование. Между стадиями стоят
+// очереди ограниченной вместимости, а все стадии обслуживает общий пул потоков: свободный поток
+// берёт работу самой поздней стадии, у которой есть входной граф и место в выходной очереди.
+// Поэтому готовые графы уходят из конвейера первыми, а число графов в памяти ограничено.
+class BatchRunner {
+public:
+    static const size_t kStageCount = 5;
+
+    explicit BatchRunner(const BatchSettings& settings = BatchSettings());
+
+    // Чтение манифеста: в каждой строке три пути — заголовок, рёбра, выходной файл.
+    // Пустые строки и строки, начинающиеся с '#', пропускаются; неполная строка сообщается в std::cerr
+    // и добавляется с malformed = true, чтобы run учёл её как неудачу. false, если файл не открылся
+    static bool readManifest(const std::string& filename, std::vector<BatchEntry>& entries);
+
+    // Обработка всех графов; возвращает число успешно записанных изображений
+    size_t run(const std::vector<BatchEntry>& entries);
+
+    // Пропускная способность каждой стадии и всего конвейера после run
+    void printReport(std::ostream& out) const;
+    const std::vector<BatchStageStats>& stageStats() const { return m_stats; }
+
+private:
+    BatchSettings m_settings;
+    std::vector<BatchStageStats> m_stats;
+    double m_wallSeconds;
+    size_t m_succeeded;
+    size_t m_failed;
+    size_t m_threads;
+};
@@ -0,0 +1,1102 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "BMPEncoder.h"
+#include "BMPGenerator.h"
+#include "BinaryGraph.h"
+#include "CrossingCounter.h"
+#include "DensityMap.h"
+#include "Bitmap.h"
+#include "FileReader.h"
+#include "ForceLayout.h"
+#include "Framebuffer.h"
+#include "GraphGenerators.h"
+#include "GraphIndex.h"
+#include "ImageEncoder.h"
+#include "KuratowskiSearch.h"
+#include "LabelPlacement.h"
+#include "PlanarLayout.h"
+#include "PlanarityTest.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Замер среднего времени выполнения функции в миллисекундах
+template<typename Function>
+double measureMs(int repetitions, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+// Лучшее время одного выполнения из repetitions: для проверок требований, на которые не должна
+// влиять фоновая нагрузка
+template<typename Function>
+double bestMs(int repetitions, Function function) {
+    double best = 0;
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+// Поток, который только считает записанные байты: замеряется кодирование без дискового ввода-вывода
+class CountingBuffer : public std::streambuf {
+public:
+    CountingBuffer() : m_bytes(0) {}
+    size_t bytes() const { return m_bytes; }
+
+protected:
+    int_type overflow(int_type c) override {
+        ++m_bytes;
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        m_bytes += static_cast<size_t>(count);
+        return count;
+    }
+
+private:
+    size_t m_bytes;
+};
+
+// Результат одного замера. Имена вида «группа/что/размер» одинаковы от запуска к запуску,
+// поэтому отчёты JSON до и после изменения сравниваются по имени
+struct BenchmarkResult {
+    std::string name;
+    double ms;
+    double itemsPerSecond; // 0, если у замера нет естественной единицы работы
+    std::string label;
+};
+
+std::vector<BenchmarkResult> g_results;
+size_t g_maxEdges = 1000000; // Верхний размер масштабируемых замеров (--max-edges)
+size_t g_failedChecks = 0; // Непройденные проверки требований; main тогда возвращает 1
+
+void report(const std::string& name, double ms, const std::string& extra = "", double items = 0) {
+    double itemsPerSecond = items > 0 && ms > 0 ? items / (ms / 1000.0) : 0;
+    g_results.push_back({ name, ms, itemsPerSecond, extra });
+    std::printf("%-64s %12.3f ms", name.c_str(), ms);
+    if (itemsPerSecond > 0) {
+        std::printf(" %12.4g items/s", itemsPerSecond);
+    }
+    std::printf("%s%s\n", extra.empty() ? "" : "  ", extra.c_str());
+    std::fflush(stdout);
+}
+
+// Проверка требования к производительности: при нарушении печатается FAIL и main возвращает 1
+void check(bool passed, const std::string& requirement) {
+    if (!passed) {
+        ++g_failedChecks;
+        std::printf("FAIL: %s\n", requirement.c_str());
+        std::fflush(stdout);
+    }
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+// Отчёт JSON с полями, названными как в Google Benchmark: name, real_time (среднее время одного
+// повторения), time_unit, items_per_second, label
+bool writeJsonReport(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    file << "{\n  \"context\": {\"num_cpus\": " << std::max<unsigned>(std::thread::hardware_concurrency(), 1)
+         << ", \"max_edges\": " << g_maxEdges << ", \"profiling\": " << (Profiler::enabled() ? "true" : "false") << "},\n"
+         << "  \"benchmarks\": [";
+    for (size_t i = 0; i < g_results.size(); ++i) {
+        const BenchmarkResult& result = g_results[i];
+        file << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeJsonString(file, result.name);
+        file << ", \"real_time\": " << result.ms << ", \"time_unit\": \"ms\"";
+        if (result.itemsPerSecond > 0) {
+            file << ", \"items_per_second\": " << result.itemsPerSecond;
+        }
+        if (!result.label.empty()) {
+            file << ", \"label\": ";
+            writeJsonString(file, result.label);
+        }
+        file << "}";
+    }
+    file << "\n  ]\n}\n";
+    return file.good();
+}
+
+// Случайный граф на холсте заданного размера с детерминированным зерном
+void makeRandomGraph(int width, int height, size_t numVertices, size_t numEdges, unsigned seed,
+    std::vector<Vertex>& vertices, std::vector<Edge>& edges, bool withLabels = true) {
+    std::mt19937 random(seed);
+    vertices.clear();
+    edges.clear();
+    for (size_t i = 0; i < numVertices; ++i) {
+        vertices.push_back({ static_cast<int>(random() % width), static_cast<int>(random() % height), withLabels ? std::to_string(i) : std::string() });
+    }
+    for (size_t i = 0; i < numEdges; ++i) {
+        edges.push_back({ random() % numVertices, random() % numVertices });
+    }
+}
+
+// Прежняя отрисовка в std::vector<std::vector<bool>> — точка отсчёта для сравнения
+void legacyDrawLine(std::vector<std::vector<bool>>& bitmap, int width, int height, int x0, int y0, int x1, int y1) {
+    int dx = std::abs(x1 - x0);
+    int dy = std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    while (x0 != x1 || y0 != y1) {
+        if (x0 >= 0 && x0 < width && y0 >= 0 && y0 < height) {
+            bitmap[y0][x0] = true;
+        }
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void legacyDrawCircle(std::vector<std::vector<bool>>& bitmap, int width, int height, int xc, int yc) {
+    int radius = 7;
+    for (int y = yc - radius; y <= yc + radius; ++y) {
+        for (int x = xc - radius; x <= xc + radius; ++x) {
+            if (x >= 0 && x < width && y >= 0 && y < height) {
+                double distance = std::sqrt((x - xc) * (x - xc) + (y - yc) * (y - yc));
+                if (distance <= radius) {
+                    bitmap[y][x] = true;
+                }
+            }
+        }
+    }
+}
+
+void benchmarkRasterization() {
+    const int width = 3160;
+    const int height = 2580;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    // Метки не рисуются: прежняя отрисовка сравнивается только по рёбрам и вершинам
+    makeRandomGraph(width, height, 500, 20000, 1, vertices, edges, false);
+
+    double legacyMs = measureMs(3, [&]() {
+        std::vector<std::vector<bool>> bitmap(height, std::vector<bool>(width, false));
+        for (const auto& edge : edges) {
+            legacyDrawLine(bitmap, width, height, vertices[edge.vertex1].x, vertices[edge.vertex1].y,
+                vertices[edge.vertex2].x, vertices[edge.vertex2].y);
+        }
+        for (const auto& vertex : vertices) {
+            legacyDrawCircle(bitmap, width, height, vertex.x, vertex.y);
+        }
+    });
+    // vector<bool> хранит биты в словах по строкам плюс служебные данные каждой строки
+    size_t legacyBytes = height * (sizeof(std::vector<bool>) + (width + 63) / 64 * 8);
+    report("raster/vector<vector<bool>> 3160x2580, 20000 edges", legacyMs, std::to_string(legacyBytes) + " bytes");
+
+    BMPGenerator generator(width, height, vertices, edges);
+    size_t bitmapBytes = 0;
+    double bitmapMs = measureMs(3, [&]() {
+        Bitmap bitmap(width, height);
+        generator.render(bitmap);
+        bitmapBytes = bitmap.memoryBytes();
+    });
+    report("raster/Bitmap 3160x2580, 20000 edges", bitmapMs, std::to_string(bitmapBytes) + " bytes");
+}
+
+void benchmarkVertexDrawing() {
+    const int width = 3160;
+    const int height = 2580;
+    const size_t numVertices = 100000;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    makeRandomGraph(width, height, numVertices, 0, 6, vertices, edges);
+
+    double legacyMs = measureMs(3, [&]() {
+        std::vector<std::vector<bool>> bitmap(height, std::vector<bool>(width, false));
+        for (const auto& vertex : vertices) {
+            legacyDrawCircle(bitmap, width, height, vertex.x, vertex.y);
+        }
+    });
+    report("raster/legacy circles, 100000 vertices", legacyMs, std::to_string(legacyMs * 1e6 / numVertices) + " ns/vertex");
+
+    BMPGenerator generator(width, height, vertices, edges);
+    Bitmap bitmap(width, height);
+    double ms = measureMs(3, [&]() {
+        bitmap.clear();
+        generator.render(bitmap);
+    });
+    report("raster/circles and labels, 100000 vertices", ms, std::to_string(ms * 1e6 / numVertices) + " ns/vertex");
+}
+
+void benchmarkTiledRasterization() {
+    const int width = 3160;
+    const int height = 2580;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    makeRandomGraph(width, height, 5000, 300000, 5, vertices, edges);
+    BMPGenerator generator(width, height, vertices, edges);
+
+    Bitmap serial(width, height);
+    double serialMs = measureMs(3, [&]() {
+        serial.clear();
+        generator.render(serial);
+    });
+    report("raster/serial 3160x2580, 300000 edges", serialMs);
+
+    // Пул из одного потока показывает накладные расходы раскладки по плиткам
+    size_t hardwareThreads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    std::vector<size_t> threadCounts = { 1, 2, 4 };
+    if (hardwareThreads > 4) {
+        threadCounts.push_back(hardwareThreads);
+    }
+    for (size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        Bitmap tiled(width, height);
+        double tiledMs = measureMs(3, [&]() {
+            tiled.clear();
+            generator.renderTiled(tiled, pool);
+        });
+        bool identical = true;
+        for (int y = 0; y < height && identical; ++y) {
+            identical = std::equal(serial.row(y), serial.row(y) + serial.stride(), tiled.row(y));
+        }
+        report("raster/tiled " + std::to_string(threads) + " threads, 300000 edges", tiledMs,
+            identical ? "identical to serial" : "DIFFERS FROM SERIAL");
+    }
+}
+
+void benchmarkColorRendering() {
+    const int width = 3160;
+    const int height = 2580;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    makeRandomGraph(width, height, 2000, 20000, 11, vertices, edges);
+    BMPGenerator generator(width, height, vertices, edges);
+    for (size_t i = 0; i < edges.size(); i += 7) {
+        generator.setEdgeColor(i, makeColor(220, 0, 0));
+    }
+
+    Bitmap bitmap(width, height);
+    auto renderMonochrome = [&]() {
+        bitmap.clear();
+        generator.render(bitmap);
+    };
+    double monochromeMs = measureMs(5, renderMonochrome);
+    report("color/monochrome 3160x2580, 20000 edges", monochromeMs);
+
+    // Требование: цветная отрисовка не медленнее половины скорости монохромной. Каждый повтор даёт
+    // отношение времён соседних прогонов, монохромного и цветного, а проверяется медиана отношений:
+    // фоновая нагрузка сдвигает оба прогона пары одинаково, а редкие выбросы медиана отбрасывает
+    Framebuffer framebuffer(width, height);
+    auto renderColor = [&]() {
+        framebuffer.clear();
+        generator.renderColor(framebuffer);
+    };
+    const double kMinThroughput = 0.5;
+    const int kCheckRepetitions = 21;
+    const float strokeWidths[] = { 1.0f, 3.0f };
+    for (float strokeWidth : strokeWidths) {
+        generator.setStrokeWidth(strokeWidth);
+        double colorMs = measureMs(5, renderColor);
+        std::vector<double> ratios(kCheckRepetitions);
+        for (int i = 0; i < kCheckRepetitions; ++i) {
+            double monochrome = bestMs(1, renderMonochrome);
+            double color = bestMs(1, renderColor);
+            ratios[i] = monochrome / color;
+        }
+        std::nth_element(ratios.begin(), ratios.begin() + kCheckRepetitions / 2, ratios.end());
+        double throughput = ratios[kCheckRepetitions / 2];
+        char ratio[64];
+        std::snprintf(ratio, sizeof(ratio), "%.2fx monochrome throughput", throughput);
+        std::string name = "color/antialiased width " + std::to_string(static_cast<int>(strokeWidth)) + ", 20000 edges";
+        report(name, colorMs, ratio);
+        check(throughput >= kMinThroughput, name + ": below 0.5x monochrome throughput");
+    }
+}
+
+void benchmarkIncrementalUpdate() {
+    // Решётка 150 x 120 вершин с шагом 20 пикселей, рёбра к правому и нижнему соседу
+    const int columns = 150;
+    const int rows = 120;
+    const int step = 20;
+    const int width = columns * step + 40;
+    const int height = rows * step + 40;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            vertices.push_back({ 20 + column * step, 20 + row * step, std::to_string((row * columns + column) % 100) });
+        }
+    }
+    generateGridGraph(columns, rows, edges);
+    BMPGenerator generator(width, height, vertices, edges);
+
+    double fullMs = measureMs(3, [&]() {
+        generator.updateImage(BMPFormat::Palette1);
+        generator.updateImage(BMPFormat::Rgb24);
+    }) / 2;
+    report("incremental/full build " + std::to_string(width) + "x" + std::to_string(height) + ", "
+        + std::to_string(edges.size()) + " edges", fullMs);
+
+    // Пакеты из 10 вставок диагоналей, 10 удалений и 2 сдвигов вершин на несколько пикселей
+    std::mt19937 random(17);
+    size_t redrawn = 0;
+    const int batches = 50;
+    double batchMs = measureMs(batches, [&]() {
+        for (int i = 0; i < 10; ++i) {
+            size_t v = random() % (vertices.size() - columns - 1);
+            generator.addEdge(v, v + columns + 1);
+            generator.removeEdge(random() % generator.edgeCount());
+        }
+        for (int i = 0; i < 2; ++i) {
+            size_t v = random() % vertices.size();
+            generator.moveVertex(v, vertices[v].x + static_cast<int>(random() % 11) - 5, vertices[v].y + static_cast<int>(random() % 11) - 5);
+        }
+        redrawn += generator.updateImage(BMPFormat::Rgb24);
+    });
+    size_t tiles = static_cast<size_t>((width + BMPGenerator::kDirtyTileSize - 1) / BMPGenerator::kDirtyTileSize)
+        * ((height + BMPGenerator::kDirtyTileSize - 1) / BMPGenerator::kDirtyTileSize);
+    report("incremental/update after 22 changes", batchMs,
+        std::to_string(redrawn / batches) + " of " + std::to_string(tiles) + " tiles redrawn");
+}
+
+void benchmarkEncoding() {
+    const int width = 3160;
+    const int height = 2580;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    makeRandomGraph(width, height, 500, 2000, 2, vertices, edges);
+    BMPGenerator generator(width, height, vertices, edges);
+    Bitmap bitmap(width, height);
+    generator.render(bitmap);
+
+    // Прежняя запись: три вызова put на каждый пиксель
+    double legacyMs = measureMs(3, [&]() {
+        CountingBuffer buffer;
+        std::ostream file(&buffer);
+        for (int y = height - 1; y >= 0; --y) {
+            for (int x = 0; x < width; ++x) {
+                bool pixel = bitmap.test(x, y);
+                file.put(pixel ? static_cast<char>(0) : static_cast<char>(255))
+                    .put(pixel ? static_cast<char>(0) : static_cast<char>(255))
+                    .put(pixel ? static_cast<char>(0) : static_cast<char>(255));
+            }
+        }
+    });
+    report("encode/put per pixel 3160x2580", legacyMs);
+
+    const BMPFormat formats[] = { BMPFormat::Rgb24, BMPFormat::Palette8, BMPFormat::Palette1 };
+    const char* names[] = { "rgb24", "palette8", "palette1" };
+    BMPEncoder encoder;
+    for (int i = 0; i < 3; ++i) {
+        encoder.setFormat(formats[i]);
+        size_t bytes = 0;
+        double ms = measureMs(10, [&]() {
+            CountingBuffer buffer;
+            std::ostream file(&buffer);
+            encoder.encode(file, bitmap);
+            bytes = buffer.bytes();
+        });
+        report(std::string("encode/BMPEncoder ") + names[i] + " 3160x2580", ms, std::to_string(bytes) + " bytes");
+    }
+
+    // Сжатые форматы для монохромной карты и цветного буфера того же графа: в одном потоке и на всех ядрах
+    Framebuffer framebuffer(width, height);
+    generator.renderColor(framebuffer);
+    ThreadPool pool;
+    const ImageFormat compressedFormats[] = { ImageFormat::BmpRle8, ImageFormat::Png };
+    const char* compressedNames[] = { "rle8", "png" };
+    for (int i = 0; i < 2; ++i) {
+        for (int threads = 0; threads < 2; ++threads) {
+            std::unique_ptr<ImageEncoder> encoder = createImageEncoder(compressedFormats[i], threads ? &pool : nullptr);
+            const std::string suffix = threads ? " pool" : " 1 thread";
+            const std::string label = threads ? std::to_string(pool.size()) + " threads, " : "";
+            size_t bytes = 0;
+            double ms = measureMs(3, [&]() {
+                CountingBuffer buffer;
+                std::ostream file(&buffer);
+                encoder->encode(file, bitmap);
+                bytes = buffer.bytes();
+            });
+            report(std::string("encode/") + compressedNames[i] + " 1-bit 3160x2580" + suffix, ms, label + std::to_string(bytes) + " bytes");
+            ms = measureMs(3, [&]() {
+                CountingBuffer buffer;
+                std::ostream file(&buffer);
+                encoder->encode(file, framebuffer);
+                bytes = buffer.bytes();
+            });
+            report(std::string("encode/") + compressedNames[i] + " colour 3160x2580" + suffix, ms, label + std::to_string(bytes) + " bytes");
+        }
+    }
+}
+
+void benchmarkStreaming() {
+    // Решётка 250 x 250 вершин с шагом 200 пикселей на холсте 50000 x 50000, рёбра к правому и нижнему соседу
+    const int side = 250;
+    const int step = 200;
+    const int size = side * step;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    for (int row = 0; row < side; ++row) {
+        for (int column = 0; column < side; ++column) {
+            vertices.push_back({ column * step + step / 2, row * step + step / 2, std::to_string(row * side + column) });
+        }
+    }
+    generateGridGraph(side, side, edges);
+    BMPGenerator generator(size, size, vertices, edges);
+    const int bandHeight = 256;
+    size_t bytes = 0;
+    double ms = measureMs(1, [&]() {
+        CountingBuffer buffer;
+        std::ostream file(&buffer);
+        generator.encodeStreaming(file, BMPFormat::Palette1, bandHeight);
+        bytes = buffer.bytes();
+    });
+    size_t bandBytes = static_cast<size_t>(bandHeight) * ((size + 63) / 64) * sizeof(uint64_t);
+    size_t fullBytes = static_cast<size_t>(size) * ((size + 63) / 64) * sizeof(uint64_t);
+    report("stream/50000x50000 1-bit, 124500 edges, 256-row bands", ms,
+        std::to_string(bytes) + " bytes written, band " + std::to_string(bandBytes) + " bytes vs full bitmap " + std::to_string(fullBytes) + " bytes");
+}
+
+void benchmarkParsing() {
+    const size_t numVertices = 1000000;
+    const size_t numEdges = 4000000;
+    const std::string filename = "benchmark_edges.tmp";
+
+    // Текстовый список рёбер в формате edge_data.txt
+    {
+        std::mt19937 random(3);
+        std::ofstream file(filename);
+        for (size_t i = 0; i < numEdges; ++i) {
+            file << random() % numVertices << ' ' << random() % numVertices << '\n';
+        }
+    }
+    std::ifstream sizeProbe(filename, std::ios::binary | std::ios::ate);
+    double megabytes = static_cast<double>(sizeProbe.tellg()) / (1024.0 * 1024.0);
+    sizeProbe.close();
+
+    std::vector<Edge> edges;
+    double streamMs = measureMs(1, [&]() {
+        edges.clear();
+        edges.shrink_to_fit();
+        readEdgesFromFile(filename, edges);
+    });
+    report("parse/readEdgesFromFile 4M edges", streamMs, std::to_string(megabytes / (streamMs / 1000.0)) + " MB/s");
+
+    double fastMs = measureMs(3, [&]() {
+        edges.clear();
+        edges.shrink_to_fit();
+        readEdgesFromFileFast(filename, edges, numVertices);
+    });
+    report("parse/readEdgesFromFileFast 4M edges", fastMs, std::to_string(megabytes / (fastMs / 1000.0)) + " MB/s");
+
+    // Тот же граф в двоичном формате: отображение без копирования, копирование в std::vector<Edge>
+    // и перенос пар номеров прямо в хранилище графа
+    const std::string binaryFilename = "benchmark_edges.bin";
+    writeBinaryGraph(binaryFilename, numVertices, 3160, 2580, edges);
+    size_t mappedEdges = 0;
+    double mapMs = measureMs(3, [&]() {
+        BinaryGraphFile graph;
+        graph.open(binaryFilename);
+        mappedEdges = graph.numEdges();
+    });
+    report("parse/BinaryGraphFile open 4M edges", mapMs, std::to_string(mappedEdges) + " edges mapped");
+    double binaryMs = measureMs(3, [&]() {
+        edges.clear();
+        edges.shrink_to_fit();
+        readEdgesFromBinaryFile(binaryFilename, edges, numVertices);
+    });
+    report("parse/readEdgesFromBinaryFile 4M edges", binaryMs);
+    double storageMs = measureMs(3, [&]() {
+        GraphStorage graph;
+        readEdgesFromBinaryFile(binaryFilename, graph, numVertices);
+    });
+    report("parse/readEdgesFromBinaryFile into GraphStorage 4M edges", storageMs);
+
+    std::remove(filename.c_str());
+    std::remove(binaryFilename.c_str());
+}
+
+void benchmarkLayout() {
+    // Бюджет итераций по умолчанию, зависящий от числа вершин; время итерации растёт как V log V
+    const size_t sizes[] = { 500, 10000, 100000 };
+    for (size_t size : sizes) {
+        std::vector<Vertex> vertices;
+        std::vector<Edge> edges;
+        makeRandomGraph(3160, 2580, size, size, 4, vertices, edges, false);
+        ForceLayout layout;
+        double ms = measureMs(1, [&]() {
+            layout.run(vertices, edges, 3160, 2580);
+        });
+        const int iterations = ForceLayout::defaultIterations(size);
+        char extra[64];
+        std::snprintf(extra, sizeof(extra), "%d iterations, %.1f ms per iteration", iterations, ms / iterations);
+        report("layout/ForceLayout " + std::to_string(size) + " vertices", ms, extra);
+    }
+
+    // Качество укладки: с полным бюджетом итераций пересечений не больше, чем после kMinIterations,
+    // и вершины не собираются на рамке холста (раньше позиции прижимались к ней на каждом шаге)
+    const size_t kQualityVertices = 500;
+    const int kMargin = ForceLayoutSettings().margin;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    makeRandomGraph(3160, 2580, kQualityVertices, kQualityVertices, 4, vertices, edges, false);
+    ThreadPool pool;
+    uint64_t crossings[2] = { 0, 0 };
+    size_t border = 0;
+    double ms = 0;
+    const int budgets[2] = { ForceLayout::kMinIterations, ForceLayout::defaultIterations(kQualityVertices) };
+    for (int i = 0; i < 2; ++i) {
+        ForceLayoutSettings settings;
+        settings.iterations = budgets[i];
+        ms = measureMs(1, [&]() { ForceLayout(settings).run(vertices, edges, 3160, 2580); });
+        crossings[i] = countEdgeCrossings(GraphStorage(vertices, edges), pool);
+        border = 0;
+        for (const Vertex& vertex : vertices) {
+            if (vertex.x <= kMargin || vertex.x >= 3160 - kMargin || vertex.y <= kMargin || vertex.y >= 2580 - kMargin) {
+                ++border;
+            }
+        }
+    }
+    char extra[96];
+    std::snprintf(extra, sizeof(extra), "%llu crossings after %d iterations, %llu after %d, %llu on the border",
+        static_cast<unsigned long long>(crossings[0]), budgets[0], static_cast<unsigned long long>(crossings[1]), budgets[1],
+        static_cast<unsigned long long>(border));
+    const std::string name = "layout/quality " + std::to_string(kQualityVertices) + " vertices";
+    report(name, ms, extra);
+    check(crossings[1] <= crossings[0], name + ": more iterations add crossings");
+    check(border * 20 <= kQualityVertices, name + ": over 5% of vertices on the canvas border");
+}
+
+void benchmarkLabelPlacement() {
+    // Решётка с шагом 40 пикселей, где длинные метки не помещаются на прежнее место, и случайный граф
+    // с длинными рёбрами той же плотности вершин. Рёбер в ячейке не больше постоянного числа, и проверка
+    // кандидата не зависит от размера графа; растёт только проход рёбер по ячейкам при построении сетки:
+    // длина случайного ребра в ячейках растёт как корень из числа вершин (в 3.16 раза на порядок)
+    const size_t sizes[] = { 1000, 10000, 100000 };
+    const double kMaxPerLabelGrowth = 3;
+    double previousPerLabelUs = 0;
+    for (size_t size : sizes) {
+        const size_t side = static_cast<size_t>(std::sqrt(static_cast<double>(size)) + 0.5);
+        const int spacing = 40;
+        const int canvas = static_cast<int>(side) * spacing + spacing;
+        std::vector<Vertex> vertices;
+        std::vector<Edge> edges;
+        for (size_t i = 0; i < side * side; ++i) {
+            vertices.push_back({ spacing + static_cast<int>(i % side) * spacing, spacing + static_cast<int>(i / side) * spacing, std::to_string(i) });
+        }
+        generateGridGraph(side, side, edges);
+        LabelPlacer placer(canvas, canvas);
+        std::vector<LabelOffset> offsets;
+        size_t visible = 0;
+        GraphStorage graph(vertices, edges);
+        double ms = measureMs(1, [&]() { visible = placer.place(graph, offsets); });
+        report("labels/place/grid/" + std::to_string(vertices.size()), ms,
+            std::to_string(visible) + " visible", static_cast<double>(vertices.size()));
+
+        makeRandomGraph(canvas, canvas, vertices.size(), vertices.size(), 27, vertices, edges);
+        graph = GraphStorage(vertices, edges);
+        ms = bestMs(3, [&]() { visible = placer.place(graph, offsets); });
+        const double perLabelUs = ms * 1000.0 / static_cast<double>(vertices.size());
+        char perLabel[64];
+        std::snprintf(perLabel, sizeof(perLabel), ", %.2f us per label", perLabelUs);
+        const std::string name = "labels/place/random/" + std::to_string(vertices.size());
+        report(name, ms, std::to_string(visible) + " visible" + perLabel, static_cast<double>(vertices.size()));
+        if (previousPerLabelUs > 0) {
+            check(perLabelUs <= previousPerLabelUs * kMaxPerLabelGrowth, name + ": time per label grows faster than the graph");
+        }
+        previousPerLabelUs = perLabelUs;
+    }
+}
+
+// Прежние вложенные циклы по наборам вершин (в смысле клики K5 и полного двудольного K3,3)
+bool naiveContainsK5(const GraphIndex& index) {
+    size_t n = index.numVertices();
+    for (size_t v1 = 0; v1 < n; ++v1) {
+        for (size_t v2 = v1 + 1; v2 < n; ++v2) {
+            for (size_t v3 = v2 + 1; v3 < n; ++v3) {
+                for (size_t v4 = v3 + 1; v4 < n; ++v4) {
+                    for (size_t v5 = v4 + 1; v5 < n; ++v5) {
+                        if (index.hasEdge(v1, v2) && index.hasEdge(v1, v3) && index.hasEdge(v1, v4) && index.hasEdge(v1, v5) &&
+                            index.hasEdge(v2, v3) && index.hasEdge(v2, v4) && index.hasEdge(v2, v5) &&
+                            index.hasEdge(v3, v4) && index.hasEdge(v3, v5) && index.hasEdge(v4, v5)) {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool naiveContainsK33(const GraphIndex& index) {
+    size_t n = index.numVertices();
+    for (size_t v1 = 0; v1 < n; ++v1) {
+        for (size_t v2 = v1 + 1; v2 < n; ++v2) {
+            for (size_t v3 = v2 + 1; v3 < n; ++v3) {
+                for (size_t v4 = 0; v4 < n; ++v4) {
+                    if (v4 == v1 || v4 == v2 || v4 == v3 || !index.hasEdge(v1, v4) || !index.hasEdge(v2, v4) || !index.hasEdge(v3, v4))
+                        continue;
+                    for (size_t v5 = v4 + 1; v5 < n; ++v5) {
+                        if (v5 == v1 || v5 == v2 || v5 == v3 || !index.hasEdge(v1, v5) || !index.hasEdge(v2, v5) || !index.hasEdge(v3, v5))
+                            continue;
+                        for (size_t v6 = v5 + 1; v6 < n; ++v6) {
+                            if (v6 != v1 && v6 != v2 && v6 != v3 && index.hasEdge(v1, v6) && index.hasEdge(v2, v6) && index.hasEdge(v3, v6)) {
+                                return true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void benchmarkKuratowskiSearch() {
+    ThreadPool pool;
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+
+    // Небольшой граф без K5 и K3,3, на котором прежний перебор ещё завершается
+    makeRandomGraph(1000, 1000, 80, 240, 7, vertices, edges, false);
+    GraphIndex small(vertices.size(), edges);
+    bool found = false;
+    double naiveK5Ms = measureMs(1, [&]() { found = naiveContainsK5(small); });
+    report("kuratowski/nested loops K5, 80 vertices", naiveK5Ms, found ? "found" : "not found");
+    double naiveK33Ms = measureMs(1, [&]() { found = naiveContainsK33(small); });
+    report("kuratowski/nested loops K3,3, 80 vertices", naiveK33Ms, found ? "found" : "not found");
+    double k5Ms = measureMs(10, [&]() { found = !findK5Clique(small, pool).empty(); });
+    report("kuratowski/findK5Clique, 80 vertices", k5Ms, found ? "found" : "not found");
+    double k33Ms = measureMs(10, [&]() { found = !findK33Biclique(small, pool).empty(); });
+    report("kuratowski/findK33Biclique, 80 vertices", k33Ms, found ? "found" : "not found");
+
+    // Большой разреженный граф: полный перебор ветвей без находки и с K5 + K3,3, вставленными в конец порядка
+    makeRandomGraph(1000, 1000, 20000, 100000, 8, vertices, edges, false);
+    GraphIndex large(vertices.size(), edges);
+    k5Ms = measureMs(3, [&]() { found = !findK5Clique(large, pool).empty(); });
+    report("kuratowski/findK5Clique, 20000 vertices", k5Ms, (found ? "found, " : "not found, ") + std::to_string(pool.size()) + " threads");
+    k33Ms = measureMs(3, [&]() { found = !findK33Biclique(large, pool).empty(); });
+    report("kuratowski/findK33Biclique, 20000 vertices", k33Ms, (found ? "found, " : "not found, ") + std::to_string(pool.size()) + " threads");
+
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = i + 1; j < 5; ++j) {
+            edges.push_back({ 100 + i, 100 + j });
+        }
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            edges.push_back({ 200 + i, 300 + j });
+        }
+    }
+    GraphIndex planted(vertices.size(), edges);
+    k5Ms = measureMs(3, [&]() { found = !findK5Clique(planted, pool).empty(); });
+    report("kuratowski/findK5Clique, 20000 vertices, planted K5", k5Ms, found ? "found" : "not found");
+    k33Ms = measureMs(3, [&]() { found = !findK33Biclique(planted, pool).empty(); });
+    report("kuratowski/findK33Biclique, 20000 vertices, planted K3,3", k33Ms, found ? "found" : "not found");
+}
+
+// Семейства графов масштабируемых замеров; размер задаётся числом рёбер
+enum class GraphFamily {
+    Random,
+    Grid,
+    Triangulation,
+    PlantedK5,
+    PlantedK33,
+    PowerLaw
+};
+
+const char* familyName(GraphFamily family) {
+    switch (family) {
+    case GraphFamily::Random:
+        return "random";
+    case GraphFamily::Grid:
+        return "grid";
+    case GraphFamily::Triangulation:
+        return "triangulation";
+    case GraphFamily::PlantedK5:
+        return "triangulation+K5";
+    case GraphFamily::PlantedK33:
+        return "triangulation+K3,3";
+    case GraphFamily::PowerLaw:
+        return "power-law";
+    }
+    return "";
+}
+
+// Граф семейства примерно с targetEdges рёбрами; возвращает число вершин
+size_t generateFamily(GraphFamily family, size_t targetEdges, std::vector<Edge>& edges) {
+    edges.clear();
+    size_t numVertices = 0;
+    switch (family) {
+    case GraphFamily::Random:
+        numVertices = std::max<size_t>(targetEdges / 4, 2); // Средняя степень 8: граф заведомо непланарен
+        generateRandomGraph(numVertices, targetEdges, 21, edges);
+        break;
+    case GraphFamily::Grid: {
+        size_t side = std::max<size_t>(static_cast<size_t>(std::sqrt(targetEdges / 2.0) + 0.5), 2);
+        numVertices = side * side;
+        generateGridGraph(side, side, edges);
+        break;
+    }
+    case GraphFamily::Triangulation:
+    case GraphFamily::PlantedK5:
+    case GraphFamily::PlantedK33:
+        numVertices = targetEdges / 3 + 2;
+        generateTriangulation(numVertices, 22, edges);
+        if (family == GraphFamily::PlantedK5) {
+            plantK5(numVertices, 23, edges);
+        }
+        else if (family == GraphFamily::PlantedK33) {
+            plantK33(numVertices, 24, edges);
+        }
+        break;
+    case GraphFamily::PowerLaw:
+        numVertices = targetEdges / 4 + 1;
+        generatePowerLawGraph(numVertices, 4, 25, edges);
+        break;
+    }
+    return numVertices;
+}
+
+// Размеры масштабируемых замеров: 1e2, 1e3, ... рёбер до g_maxEdges
+std::vector<size_t> scalingSizes() {
+    std::vector<size_t> sizes;
+    for (size_t size = 100; size <= g_maxEdges; size *= 10) {
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+std::string scalingName(const std::string& group, GraphFamily family, size_t size) {
+    return group + "/" + familyName(family) + "/" + std::to_string(size);
+}
+
+void benchmarkGenerators() {
+    const GraphFamily families[] = { GraphFamily::Random, GraphFamily::Grid, GraphFamily::Triangulation, GraphFamily::PowerLaw };
+    std::vector<Edge> edges;
+    for (GraphFamily family : families) {
+        for (size_t size : scalingSizes()) {
+            double ms = measureMs(1, [&]() { generateFamily(family, size, edges); });
+            report(scalingName("generate", family, size), ms, "", static_cast<double>(edges.size()));
+        }
+    }
+}
+
+void benchmarkEdgeLookup() {
+    // Половина запросов — существующие рёбра, половина — случайные пары вершин
+    const size_t queries = 1000000;
+    const GraphFamily families[] = { GraphFamily::Random, GraphFamily::Grid, GraphFamily::Triangulation, GraphFamily::PowerLaw };
+    std::vector<Edge> edges;
+    for (GraphFamily family : families) {
+        for (size_t size : scalingSizes()) {
+            size_t numVertices = generateFamily(family, size, edges);
+            GraphIndex index;
+            double buildMs = measureMs(1, [&]() { index.build(numVertices, edges); });
+            report(scalingName("lookup/build", family, size), buildMs, "", static_cast<double>(edges.size()));
+
+            std::mt19937 random(26);
+            std::vector<std::pair<size_t, size_t>> pairs(queries);
+            for (size_t i = 0; i < queries; ++i) {
+                if (i % 2 == 0) {
+                    const Edge& edge = edges[random() % edges.size()];
+                    pairs[i] = std::make_pair(edge.vertex1, edge.vertex2);
+                }
+                else {
+                    pairs[i] = std::make_pair(random() % numVertices, random() % numVertices);
+                }
+            }
+            size_t hits = 0;
+            double ms = measureMs(1, [&]() {
+                for (const auto& pair : pairs) {
+                    hits += index.hasEdge(pair.first, pair.second);
+                }
+            });
+            report(scalingName("lookup/hasEdge", family, size), ms,
+                std::to_string(hits) + " hits" + (numVertices <= GraphIndex::kDenseMatrixLimit ? ", bit matrix" : ", binary search"),
+                static_cast<double>(queries));
+        }
+    }
+}
+
+void benchmarkPlanarity() {
+    const GraphFamily families[] = { GraphFamily::Triangulation, GraphFamily::Grid, GraphFamily::PlantedK5, GraphFamily::PlantedK33, GraphFamily::Random };
+    const char* witnessNames[] = { "no witness", "K5 witness", "K3,3 witness" };
+    ThreadPool pool;
+    std::vector<Edge> edges;
+    for (GraphFamily family : families) {
+        for (size_t size : scalingSizes()) {
+            size_t numVertices = generateFamily(family, size, edges);
+            GraphIndex index(numVertices, edges);
+            PlanarityResult result;
+            double ms = measureMs(1, [&]() { result = testPlanarity(index, true); });
+            report(scalingName("planarity/testPlanarity", family, size), ms,
+                std::string(result.planar ? "planar" : "not planar, ") + (result.planar ? "" : witnessNames[static_cast<int>(result.kuratowski.type)]),
+                static_cast<double>(edges.size()));
+
+            // Только ответ да/нет: плотные непланарные графы отсекаются оценками Эйлера без полного теста
+            bool planar = false;
+            double decisionMs = measureMs(1, [&]() { planar = isPlanar(index); });
+            report(scalingName("planarity/isPlanar", family, size), decisionMs, planar ? "planar" : "not planar",
+                static_cast<double>(edges.size()));
+
+            // Прямой поиск клики и двудольного подграфа на графах с вставленным K5 или K3,3
+            if (family == GraphFamily::PlantedK5) {
+                bool found = false;
+                double searchMs = measureMs(1, [&]() { found = !findK5Clique(index, pool).empty(); });
+                report(scalingName("planarity/findK5Clique", family, size), searchMs, found ? "found" : "not found", static_cast<double>(edges.size()));
+            }
+            else if (family == GraphFamily::PlantedK33) {
+                bool found = false;
+                double searchMs = measureMs(1, [&]() { found = !findK33Biclique(index, pool).empty(); });
+                report(scalingName("planarity/findK33Biclique", family, size), searchMs, found ? "found" : "not found", static_cast<double>(edges.size()));
+            }
+        }
+    }
+}
+
+void benchmarkPlanarLayout() {
+    // Укладка без пересечений по готовой планарной укладке; время проверки планарности не входит
+    const GraphFamily families[] = { GraphFamily::Triangulation, GraphFamily::Grid };
+    std::vector<Edge> edges;
+    for (GraphFamily family : families) {
+        for (size_t size : scalingSizes()) {
+            size_t numVertices = generateFamily(family, size, edges);
+            PlanarityResult planarity = testPlanarity(numVertices, edges, false);
+            std::vector<Vertex> vertices(numVertices);
+            PlanarLayout layout;
+            double ms = measureMs(1, [&]() { layout.run(vertices, planarity.embedding, 3160, 2580); });
+            report(scalingName("layout/PlanarLayout", family, size), ms, "", static_cast<double>(numVertices));
+        }
+    }
+}
+
+// Прежний способ: все пары рёбер, O(E^2)
+uint64_t naiveCountCrossings(const std::vector<Vertex>& vertices, const std::vector<Edge>& edges) {
+    auto orientation = [](const Vertex& a, const Vertex& b, const Vertex& c) {
+        int64_t cross = static_cast<int64_t>(b.x - a.x) * (c.y - a.y) - static_cast<int64_t>(b.y - a.y) * (c.x - a.x);
+        return (cross > 0) - (cross < 0);
+    };
+    auto within = [](const Vertex& a, const Vertex& b, const Vertex& c) {
+        return std::min(a.x, b.x) <= c.x && c.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= c.y && c.y <= std::max(a.y, b.y);
+    };
+    uint64_t count = 0;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const Edge& e = edges[i];
+        const Vertex& a = vertices[e.vertex1];
+        const Vertex& b = vertices[e.vertex2];
+        if (e.vertex1 == e.vertex2 || (a.x == b.x && a.y == b.y)) {
+            continue;
+        }
+        for (size_t j = i + 1; j < edges.size(); ++j) {
+            const Edge& f = edges[j];
+            const Vertex& c = vertices[f.vertex1];
+            const Vertex& d = vertices[f.vertex2];
+            if (f.vertex1 == f.vertex2 || (c.x == d.x && c.y == d.y) || e.vertex1 == f.vertex1 || e.vertex1 == f.vertex2 ||
+                e.vertex2 == f.vertex1 || e.vertex2 == f.vertex2) {
+                continue;
+            }
+            int o1 = orientation(a, b, c), o2 = orientation(a, b, d), o3 = orientation(c, d, a), o4 = orientation(c, d, b);
+            if ((o1 * o2 < 0 && o3 * o4 < 0) || (o1 == 0 && within(a, b, c)) || (o2 == 0 && within(a, b, d)) ||
+                (o3 == 0 && within(c, d, a)) || (o4 == 0 && within(c, d, b))) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+void benchmarkCrossings() {
+    ThreadPool pool;
+    // Случайный граф с длинными рёбрами: пересечений порядка E^2, пар в общих ячейках сетки — почти
+    // все пары, и подсчёт должен перейти на перебор всех пар, не уступая прежнему способу
+    const size_t randomSizes[] = { 1000, 4000 };
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    for (size_t size : randomSizes) {
+        makeRandomGraph(3160, 2580, size, size, 31, vertices, edges, false);
+        uint64_t crossings = 0, naiveCrossings = 0;
+        GraphStorage graph(vertices, edges);
+        double ms = bestMs(3, [&]() { crossings = countEdgeCrossings(graph, pool); });
+        report("crossings/count/random/" + std::to_string(size), ms, std::to_string(crossings) + " crossings", static_cast<double>(size));
+        double naiveMs = bestMs(3, [&]() { naiveCrossings = naiveCountCrossings(vertices, edges); });
+        report("crossings/naive/random/" + std::to_string(size), naiveMs, std::to_string(naiveCrossings) + " crossings", static_cast<double>(size));
+        check(crossings == naiveCrossings, "crossings/count/random/" + std::to_string(size) + ": differs from the naive count");
+        check(ms <= naiveMs * 1.25, "crossings/count/random/" + std::to_string(size) + ": slower than the naive loop");
+    }
+    // Оценка по выборке пар с бюджетом main: время не зависит от размера графа сверх бюджета,
+    // ошибка сравнивается с точным числом на 16000 рёбрах
+    const size_t estimateSizes[] = { 16000, 1000000 };
+    for (size_t size : estimateSizes) {
+        if (size > g_maxEdges) {
+            continue;
+        }
+        makeRandomGraph(3160, 2580, size / 4, size, 31, vertices, edges, false);
+        GraphStorage graph(vertices, edges);
+        CrossingEstimate estimate = { 0, true, 0 };
+        double ms = measureMs(1, [&]() { estimate = estimateEdgeCrossings(graph, pool, BMPGenerator::kCrossingPairBudget); });
+        std::string extra = std::to_string(estimate.count) + (estimate.exact ? " crossings (exact)" : " crossings (estimated)");
+        if (size == estimateSizes[0]) {
+            uint64_t exact = countEdgeCrossings(graph, pool);
+            double error = exact > 0 ? std::fabs(static_cast<double>(estimate.count) - exact) / exact : 0;
+            char relative[64];
+            std::snprintf(relative, sizeof(relative), ", exact %llu, error %.3f%%", static_cast<unsigned long long>(exact), error * 100);
+            extra += relative;
+        }
+        report("crossings/estimate/random/" + std::to_string(size), ms, extra, static_cast<double>(size));
+    }
+    // Укладка без пересечений: время определяется числом рёбер
+    for (size_t size : scalingSizes()) {
+        size_t numVertices = generateFamily(GraphFamily::Triangulation, size, edges);
+        PlanarityResult planarity = testPlanarity(numVertices, edges, false);
+        vertices.assign(numVertices, Vertex());
+        bool fits = PlanarLayout().run(vertices, planarity.embedding, 3160, 2580);
+        uint64_t crossings = 0;
+        GraphStorage graph(vertices, edges);
+        double ms = measureMs(1, [&]() { crossings = countEdgeCrossings(graph, pool); });
+        std::string name = scalingName("crossings/grid", GraphFamily::Triangulation, size);
+        report(name, ms, std::to_string(crossings) + (fits ? " crossings" : " crossings, grid exceeds the canvas"),
+            static_cast<double>(edges.size()));
+        // Пересечения допустимы только при сжатой решётке, о чём укладка сообщает
+        check(!fits || crossings == 0, name + ": crossings in a grid layout that fits the canvas");
+    }
+}
+
+void benchmarkGraphStorage() {
+    // Память графа в векторах Vertex и Edge и в GraphStorage, время построения BMPGenerator копированием
+    // векторов и переносом в хранилище (индекс смежности строится в обоих случаях)
+    for (size_t size : scalingSizes()) {
+        std::vector<Edge> edges;
+        size_t numVertices = generateFamily(GraphFamily::Random, size, edges);
+        std::vector<Vertex> vertices;
+        placeVertices(numVertices, 3160, 2580, 5, vertices);
+        const size_t vectorBytes = vertices.size() * sizeof(Vertex) + edges.size() * sizeof(Edge);
+
+        double ms = measureMs(1, [&]() { BMPGenerator generator(3160, 2580, vertices, edges); });
+        report(scalingName("storage/copy", GraphFamily::Random, size), ms,
+            std::to_string(vectorBytes) + " bytes in vectors", static_cast<double>(edges.size()));
+
+        size_t storageBytes = 0;
+        ms = measureMs(1, [&]() {
+            BMPGenerator generator(3160, 2580, GraphStorage(std::move(vertices), std::move(edges)));
+            storageBytes = generator.graph().memoryBytes();
+        });
+        report(scalingName("storage/move", GraphFamily::Random, size), ms,
+            std::to_string(storageBytes) + " bytes in GraphStorage", static_cast<double>(size));
+    }
+}
+
+void benchmarkDensity() {
+    // Случайный граф на всём холсте: рёбра длиной в сотни пикселей, линии сливаются в сплошное пятно
+    ThreadPool pool;
+    for (size_t size : scalingSizes()) {
+        std::vector<Edge> edges;
+        size_t numVertices = generateFamily(GraphFamily::Random, size, edges);
+        std::vector<Vertex> vertices;
+        placeVertices(numVertices, 3160, 2580, 7, vertices, false);
+        GraphStorage graph(std::move(vertices), std::move(edges));
+
+        DensityMap density(3160, 2580);
+        GrayImage image;
+        double ms = measureMs(1, [&]() {
+            density.accumulate(graph, pool);
+            density.toGray(image);
+        });
+        report(scalingName("density/map", GraphFamily::Random, size), ms,
+            "cell " + std::to_string(density.cellSize()) + " px", static_cast<double>(size));
+
+        BMPGenerator generator(3160, 2580, std::move(graph));
+        Bitmap bitmap(3160, 2580);
+        ms = measureMs(1, [&]() { generator.renderTiled(bitmap, pool); });
+        report(scalingName("density/lines", GraphFamily::Random, size), ms, "", static_cast<double>(size));
+    }
+}
+
+} // namespace
+
+// GraphBenchmarks [--filter подстрока] [--max-edges N] [--json отчёт.json]
+// --filter оставляет группы, в имени которых есть подстрока (raster, color, incremental, encode, stream,
+// parse, layout, labels, crossings, storage, density, kuratowski, generate, lookup, planarity); --max-edges ограничивает масштабируемые замеры
+// (по умолчанию 1e6, до 1e7 при достаточной памяти); --json сохраняет результаты для сравнения запусков
+int main(int argc, char* argv[]) {
+    std::string filter, jsonFile;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if (argument == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        }
+        else if (argument == "--max-edges" && i + 1 < argc) {
+            g_maxEdges = static_cast<size_t>(std::strtod(argv[++i], nullptr));
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter name] [--max-edges N] [--json report.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    struct BenchmarkGroup {
+        const char* name;
+        void (*run)();
+    };
+    const BenchmarkGroup groups[] = {
+        { "raster", benchmarkRasterization },
+        { "raster", benchmarkVertexDrawing },
+        { "raster", benchmarkTiledRasterization },
+        { "color", benchmarkColorRendering },
+        { "incremental", benchmarkIncrementalUpdate },
+        { "encode", benchmarkEncoding },
+        { "stream", benchmarkStreaming },
+        { "parse", benchmarkParsing },
+        { "layout", benchmarkLayout },
+        { "layout", benchmarkPlanarLayout },
+        { "labels", benchmarkLabelPlacement },
+        { "crossings", benchmarkCrossings },
+        { "storage", benchmarkGraphStorage },
+        { "density", benchmarkDensity },
+        { "kuratowski", benchmarkKuratowskiSearch },
+        { "generate", benchmarkGenerators },
+        { "lookup", benchmarkEdgeLookup },
+        { "planarity", benchmarkPlanarity },
+    };
+    for (const BenchmarkGroup& group : groups) {
+        if (filter.empty() || std::string(group.name).find(filter) != std::string::npos) {
+            group.run();
+        }
+    }
+
+    if (!jsonFile.empty() && !writeJsonReport(jsonFile)) {
+        return 1;
+    }
+    return g_failedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "BinaryGraph.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "FileReader.h"
+
+namespace {
+
+const char kMagic[8] = { 'G', 'R', 'A', 'P', 'H', 'B', 'I', 'N' };
+
+} // namespace
+
+const uint32_t BinaryGraphFile::kVersion;
+
+BinaryGraphFile::BinaryGraphFile() : m_edges(nullptr) {
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+bool BinaryGraphFile::open(const std::string& filename) {
+    m_edges = nullptr;
+    std::memset(&m_header, 0, sizeof(m_header));
+    if (!m_file.open(filename)) {
+        return false;
+    }
+
+    // Проверка заголовка и того, что массив рёбер целиком помещается в файл
+    bool valid = m_file.size() >= sizeof(BinaryGraphHeader);
+    if (valid) {
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        valid = std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) == 0 && m_header.version == kVersion
+            && m_header.edgesOffset % alignof(EdgePair) == 0 && m_header.edgesOffset <= m_file.size()
+            && m_header.numEdges <= (m_file.size() - m_header.edgesOffset) / sizeof(EdgePair);
+    }
+    if (!valid) {
+        std::cerr << "Invalid binary graph file: " << filename << std::endl;
+        m_file.close();
+        std::memset(&m_header, 0, sizeof(m_header));
+        return false;
+    }
+
+    m_edges = reinterpret_cast<const EdgePair*>(m_file.data() + m_header.edgesOffset);
+    return true;
+}
+
+void BinaryGraphFile::appendEdges(std::vector<Edge>& edges) const {
+    edges.reserve(edges.size() + numEdges());
+    for (size_t i = 0; i < numEdges(); ++i) {
+        Edge edge;
+        edge.vertex1 = m_edges[i].vertex1;
+        edge.vertex2 = m_edges[i].vertex2;
+        edges.push_back(edge);
+    }
+}
+
+bool BinaryGraphFile::isBinaryGraphFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(kMagic)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool writeBinaryGraph(const std::string& filename, size_t numVertices, int width, int height, const std::vector<Edge>& edges) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+
+    BinaryGraphHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = BinaryGraphFile::kVersion;
+    header.numVertices = static_cast<uint32_t>(numVertices);
+    header.width = width;
+    header.height = height;
+    header.numEdges = edges.size();
+    header.edgesOffset = sizeof(BinaryGraphHeader);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Рёбра упаковываются в 32-битные пары и пишутся блоками
+    std::vector<EdgePair> block;
+    block.reserve(1 << 16);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        EdgePair pair;
+        pair.vertex1 = static_cast<uint32_t>(edges[i].vertex1);
+        pair.vertex2 = static_cast<uint32_t>(edges[i].vertex2);
+        block.push_back(pair);
+        if (block.size() == block.capacity() || i + 1 == edges.size()) {
+            file.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(EdgePair));
+            block.clear();
+        }
+    }
+    return file.good();
+}
+
+bool convertTextGraphToBinary(const std::string& headerFile, const std::string& edgeFile, const std::string& outputFile) {
+    int numVertices = 0, width = 0, height = 0;
+    readInputFromFile(headerFile, numVertices, width, height);
+    if (numVertices <= 0) {
+        return false;
+    }
+    std::vector<Edge> edges;
+    if (!readEdgesFromFileFast(edgeFile, edges, static_cast<size_t>(numVertices))) {
+        return false;
+    }
+    return writeBinaryGraph(outputFile, static_cast<size_t>(numVertices), width, height, edges);
+}
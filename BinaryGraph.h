@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Edge.h"
+#include "MappedFile.h"
+
+// Двоичный формат графа (версия 1, little-endian):
+//   заголовок BinaryGraphHeader (64 байта);
+//   numEdges пар номеров вершин uint32, начиная со смещения edgesOffset.
+// Заменяет пару текстовых файлов graphs_data.txt + список рёбер.
+struct BinaryGraphHeader {
+    char magic[8]; // "GRAPHBIN"
+    uint32_t version;
+    uint32_t numVertices;
+    int32_t width;
+    int32_t height;
+    uint64_t numEdges;
+    uint64_t edgesOffset; // Смещение массива рёбер от начала файла
+    uint8_t reserved[24];
+};
+
+// Ребро в двоичном файле: два 32-битных номера вершин
+struct EdgePair {
+    uint32_t vertex1;
+    uint32_t vertex2;
+};
+
+// Двоичный файл графа, отображённый в память. Рёбра доступны напрямую из отображения, без копирования.
+class BinaryGraphFile {
+public:
+    static const uint32_t kVersion = 1;
+
+    BinaryGraphFile();
+
+    // Открытие с проверкой сигнатуры, версии и размеров; при ошибке возвращает false
+    bool open(const std::string& filename);
+    bool isOpen() const { return m_file.isOpen(); }
+
+    size_t numVertices() const { return m_header.numVertices; }
+    int width() const { return m_header.width; }
+    int height() const { return m_header.height; }
+    size_t numEdges() const { return static_cast<size_t>(m_header.numEdges); }
+    const EdgePair* edges() const { return m_edges; }
+
+    // Копирование рёбер в обычный список (для кода, работающего с std::vector<Edge>)
+    void appendEdges(std::vector<Edge>& edges) const;
+
+    // Быстрая проверка сигнатуры в начале файла
+    static bool isBinaryGraphFile(const std::string& filename);
+
+private:
+    MappedFile m_file;
+    BinaryGraphHeader m_header;
+    const EdgePair* m_edges;
+};
+
+// Запись графа в двоичном формате
+bool writeBinaryGraph(const std::string& filename, size_t numVertices, int width, int height, const std::vector<Edge>& edges);
+
+// Однократное преобразование текстовой пары (заголовок + список рёбер) в двоичный файл
+bool convertTextGraphToBinary(const std::string& headerFile, const std::string& edgeFile, const std::string& outputFile);
@@ -0,0 +1,73 @@
+#include "Bitmap.h"
+
+#include <algorithm>
+
+Bitmap::Bitmap() : m_width(0), m_height(0), m_top(0), m_stride(0) {}
+
+Bitmap::Bitmap(int width, int height) : m_width(0), m_height(0), m_top(0), m_stride(0) {
+    reset(width, height);
+}
+
+void Bitmap::reset(int width, int height, int top) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_top = top;
+    m_stride = (static_cast<size_t>(m_width) + 63) / 64;
+    m_words.assign(m_stride * m_height, 0);
+}
+
+void Bitmap::clear() {
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+void Bitmap::fillSpan(int y, int x0, int x1) {
+    if (y < m_top || y >= m_top + m_height) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, m_width - 1);
+    if (x0 > x1) {
+        return;
+    }
+
+    uint64_t* words = row(y);
+    int firstWord = x0 >> 6;
+    int lastWord = x1 >> 6;
+    uint64_t firstMask = ~uint64_t(0) << (x0 & 63);
+    uint64_t lastMask = ~uint64_t(0) >> (63 - (x1 & 63));
+    if (firstWord == lastWord) {
+        words[firstWord] |= firstMask & lastMask;
+        return;
+    }
+    words[firstWord] |= firstMask;
+    for (int i = firstWord + 1; i < lastWord; ++i) {
+        words[i] = ~uint64_t(0);
+    }
+    words[lastWord] |= lastMask;
+}
+
+void Bitmap::clearSpan(int y, int x0, int x1) {
+    if (y < m_top || y >= m_top + m_height) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, m_width - 1);
+    if (x0 > x1) {
+        return;
+    }
+
+    uint64_t* words = row(y);
+    int firstWord = x0 >> 6;
+    int lastWord = x1 >> 6;
+    uint64_t firstMask = ~uint64_t(0) << (x0 & 63);
+    uint64_t lastMask = ~uint64_t(0) >> (63 - (x1 & 63));
+    if (firstWord == lastWord) {
+        words[firstWord] &= ~(firstMask & lastMask);
+        return;
+    }
+    words[firstWord] &= ~firstMask;
+    for (int i = firstWord + 1; i < lastWord; ++i) {
+        words[i] = 0;
+    }
+    words[lastWord] &= ~lastMask;
+}
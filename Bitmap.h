@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Прямоугольник отсечения [x0, x1) x [y0, y1) в координатах битовой карты
+struct ClipRect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+// Монохромная битовая карта: один бит на пиксель, строки выровнены по 64-битным словам
+// и лежат в одном непрерывном буфере. Бит x строки находится в слове x / 64, разряд x % 64.
+// Карта может хранить полосу строк [top, top + height) большего изображения; row, set, test
+// и fillSpan принимают абсолютные номера строк.
+class Bitmap {
+public:
+    Bitmap();
+    Bitmap(int width, int height);
+
+    // Изменение размера с очисткой всех пикселей; top — номер первой строки полосы
+    void reset(int width, int height, int top = 0);
+    void clear();
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int top() const { return m_top; }
+    size_t stride() const { return m_stride; } // Число слов в строке
+    size_t memoryBytes() const { return m_words.size() * sizeof(uint64_t); }
+
+    uint64_t* row(int y) { return m_words.data() + static_cast<std::ptrdiff_t>(y - m_top) * m_stride; }
+    const uint64_t* row(int y) const { return m_words.data() + static_cast<std::ptrdiff_t>(y - m_top) * m_stride; }
+
+    // Координаты должны лежать внутри карты
+    void set(int x, int y) { row(y)[x >> 6] |= uint64_t(1) << (x & 63); }
+    bool test(int x, int y) const { return (row(y)[x >> 6] >> (x & 63)) & 1; }
+
+    // Закрашивание отрезка строки y от x0 до x1 включительно (с отсечением по границам) пословно
+    void fillSpan(int y, int x0, int x1);
+    // Очистка отрезка строки y от x0 до x1 включительно (с отсечением по границам)
+    void clearSpan(int y, int x0, int x1);
+
+private:
+    int m_width;
+    int m_height;
+    int m_top;
+    size_t m_stride;
+    std::vector<uint64_t> m_words;
+};
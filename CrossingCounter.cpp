@@ -0,0 +1,377 @@
+#include "CrossingCounter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include "Profiler.h"
+#include "SpatialGrid.h"
+
+namespace {
+
+const int kTasksPerThread = 4; // Полос строк сетки (или частей перебора пар) на поток
+const int kMinCellSize = 4; // Более мелкие ячейки только умножают записи рёбер в сетке
+const uint64_t kSampleSeed = 20240611; // Фиксированное зерно выборки: оценка для одного графа не меняется
+
+// Отрезок ребра в координатах относительно левого верхнего угла рамки всех рёбер
+struct Segment {
+    int64_t x0, y0, x1, y1;
+    uint32_t v0, v1;
+};
+
+// Знак векторного произведения (b - a) x (c - a)
+int orientation(int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t cx, int64_t cy) {
+    int64_t cross = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    return (cross > 0) - (cross < 0);
+}
+
+bool lexLess(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    return ax < bx || (ax == bx && ay < by);
+}
+
+// Есть ли у отрезков общая точка — то же условие, что в commonPoint, без вычисления самой точки.
+// Если отрезки не на одной прямой, достаточно знаков: рамки нужны только для наложения, и случайные
+// пары (перебор, выборка) проверяются без ветвлений по рамкам
+bool intersects(const Segment& s, const Segment& t) {
+    const int o1 = orientation(s.x0, s.y0, s.x1, s.y1, t.x0, t.y0);
+    const int o2 = orientation(s.x0, s.y0, s.x1, s.y1, t.x1, t.y1);
+    const int o3 = orientation(t.x0, t.y0, t.x1, t.y1, s.x0, s.y0);
+    const int o4 = orientation(t.x0, t.y0, t.x1, t.y1, s.x1, s.y1);
+    if (o1 == 0 && o2 == 0) {
+        return std::max(s.x0, s.x1) >= std::min(t.x0, t.x1) && std::max(t.x0, t.x1) >= std::min(s.x0, s.x1) &&
+            std::max(s.y0, s.y1) >= std::min(t.y0, t.y1) && std::max(t.y0, t.y1) >= std::min(s.y0, s.y1);
+    }
+    return o1 * o2 <= 0 && o3 * o4 <= 0;
+}
+
+// Общая точка отрезков s и t (s — ребро с меньшим номером), по которой выбирается ячейка пары;
+// false, если общих точек нет. Точка зависит только от пары, а не от ячейки, где идёт проверка:
+// при касании это конец отрезка, при наложении — начало общей части, иначе точка пересечения прямых
+bool commonPoint(const Segment& s, const Segment& t, double& x, double& y) {
+    if (std::max(s.x0, s.x1) < std::min(t.x0, t.x1) || std::max(t.x0, t.x1) < std::min(s.x0, s.x1) ||
+        std::max(s.y0, s.y1) < std::min(t.y0, t.y1) || std::max(t.y0, t.y1) < std::min(s.y0, s.y1)) {
+        return false;
+    }
+    const int o1 = orientation(s.x0, s.y0, s.x1, s.y1, t.x0, t.y0);
+    const int o2 = orientation(s.x0, s.y0, s.x1, s.y1, t.x1, t.y1);
+    if (o1 == 0 && o2 == 0) {
+        // На одной прямой точки упорядочены лексикографически; рамки пересекаются, значит, и отрезки
+        int64_t sx = s.x0, sy = s.y0, tx = t.x0, ty = t.y0;
+        if (lexLess(s.x1, s.y1, sx, sy)) {
+            sx = s.x1;
+            sy = s.y1;
+        }
+        if (lexLess(t.x1, t.y1, tx, ty)) {
+            tx = t.x1;
+            ty = t.y1;
+        }
+        bool later = lexLess(sx, sy, tx, ty);
+        x = static_cast<double>(later ? tx : sx);
+        y = static_cast<double>(later ? ty : sy);
+        return true;
+    }
+    const int o3 = orientation(t.x0, t.y0, t.x1, t.y1, s.x0, s.y0);
+    const int o4 = orientation(t.x0, t.y0, t.x1, t.y1, s.x1, s.y1);
+    if (o1 * o2 > 0 || o3 * o4 > 0) {
+        return false;
+    }
+    // Касание концом даёт точную целочисленную точку
+    if (o1 == 0 || o2 == 0) {
+        x = static_cast<double>(o1 == 0 ? t.x0 : t.x1);
+        y = static_cast<double>(o1 == 0 ? t.y0 : t.y1);
+        return true;
+    }
+    if (o3 == 0 || o4 == 0) {
+        x = static_cast<double>(o3 == 0 ? s.x0 : s.x1);
+        y = static_cast<double>(o3 == 0 ? s.y0 : s.y1);
+        return true;
+    }
+    const double dx = static_cast<double>(s.x1 - s.x0), dy = static_cast<double>(s.y1 - s.y0);
+    const double ex = static_cast<double>(t.x1 - t.x0), ey = static_cast<double>(t.y1 - t.y0);
+    const double along = (static_cast<double>(t.x0 - s.x0) * ey - static_cast<double>(t.y0 - s.y0) * ex) / (dx * ey - dy * ex);
+    x = s.x0 + along * dx;
+    y = s.y0 + along * dy;
+    return true;
+}
+
+bool shareVertex(const Segment& s, const Segment& t) {
+    return s.v0 == t.v0 || s.v0 == t.v1 || s.v1 == t.v0 || s.v1 == t.v1;
+}
+
+// Пересечения, засчитанные одной полосой строк сетки (или одной частью перебора пар)
+struct BandResult {
+    uint64_t count;
+    uint64_t tested;
+    std::vector<std::pair<size_t, size_t>> pairs;
+    BandResult() : count(0), tested(0) {}
+};
+
+// Рёбра, участвующие в подсчёте, в координатах относительно рамки всех рёбер
+struct CrossingInput {
+    std::vector<uint32_t> valid; // Номера рёбер по возрастанию
+    std::vector<Segment> segments; // По номеру ребра
+    int width, height;
+
+    uint64_t allPairs() const { return static_cast<uint64_t>(valid.size()) * (valid.size() - 1) / 2; }
+};
+
+// false, если учитываемых рёбер меньше двух
+bool prepareInput(const GraphStorage& graph, CrossingInput& input) {
+    const size_t n = graph.vertexCount();
+    int64_t minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (size_t i = 0; i < graph.edgeCount(); ++i) {
+        const uint32_t a = graph.vertex1(i), b = graph.vertex2(i);
+        if (a >= n || b >= n || a == b) {
+            continue;
+        }
+        const int ax = graph.x(a), ay = graph.y(a), bx = graph.x(b), by = graph.y(b);
+        if (ax == bx && ay == by) {
+            continue;
+        }
+        if (input.valid.empty()) {
+            minX = maxX = ax;
+            minY = maxY = ay;
+        }
+        minX = std::min<int64_t>(minX, std::min(ax, bx));
+        maxX = std::max<int64_t>(maxX, std::max(ax, bx));
+        minY = std::min<int64_t>(minY, std::min(ay, by));
+        maxY = std::max<int64_t>(maxY, std::max(ay, by));
+        input.valid.push_back(static_cast<uint32_t>(i));
+    }
+    if (input.valid.size() < 2) {
+        return false;
+    }
+    input.width = static_cast<int>(maxX - minX + 1);
+    input.height = static_cast<int>(maxY - minY + 1);
+    input.segments.resize(graph.edgeCount());
+    for (uint32_t i : input.valid) {
+        const uint32_t a = graph.vertex1(i), b = graph.vertex2(i);
+        input.segments[i] = { graph.x(a) - minX, graph.y(a) - minY, graph.x(b) - minX, graph.y(b) - minY, a, b };
+    }
+    return true;
+}
+
+// Около одной ячейки на ребро: по средней длине ребра сетка выходит слишком крупной, когда
+// немногие длинные рёбра соседствуют с плотными скоплениями коротких (как в укладке PlanarLayout)
+int gridCellSize(const CrossingInput& input) {
+    const double area = static_cast<double>(input.width) * input.height;
+    double cellSize = std::max(std::sqrt(area / input.valid.size()), static_cast<double>(kMinCellSize));
+    return static_cast<int>(std::min(cellSize, static_cast<double>(std::max(input.width, input.height))));
+}
+
+// Оценка снизу числа записей рёбер в сетке: столбцы и строки ячеек, которые пересекает каждый отрезок
+uint64_t gridEntries(const CrossingInput& input, int cellSize) {
+    uint64_t entries = 0;
+    for (uint32_t i : input.valid) {
+        const Segment& s = input.segments[i];
+        entries += static_cast<uint64_t>(std::abs(s.x1 / cellSize - s.x0 / cellSize) + std::abs(s.y1 / cellSize - s.y0 / cellSize) + 1);
+    }
+    return entries;
+}
+
+// Пары внутри ячеек: столько проверок сделает подсчёт по сетке
+uint64_t candidatePairs(const SpatialGrid& grid) {
+    uint64_t pairs = 0;
+    const uint32_t cells = static_cast<uint32_t>(grid.rows()) * static_cast<uint32_t>(grid.columns());
+    for (uint32_t cell = 0; cell < cells; ++cell) {
+        const uint64_t size = grid.cell(cell).size();
+        if (size > 1) {
+            pairs += size * (size - 1) / 2;
+        }
+    }
+    return pairs;
+}
+
+// Проверка пар внутри ячеек сетки: пара засчитывается в ячейке своей общей точки
+void countInGrid(const CrossingInput& input, const SpatialGrid& grid, ThreadPool& pool, bool keepPairs, std::vector<BandResult>& bands) {
+    // Рёбра в ячейке идут по возрастанию номеров, поэтому пара (i, j) всегда проверяется как i < j
+    const size_t rows = static_cast<size_t>(grid.rows());
+    const size_t columns = static_cast<size_t>(grid.columns());
+    bands.resize(std::min(rows, pool.size() * kTasksPerThread));
+    pool.run(bands.size(), [&](size_t band) {
+        BandResult& result = bands[band];
+        uint64_t count = 0, tested = 0;
+        const size_t firstRow = rows * band / bands.size();
+        const size_t lastRow = rows * (band + 1) / bands.size();
+        for (size_t cell = firstRow * columns; cell < lastRow * columns; ++cell) {
+            const std::vector<uint32_t>& items = grid.cell(static_cast<uint32_t>(cell));
+            for (size_t p = 0; p < items.size(); ++p) {
+                const Segment& s = input.segments[items[p]];
+                for (size_t q = p + 1; q < items.size(); ++q) {
+                    const Segment& t = input.segments[items[q]];
+                    if (shareVertex(s, t)) {
+                        continue;
+                    }
+                    ++tested;
+                    double x, y;
+                    if (commonPoint(s, t, x, y) && grid.pointCell(x, y) == cell) {
+                        ++count;
+                        if (keepPairs) {
+                            result.pairs.emplace_back(items[p], items[q]);
+                        }
+                    }
+                }
+            }
+        }
+        result.count = count;
+        result.tested = tested;
+    });
+}
+
+// Перебор пар с пересекающимися проекциями на ось x: рёбра упорядочиваются по левому концу, и
+// пары ребра заканчиваются на первом ребре, которое начинается правее его правого конца. Первые
+// рёбра пар раздаются частям по кругу, чтобы части были примерно равны
+void countAllPairs(const CrossingInput& input, ThreadPool& pool, bool keepPairs, std::vector<BandResult>& bands) {
+    std::vector<uint32_t> order(input.valid);
+    std::vector<int64_t> lefts(order.size());
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const Segment& s = input.segments[a];
+        const Segment& t = input.segments[b];
+        return std::min(s.x0, s.x1) < std::min(t.x0, t.x1);
+    });
+    for (size_t p = 0; p < order.size(); ++p) {
+        const Segment& s = input.segments[order[p]];
+        lefts[p] = std::min(s.x0, s.x1);
+    }
+    bands.resize(std::min(order.size(), pool.size() * kTasksPerThread));
+    pool.run(bands.size(), [&](size_t part) {
+        BandResult& result = bands[part];
+        uint64_t count = 0, tested = 0;
+        for (size_t p = part; p < order.size(); p += bands.size()) {
+            const Segment& s = input.segments[order[p]];
+            const int64_t right = std::max(s.x0, s.x1);
+            for (size_t q = p + 1; q < order.size() && lefts[q] <= right; ++q) {
+                const Segment& t = input.segments[order[q]];
+                if (shareVertex(s, t)) {
+                    continue;
+                }
+                ++tested;
+                if (intersects(s, t)) {
+                    ++count;
+                    if (keepPairs) {
+                        result.pairs.emplace_back(std::min(order[p], order[q]), std::max(order[p], order[q]));
+                    }
+                }
+            }
+        }
+        result.count = count;
+        result.tested = tested;
+    });
+}
+
+// Точный подсчёт, если он требует не больше pairBudget проверок пар; иначе false. Сетка
+// выбирается, только пока пар внутри ячеек заметно меньше всех пар: у длинных рёбер, которые
+// лежат в сотнях ячеек, одна пара проверяется многократно, и перебор всех пар быстрее
+bool countExact(const CrossingInput& input, ThreadPool& pool, uint64_t pairBudget,
+    std::vector<std::pair<size_t, size_t>>* pairs, uint64_t& count) {
+    const uint64_t allPairs = input.allPairs();
+    std::vector<BandResult> bands;
+    bool counted = false;
+    const int cellSize = gridCellSize(input);
+    const uint64_t entries = gridEntries(input, cellSize);
+    // При равномерной загрузке в ячейках около entries^2 / (2 * cells) пар: сетку, которая заведомо
+    // не окупится, незачем и строить
+    const double cells = std::ceil(static_cast<double>(input.width) / cellSize) * std::ceil(static_cast<double>(input.height) / cellSize);
+    if (entries <= pairBudget && static_cast<double>(entries) * entries / (2 * cells) < allPairs / 2.0) {
+        SpatialGrid grid(input.width, input.height, cellSize);
+        for (uint32_t i : input.valid) {
+            const Segment& s = input.segments[i];
+            grid.insertSegment(i, static_cast<int>(s.x0), static_cast<int>(s.y0), static_cast<int>(s.x1), static_cast<int>(s.y1));
+        }
+        const uint64_t candidates = candidatePairs(grid);
+        if (candidates < allPairs / 2) {
+            if (candidates > pairBudget) {
+                return false;
+            }
+            countInGrid(input, grid, pool, pairs != nullptr, bands);
+            counted = true;
+        }
+    }
+    if (!counted) {
+        if (allPairs > pairBudget) {
+            return false;
+        }
+        countAllPairs(input, pool, pairs != nullptr, bands);
+    }
+
+    count = 0;
+    uint64_t tested = 0;
+    for (BandResult& result : bands) {
+        count += result.count;
+        tested += result.tested;
+        if (pairs) {
+            pairs->insert(pairs->end(), result.pairs.begin(), result.pairs.end());
+        }
+    }
+    if (pairs) {
+        std::sort(pairs->begin(), pairs->end());
+    }
+    GRAPH_PROFILE_COUNT("crossings.pairs.tested", tested);
+    GRAPH_PROFILE_COUNT("crossings.found", count);
+    return true;
+}
+
+// Число пересекающихся среди samples случайных пар различных рёбер
+uint64_t sampleCrossingPairs(const CrossingInput& input, ThreadPool& pool, uint64_t samples) {
+    const std::vector<uint32_t>& valid = input.valid;
+    std::vector<BandResult> parts(pool.size() * kTasksPerThread);
+    pool.run(parts.size(), [&](size_t part) {
+        // Оба номера пары берутся из одного 64-битного числа: половины, умноженные на число рёбер
+        // (смещение такого выбора — порядка E / 2^32, для оценки несущественно)
+        std::mt19937_64 random(kSampleSeed + part);
+        const uint64_t size = valid.size();
+        BandResult& result = parts[part];
+        const uint64_t partSamples = samples * (part + 1) / parts.size() - samples * part / parts.size();
+        for (uint64_t k = 0; k < partSamples;) {
+            const uint64_t bits = random();
+            const size_t p = static_cast<size_t>(((bits & 0xFFFFFFFFu) * size) >> 32);
+            const size_t q = static_cast<size_t>(((bits >> 32) * size) >> 32);
+            if (p == q) {
+                continue; // Пара из одного ребра не в счёт
+            }
+            ++k;
+            const Segment& s = input.segments[valid[p]];
+            const Segment& t = input.segments[valid[q]];
+            if (!shareVertex(s, t) && intersects(s, t)) {
+                ++result.count;
+            }
+        }
+    });
+    uint64_t hits = 0;
+    for (const BandResult& result : parts) {
+        hits += result.count;
+    }
+    GRAPH_PROFILE_COUNT("crossings.pairs.sampled", samples);
+    return hits;
+}
+
+} // namespace
+
+uint64_t countEdgeCrossings(const GraphStorage& graph, ThreadPool& pool, std::vector<std::pair<size_t, size_t>>* pairs) {
+    GRAPH_PROFILE_SCOPE("crossings.count");
+    if (pairs) {
+        pairs->clear();
+    }
+    CrossingInput input;
+    uint64_t count = 0;
+    if (prepareInput(graph, input)) {
+        countExact(input, pool, std::numeric_limits<uint64_t>::max(), pairs, count);
+    }
+    return count;
+}
+
+CrossingEstimate estimateEdgeCrossings(const GraphStorage& graph, ThreadPool& pool, uint64_t pairBudget, uint64_t samples) {
+    GRAPH_PROFILE_SCOPE("crossings.estimate");
+    CrossingEstimate estimate = { 0, true, 0 };
+    CrossingInput input;
+    if (!prepareInput(graph, input) || countExact(input, pool, pairBudget, nullptr, estimate.count)) {
+        return estimate;
+    }
+    // Доля пересекающихся пар в выборке переносится на все пары рёбер
+    estimate.exact = false;
+    estimate.sampled = std::max<uint64_t>(samples, 1);
+    const uint64_t hits = sampleCrossingPairs(input, pool, estimate.sampled);
+    estimate.count = static_cast<uint64_t>(static_cast<double>(hits) / estimate.sampled * input.allPairs() + 0.5);
+    return estimate;
+}
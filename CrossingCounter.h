@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "GraphStorage.h"
+#include "ThreadPool.h"
+
+// Подсчёт пересечений рёбер при текущих координатах вершин. Отрезки рёбер раскладываются
+// по равномерной сетке (SpatialGrid.h) примерно по ячейке на ребро, и точная
+// целочисленная проверка пересечения идёт только для пар внутри одной ячейки. Пара, которая
+// делит несколько ячеек, засчитывается в одной — той, где лежит точка пересечения, — поэтому
+// подсчёт не требует множества уже найденных пар. Строки ячеек делятся между потоками пула.
+// Время — O(E + P), где P — число пар рёбер с общей ячейкой; на раскладках без длинных рёбер
+// P порядка E + K (K — число пересечений). Если P не меньше половины всех пар (длинные рёбра
+// в сотнях ячеек), сетка медленнее перебора, и проверяются все пары с пересекающимися проекциями на x.
+//
+// Пересечением считается любая общая точка двух рёбер без общей вершины, включая касание
+// и наложение на одной прямой (наложение — одно пересечение). Рёбра с общей вершиной, петли,
+// рёбра нулевой длины и рёбра с неверными номерами вершин не учитываются.
+
+// Число пересечений; pairs (если задан) получает пары номеров пересекающихся рёбер (i < j)
+// в порядке возрастания
+uint64_t countEdgeCrossings(const GraphStorage& graph, ThreadPool& pool, std::vector<std::pair<size_t, size_t>>* pairs = nullptr);
+
+// Результат подсчёта с ограничением работы: точное число или оценка по случайным парам рёбер
+struct CrossingEstimate {
+    uint64_t count;
+    bool exact;
+    uint64_t sampled; // Проверенных случайных пар, если exact == false
+};
+
+// Точное число пересечений, если подсчёт требует не больше pairBudget проверок пар рёбер (и записей
+// рёбер в сетке); иначе оценка: доля пересекающихся среди samples случайных пар (зерно фиксировано),
+// умноженная на число всех пар. Относительная ошибка оценки — около 1/sqrt(h), где h — число
+// пересекающихся пар в выборке: для плотных силовых укладок (K порядка E^2) это десятые доли процента
+CrossingEstimate estimateEdgeCrossings(const GraphStorage& graph, ThreadPool& pool, uint64_t pairBudget, uint64_t samples = 1 << 20);
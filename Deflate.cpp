@@ -0,0 +1,508 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <cstring>
+#include "Profiler.h"
+
+const int Deflater::kMaxChain;
+const int Deflater::kNiceLength;
+const size_t Deflater::kBlockSymbols;
+
+namespace {
+
+const int kWindowSize = 1 << 15; // Наибольшее расстояние совпадения
+const int kHashBits = 15;
+const int kMinMatch = 3;
+const int kMaxMatch = 258;
+const int kLiteralCodes = 286; // Литералы, конец блока (256) и коды длин
+const int kDistanceCodes = 30;
+const int kCodeLengthCodes = 19;
+const int kEndOfBlock = 256;
+
+// Порядок передачи длин кодов для алфавита длин кодов
+const uint8_t kCodeLengthOrder[kCodeLengthCodes] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t kDistanceBase[kDistanceCodes] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t kDistanceExtra[kDistanceCodes] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Таблицы перевода длины и расстояния совпадения в номер кода, фиксированные коды Хаффмана
+// и таблица CRC-32
+struct DeflateTables {
+    uint8_t lengthCode[kMaxMatch + 1];
+    uint8_t distanceCode[512]; // Расстояние d: [d - 1] при d <= 256, иначе [256 + ((d - 1) >> 7)]
+    uint8_t fixedLiteralLengths[288];
+    uint8_t fixedDistanceLengths[kDistanceCodes];
+    uint32_t crc[256];
+
+    DeflateTables() {
+        for (int code = 0; code < 29; ++code) {
+            int last = code + 1 < 29 ? kLengthBase[code + 1] : kMaxMatch + 1;
+            for (int length = kLengthBase[code]; length < last; ++length) {
+                lengthCode[length] = static_cast<uint8_t>(code);
+            }
+        }
+        for (int code = 0; code < kDistanceCodes; ++code) {
+            int last = code + 1 < kDistanceCodes ? kDistanceBase[code + 1] : kWindowSize + 1;
+            for (int distance = kDistanceBase[code]; distance < last; ++distance) {
+                if (distance <= 256) {
+                    distanceCode[distance - 1] = static_cast<uint8_t>(code);
+                }
+                else {
+                    distanceCode[256 + ((distance - 1) >> 7)] = static_cast<uint8_t>(code);
+                }
+            }
+        }
+        for (int symbol = 0; symbol < 288; ++symbol) {
+            fixedLiteralLengths[symbol] = symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8;
+        }
+        std::fill(fixedDistanceLengths, fixedDistanceLengths + kDistanceCodes, 5);
+        for (uint32_t value = 0; value < 256; ++value) {
+            uint32_t c = value;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crc[value] = c;
+        }
+    }
+
+    int distanceOf(int distance) const {
+        return distance <= 256 ? distanceCode[distance - 1] : distanceCode[256 + ((distance - 1) >> 7)];
+    }
+};
+
+const DeflateTables& deflateTables() {
+    static const DeflateTables tables;
+    return tables;
+}
+
+uint32_t hashAt(const uint8_t* p) {
+    uint32_t value = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+    return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+// Число совпадающих байт a и b, не больше limit; сравнение идёт по 8 байт
+int matchLength(const uint8_t* a, const uint8_t* b, int limit) {
+    int length = 0;
+    while (length + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, a + length, 8);
+        std::memcpy(&y, b + length, 8);
+        if (x != y) {
+            break;
+        }
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) {
+        ++length;
+    }
+    return length;
+}
+
+// Длины кодов Хаффмана для частот frequencies, не длиннее maxBits. Если символов с ненулевой частотой
+// меньше двух, добавляются символы 0 и 1: код всегда полный, что требуют некоторые декодеры.
+// При превышении maxBits частоты делятся пополам, пока дерево не станет достаточно низким
+void buildLengths(const uint32_t* frequencies, int count, int maxBits, uint8_t* lengths) {
+    std::vector<uint32_t> weights(frequencies, frequencies + count);
+    int used = static_cast<int>(count - std::count(weights.begin(), weights.end(), 0u));
+    for (int symbol = 0; symbol < 2 && used < 2; ++symbol) {
+        if (weights[symbol] == 0) {
+            weights[symbol] = 1;
+            ++used;
+        }
+    }
+    std::vector<int> leaves;
+    for (int symbol = 0; symbol < count; ++symbol) {
+        if (weights[symbol] > 0) {
+            leaves.push_back(symbol);
+        }
+    }
+    const size_t n = leaves.size();
+    std::vector<uint64_t> nodeWeight(2 * n - 1);
+    std::vector<int> parent(2 * n - 1);
+    std::vector<int> depth(2 * n - 1);
+    while (true) {
+        std::stable_sort(leaves.begin(), leaves.end(), [&](int a, int b) { return weights[a] < weights[b]; });
+        for (size_t i = 0; i < n; ++i) {
+            nodeWeight[i] = weights[leaves[i]];
+        }
+        // Две очереди: отсортированные листья и внутренние узлы, которые создаются по неубыванию веса
+        size_t nextLeaf = 0, nextNode = n, endNode = n;
+        auto take = [&]() {
+            if (nextLeaf < n && (nextNode == endNode || nodeWeight[nextLeaf] <= nodeWeight[nextNode])) {
+                return nextLeaf++;
+            }
+            return nextNode++;
+        };
+        while (endNode < 2 * n - 1) {
+            size_t a = take();
+            size_t b = take();
+            nodeWeight[endNode] = nodeWeight[a] + nodeWeight[b];
+            parent[a] = parent[b] = static_cast<int>(endNode);
+            ++endNode;
+        }
+        // Родитель создан позже потомка, поэтому глубины считаются одним проходом от корня
+        int maxDepth = 0;
+        depth[2 * n - 2] = 0;
+        for (size_t i = 2 * n - 2; i-- > 0;) {
+            depth[i] = depth[parent[i]] + 1;
+            maxDepth = std::max(maxDepth, depth[i]);
+        }
+        if (maxDepth <= maxBits) {
+            break;
+        }
+        for (int symbol : leaves) {
+            weights[symbol] = (weights[symbol] + 1) / 2;
+        }
+    }
+    std::fill(lengths, lengths + count, 0);
+    for (size_t i = 0; i < n; ++i) {
+        lengths[leaves[i]] = static_cast<uint8_t>(depth[i]);
+    }
+}
+
+// Канонические коды по длинам; биты кода развёрнуты, потому что deflate передаёт коды
+// Хаффмана начиная со старшего бита, а биты пишутся начиная с младшего
+void buildCodes(const uint8_t* lengths, int count, uint16_t* codes) {
+    int lengthCount[16] = {};
+    for (int symbol = 0; symbol < count; ++symbol) {
+        ++lengthCount[lengths[symbol]];
+    }
+    lengthCount[0] = 0;
+    int nextCode[16] = {};
+    for (int bits = 1, code = 0; bits < 16; ++bits) {
+        code = (code + lengthCount[bits - 1]) << 1;
+        nextCode[bits] = code;
+    }
+    for (int symbol = 0; symbol < count; ++symbol) {
+        int length = lengths[symbol];
+        if (length == 0) {
+            codes[symbol] = 0;
+            continue;
+        }
+        int code = nextCode[length]++;
+        int reversed = 0;
+        for (int bit = 0; bit < length; ++bit) {
+            reversed = (reversed << 1) | ((code >> bit) & 1);
+        }
+        codes[symbol] = static_cast<uint16_t>(reversed);
+    }
+}
+
+// Последовательность длин кодов в алфавите длин кодов: 16 — повтор предыдущей длины 3–6 раз,
+// 17 и 18 — 3–10 и 11–138 нулей. Символ хранится в младшем байте, значение дополнительных бит — выше
+void encodeCodeLengths(const uint8_t* lengths, int count, std::vector<uint16_t>& symbols) {
+    for (int i = 0; i < count;) {
+        int length = lengths[i];
+        int run = 1;
+        while (i + run < count && lengths[i + run] == length) {
+            ++run;
+        }
+        i += run;
+        if (length == 0) {
+            while (run >= 11) {
+                int repeat = std::min(run, 138);
+                symbols.push_back(static_cast<uint16_t>(18 | ((repeat - 11) << 8)));
+                run -= repeat;
+            }
+            if (run >= 3) {
+                symbols.push_back(static_cast<uint16_t>(17 | ((run - 3) << 8)));
+                run = 0;
+            }
+        }
+        else {
+            symbols.push_back(static_cast<uint16_t>(length));
+            --run;
+            while (run >= 3) {
+                int repeat = std::min(run, 6);
+                symbols.push_back(static_cast<uint16_t>(16 | ((repeat - 3) << 8)));
+                run -= repeat;
+            }
+        }
+        for (; run > 0; --run) {
+            symbols.push_back(static_cast<uint16_t>(length));
+        }
+    }
+}
+
+} // namespace
+
+Deflater::Deflater() : m_head(size_t(1) << kHashBits), m_previous(kWindowSize), m_bitBuffer(0), m_bitCount(0) {}
+
+void Deflater::putBits(std::vector<uint8_t>& out, uint32_t value, int count) {
+    m_bitBuffer |= static_cast<uint64_t>(value) << m_bitCount;
+    m_bitCount += count;
+    if (m_bitCount >= 32) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<uint8_t>(m_bitBuffer >> (8 * i)));
+        }
+        m_bitBuffer >>= 32;
+        m_bitCount -= 32;
+    }
+}
+
+void Deflater::alignToByte(std::vector<uint8_t>& out) {
+    for (; m_bitCount > 0; m_bitCount -= 8) {
+        out.push_back(static_cast<uint8_t>(m_bitBuffer));
+        m_bitBuffer >>= 8;
+    }
+    m_bitBuffer = 0;
+    m_bitCount = 0;
+}
+
+int Deflater::findMatch(const uint8_t* data, size_t size, size_t position, int& distance) const {
+    if (position + kMinMatch > size) {
+        return 0;
+    }
+    const int limit = static_cast<int>(std::min<size_t>(kMaxMatch, size - position));
+    const uint8_t* current = data + position;
+    int best = kMinMatch - 1;
+    int32_t candidate = m_head[hashAt(current)];
+    // Позиции в цепочке строго убывают; текущая позиция в неё ещё не добавлена
+    for (int chain = kMaxChain; chain > 0 && candidate >= 0 && position - candidate <= static_cast<size_t>(kWindowSize); --chain) {
+        const uint8_t* match = data + candidate;
+        if (match[best] == current[best] && match[0] == current[0]) {
+            int length = matchLength(match, current, limit);
+            if (length > best) {
+                best = length;
+                distance = static_cast<int>(position - candidate);
+                if (length >= kNiceLength || length == limit) {
+                    break;
+                }
+            }
+        }
+        candidate = m_previous[candidate & (kWindowSize - 1)];
+    }
+    return best >= kMinMatch ? best : 0;
+}
+
+void Deflater::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    GRAPH_PROFILE_SCOPE("encode.deflate");
+    std::fill(m_head.begin(), m_head.end(), -1);
+    m_symbols.clear();
+    auto insert = [&](size_t position) {
+        if (position + kMinMatch <= size) {
+            uint32_t hash = hashAt(data + position);
+            m_previous[position & (kWindowSize - 1)] = m_head[hash];
+            m_head[hash] = static_cast<int32_t>(position);
+        }
+    };
+
+    // Ленивое сравнение: если со следующей позиции начинается более длинное совпадение,
+    // текущий байт уходит литералом, а найденное совпадение используется на следующем шаге
+    size_t blockStart = 0;
+    size_t position = 0;
+    int pendingLength = -1, pendingDistance = 0;
+    while (position < size) {
+        int distance = 0;
+        int length = pendingLength >= 0 ? pendingLength : findMatch(data, size, position, distance);
+        if (pendingLength >= 0) {
+            distance = pendingDistance;
+            pendingLength = -1;
+        }
+        insert(position);
+        if (length > 0 && length < kNiceLength) {
+            int nextDistance = 0;
+            int nextLength = findMatch(data, size, position + 1, nextDistance);
+            if (nextLength > length) {
+                pendingLength = nextLength;
+                pendingDistance = nextDistance;
+                length = 0;
+            }
+        }
+        if (length > 0) {
+            m_symbols.push_back(static_cast<uint32_t>(length) | (static_cast<uint32_t>(distance) << 16));
+            for (size_t i = position + 1; i < position + length; ++i) {
+                insert(i);
+            }
+            position += length;
+        }
+        else {
+            m_symbols.push_back(data[position]);
+            ++position;
+        }
+        if (m_symbols.size() >= kBlockSymbols) {
+            writeBlock(data + blockStart, position - blockStart, out);
+            blockStart = position;
+        }
+    }
+    if (!m_symbols.empty()) {
+        writeBlock(data + blockStart, position - blockStart, out);
+    }
+
+    // Пустой несжатый блок выравнивает поток до байта
+    putBits(out, 0, 3);
+    alignToByte(out);
+    const uint8_t emptyStored[4] = { 0x00, 0x00, 0xFF, 0xFF };
+    out.insert(out.end(), emptyStored, emptyStored + 4);
+    GRAPH_PROFILE_COUNT("deflate.bytes.in", size);
+}
+
+void Deflater::writeBlock(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    const DeflateTables& tables = deflateTables();
+    uint32_t literalFrequencies[kLiteralCodes] = {};
+    uint32_t distanceFrequencies[kDistanceCodes] = {};
+    uint64_t extraBits = 0;
+    for (uint32_t symbol : m_symbols) {
+        int distance = static_cast<int>(symbol >> 16);
+        if (distance == 0) {
+            ++literalFrequencies[symbol];
+            continue;
+        }
+        int lengthCode = tables.lengthCode[symbol & 0xFFFF];
+        int distanceCode = tables.distanceOf(distance);
+        ++literalFrequencies[257 + lengthCode];
+        ++distanceFrequencies[distanceCode];
+        extraBits += kLengthExtra[lengthCode] + kDistanceExtra[distanceCode];
+    }
+    literalFrequencies[kEndOfBlock] = 1;
+
+    uint8_t literalLengths[kLiteralCodes], distanceLengths[kDistanceCodes];
+    buildLengths(literalFrequencies, kLiteralCodes, 15, literalLengths);
+    buildLengths(distanceFrequencies, kDistanceCodes, 15, distanceLengths);
+    int literalCount = kLiteralCodes;
+    while (literalCount > 257 && literalLengths[literalCount - 1] == 0) {
+        --literalCount;
+    }
+    int distanceCount = kDistanceCodes;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+        --distanceCount;
+    }
+    uint8_t allLengths[kLiteralCodes + kDistanceCodes];
+    std::copy(literalLengths, literalLengths + literalCount, allLengths);
+    std::copy(distanceLengths, distanceLengths + distanceCount, allLengths + literalCount);
+    std::vector<uint16_t> lengthSymbols;
+    encodeCodeLengths(allLengths, literalCount + distanceCount, lengthSymbols);
+    uint32_t lengthFrequencies[kCodeLengthCodes] = {};
+    for (uint16_t symbol : lengthSymbols) {
+        ++lengthFrequencies[symbol & 0xFF];
+    }
+    uint8_t codeLengthLengths[kCodeLengthCodes];
+    buildLengths(lengthFrequencies, kCodeLengthCodes, 7, codeLengthLengths);
+    int codeLengthCount = kCodeLengthCodes;
+    while (codeLengthCount > 4 && codeLengthLengths[kCodeLengthOrder[codeLengthCount - 1]] == 0) {
+        --codeLengthCount;
+    }
+
+    // Размер блока в битах для каждого вида
+    uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * codeLengthCount + extraBits;
+    uint64_t fixedBits = 3 + extraBits;
+    for (int symbol = 0; symbol < kCodeLengthCodes; ++symbol) {
+        static const int repeatBits[3] = { 2, 3, 7 };
+        dynamicBits += static_cast<uint64_t>(lengthFrequencies[symbol]) * (codeLengthLengths[symbol] + (symbol >= 16 ? repeatBits[symbol - 16] : 0));
+    }
+    for (int symbol = 0; symbol < kLiteralCodes; ++symbol) {
+        dynamicBits += static_cast<uint64_t>(literalFrequencies[symbol]) * literalLengths[symbol];
+        fixedBits += static_cast<uint64_t>(literalFrequencies[symbol]) * tables.fixedLiteralLengths[symbol];
+    }
+    for (int symbol = 0; symbol < kDistanceCodes; ++symbol) {
+        dynamicBits += static_cast<uint64_t>(distanceFrequencies[symbol]) * distanceLengths[symbol];
+        fixedBits += static_cast<uint64_t>(distanceFrequencies[symbol]) * tables.fixedDistanceLengths[symbol];
+    }
+    const uint64_t storedBits = (size / 65535 + 1) * (3 + 7 + 32) + 8 * static_cast<uint64_t>(size);
+
+    if (storedBits < std::min(dynamicBits, fixedBits)) {
+        for (size_t offset = 0; offset < size; offset += 65535) {
+            const uint32_t length = static_cast<uint32_t>(std::min<size_t>(size - offset, 65535));
+            putBits(out, 0, 3);
+            alignToByte(out);
+            const uint8_t lengths[4] = { static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+                static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8) };
+            out.insert(out.end(), lengths, lengths + 4);
+            out.insert(out.end(), data + offset, data + offset + length);
+        }
+        m_symbols.clear();
+        return;
+    }
+
+    uint16_t literalCodes[288], distanceCodes[kDistanceCodes];
+    const uint8_t* literalBits = literalLengths;
+    const uint8_t* distanceBits = distanceLengths;
+    if (fixedBits <= dynamicBits) {
+        putBits(out, 1 << 1, 3); // Не последний блок, фиксированные коды
+        literalBits = tables.fixedLiteralLengths;
+        distanceBits = tables.fixedDistanceLengths;
+        buildCodes(literalBits, 288, literalCodes);
+        buildCodes(distanceBits, kDistanceCodes, distanceCodes);
+    }
+    else {
+        putBits(out, 2 << 1, 3); // Не последний блок, динамические коды
+        putBits(out, literalCount - 257, 5);
+        putBits(out, distanceCount - 1, 5);
+        putBits(out, codeLengthCount - 4, 4);
+        for (int i = 0; i < codeLengthCount; ++i) {
+            putBits(out, codeLengthLengths[kCodeLengthOrder[i]], 3);
+        }
+        uint16_t lengthCodes[kCodeLengthCodes];
+        buildCodes(codeLengthLengths, kCodeLengthCodes, lengthCodes);
+        for (uint16_t symbol : lengthSymbols) {
+            int code = symbol & 0xFF;
+            putBits(out, lengthCodes[code], codeLengthLengths[code]);
+            if (code >= 16) {
+                putBits(out, symbol >> 8, code == 16 ? 2 : code == 17 ? 3 : 7);
+            }
+        }
+        buildCodes(literalBits, kLiteralCodes, literalCodes);
+        buildCodes(distanceBits, kDistanceCodes, distanceCodes);
+    }
+
+    for (uint32_t symbol : m_symbols) {
+        int distance = static_cast<int>(symbol >> 16);
+        if (distance == 0) {
+            putBits(out, literalCodes[symbol], literalBits[symbol]);
+            continue;
+        }
+        int length = static_cast<int>(symbol & 0xFFFF);
+        int lengthCode = tables.lengthCode[length];
+        putBits(out, literalCodes[257 + lengthCode], literalBits[257 + lengthCode]);
+        putBits(out, length - kLengthBase[lengthCode], kLengthExtra[lengthCode]);
+        int distanceCode = tables.distanceOf(distance);
+        putBits(out, distanceCodes[distanceCode], distanceBits[distanceCode]);
+        putBits(out, distance - kDistanceBase[distanceCode], kDistanceExtra[distanceCode]);
+    }
+    putBits(out, literalCodes[kEndOfBlock], literalBits[kEndOfBlock]);
+    m_symbols.clear();
+}
+
+void Deflater::finish(std::vector<uint8_t>& out) {
+    // Последний блок с фиксированными кодами, в котором только код конца блока (семь нулевых бит)
+    out.push_back(0x03);
+    out.push_back(0x00);
+}
+
+uint32_t adler32(uint32_t adler, const uint8_t* data, size_t size) {
+    const uint32_t modulus = 65521;
+    const size_t chunk = 5552; // Наибольшая длина, при которой суммы не переполняют 32 бита
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while (size > 0) {
+        size_t length = std::min(size, chunk);
+        size -= length;
+        for (size_t i = 0; i < length; ++i) {
+            a += data[i];
+            b += a;
+        }
+        data += length;
+        a %= modulus;
+        b %= modulus;
+    }
+    return a | (b << 16);
+}
+
+uint32_t adler32Combine(uint32_t first, uint32_t second, size_t secondSize) {
+    const uint64_t modulus = 65521;
+    const uint64_t remainder = secondSize % modulus;
+    uint64_t a = ((first & 0xFFFF) + (second & 0xFFFF) + modulus - 1) % modulus;
+    uint64_t b = (remainder * (first & 0xFFFF) + (first >> 16) + (second >> 16) + modulus - remainder) % modulus;
+    return static_cast<uint32_t>(a | (b << 16));
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    const DeflateTables& tables = deflateTables();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = tables.crc[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Сжатие deflate (RFC 1951) без внешних библиотек: LZ77 с хеш-цепочками по окну 32 КБ и ленивым
+// сравнением совпадений, затем для каждого блока выбирается самый короткий вид — динамические коды
+// Хаффмана, фиксированные коды или несжатые данные.
+//
+// compress дописывает в выходной буфер только не последние блоки и выравнивает поток до байта
+// пустым несжатым блоком, поэтому результаты для соседних кусков данных можно склеить в один
+// поток и сжимать куски в разных потоках выполнения. Поток завершает finish
+class Deflater {
+public:
+    Deflater();
+
+    // Сжатие size байт data и дописывание результата в out. Совпадения ищутся только внутри data
+    void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    // Последний (пустой) блок потока deflate
+    static void finish(std::vector<uint8_t>& out);
+
+    static const int kMaxChain = 32; // Длина просмотра хеш-цепочки
+    static const int kNiceLength = 128; // Совпадение такой длины принимается без дальнейшего поиска
+    static const size_t kBlockSymbols = 1 << 15; // Символов LZ77 в одном блоке с общими кодами Хаффмана
+
+private:
+    // Самое длинное совпадение для позиции position среди предыдущих позиций с тем же хешем; 0, если нет
+    int findMatch(const uint8_t* data, size_t size, size_t position, int& distance) const;
+    // Блок из накопленных символов; data — те же байты без сжатия (для несжатого блока)
+    void writeBlock(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    void putBits(std::vector<uint8_t>& out, uint32_t value, int count);
+    void alignToByte(std::vector<uint8_t>& out);
+
+    std::vector<int32_t> m_head; // Последняя позиция с данным хешем трёх байт
+    std::vector<int32_t> m_previous; // Предыдущая позиция с тем же хешем (по модулю размера окна)
+    std::vector<uint32_t> m_symbols; // Литерал (расстояние 0) или совпадение: длина | расстояние << 16
+    uint64_t m_bitBuffer; // Ещё не записанные биты, младший — первый
+    int m_bitCount;
+};
+
+// Контрольные суммы zlib (RFC 1950) и PNG. Сумму двух кусков можно получить из сумм каждого
+uint32_t adler32(uint32_t adler, const uint8_t* data, size_t size);
+uint32_t adler32Combine(uint32_t first, uint32_t second, size_t secondSize);
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size);
@@ -0,0 +1,158 @@
+#include "DensityMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "BMPGenerator.h"
+#include "Profiler.h"
+
+const int64_t DensityMap::kStepsPerEdge;
+const int DensityMap::kLightestGray;
+const int DensityMap::kReferencePermille;
+
+namespace {
+
+const size_t kTasksPerThread = 4; // Полос строк ячеек на поток
+const size_t kGrayTableSize = 1 << 16;
+
+// Номер ячейки для координаты, в том числе отрицательной
+int cellOf(int coordinate, int cellSize) {
+    int cell = coordinate / cellSize;
+    return (coordinate % cellSize != 0 && coordinate < 0) ? cell - 1 : cell;
+}
+
+} // namespace
+
+DensityMap::DensityMap(int width, int height)
+    : m_width(std::max(width, 0)), m_height(std::max(height, 0)), m_cellSize(1), m_columns(0), m_rows(0) {}
+
+void DensityMap::accumulate(const GraphStorage& graph, ThreadPool& pool, int cellSize) {
+    GRAPH_PROFILE_SCOPE("render.density");
+    const size_t n = graph.vertexCount();
+    const size_t m = graph.edgeCount();
+    if (cellSize <= 0) {
+        // Длина ребра в пикселях — число шагов Брезенхэма по главной оси
+        int64_t totalSteps = 0;
+        for (size_t e = 0; e < m; ++e) {
+            const uint32_t a = graph.vertex1(e), b = graph.vertex2(e);
+            if (a < n && b < n) {
+                totalSteps += std::max(std::abs(int64_t(graph.x(b)) - graph.x(a)), std::abs(int64_t(graph.y(b)) - graph.y(a)));
+            }
+        }
+        const int64_t budget = kStepsPerEdge * static_cast<int64_t>(m) + static_cast<int64_t>(m_width) * m_height;
+        cellSize = budget > 0 ? static_cast<int>(std::min<int64_t>((totalSteps + budget - 1) / budget, INT32_MAX)) : 1;
+    }
+    m_cellSize = std::min(std::max(cellSize, 1), std::max(std::max(m_width, m_height), 1));
+    m_columns = std::max((m_width + m_cellSize - 1) / m_cellSize, 1);
+    m_rows = std::max((m_height + m_cellSize - 1) / m_cellSize, 1);
+    m_counts.assign(static_cast<size_t>(m_columns) * m_rows, 0);
+
+    // Каждая полоса строк проходит все рёбра, но считает только свои ячейки, поэтому потоки не пишут
+    // в общие счётчики
+    const size_t bandCount = std::min<size_t>(m_rows, pool.size() * kTasksPerThread);
+    pool.run(bandCount, [&](size_t band) {
+        const int rowFirst = static_cast<int>(m_rows * band / bandCount);
+        const int rowLast = static_cast<int>(m_rows * (band + 1) / bandCount);
+        const ClipRect rect = { 0, rowFirst, m_columns, rowLast };
+        auto add = [&](int column, int row) {
+            if (column >= 0 && column < m_columns && row >= rowFirst && row < rowLast) {
+                ++m_counts[static_cast<size_t>(row) * m_columns + column];
+            }
+        };
+        uint64_t steps = 0;
+        for (size_t e = 0; e < m; ++e) {
+            const uint32_t a = graph.vertex1(e), b = graph.vertex2(e);
+            if (a >= n || b >= n) {
+                continue;
+            }
+            const int x0 = cellOf(graph.x(a), m_cellSize), y0 = cellOf(graph.y(a), m_cellSize);
+            const int x1 = cellOf(graph.x(b), m_cellSize), y1 = cellOf(graph.y(b), m_cellSize);
+            if (std::max(y0, y1) < rowFirst || std::min(y0, y1) >= rowLast) {
+                continue;
+            }
+            // Конечная ячейка отрезком не проходится; ребро внутри одной ячейки только её и добавляет
+            add(x1, y1);
+            if (x0 == x1 && y0 == y1) {
+                continue;
+            }
+            BresenhamLine line(x0, y0, x1, y1);
+            int64_t first, last;
+            if (!line.clip(rect, first, last)) {
+                continue;
+            }
+            // Шаги first..last подряд: смещение по второй оси k(i) = floor((2 * minor * i + major - 1) / (2 * major))
+            // растёт не больше чем на единицу за шаг, поэтому ведётся остатком без деления
+            int x, y;
+            line.pixel(first, x, y);
+            const int64_t denominator = 2 * line.major;
+            int64_t remainder = (2 * line.minor * first + line.major - 1) % denominator;
+            for (int64_t i = first; i <= last; ++i) {
+                ++m_counts[static_cast<size_t>(y) * m_columns + x];
+                remainder += 2 * line.minor;
+                bool carry = remainder >= denominator;
+                if (carry) {
+                    remainder -= denominator;
+                }
+                if (line.steep) {
+                    y += line.sy;
+                    x += carry ? line.sx : 0;
+                }
+                else {
+                    x += line.sx;
+                    y += carry ? line.sy : 0;
+                }
+            }
+            steps += last - first + 1;
+        }
+        GRAPH_PROFILE_COUNT("density.steps", steps);
+    });
+}
+
+void DensityMap::toGray(GrayImage& image) const {
+    image.reset(m_width, m_height);
+    if (m_counts.empty()) {
+        return;
+    }
+    // Опорный счётчик — не максимум, а верхняя доля непустых ячеек: одна перегруженная ячейка
+    // (вершина огромной степени) не делает бледной всю остальную карту
+    std::vector<uint32_t> nonEmpty;
+    for (uint32_t count : m_counts) {
+        if (count > 0) {
+            nonEmpty.push_back(count);
+        }
+    }
+    if (nonEmpty.empty()) {
+        return;
+    }
+    auto reference = nonEmpty.begin() + (nonEmpty.size() - 1) * kReferencePermille / 1000;
+    std::nth_element(nonEmpty.begin(), reference, nonEmpty.end());
+    const double scale = 1.0 / std::log1p(static_cast<double>(*reference));
+    auto gray = [&](uint32_t count) {
+        double level = std::min(std::log1p(static_cast<double>(count)) * scale, 1.0);
+        return static_cast<uint8_t>(kLightestGray - std::lround(level * kLightestGray));
+    };
+    // Таблица яркостей для счётчиков до опорного (дальше — чёрный); логарифм считается только для
+    // счётчиков за пределами таблицы
+    std::vector<uint8_t> table(std::min<size_t>(*reference, kGrayTableSize) + 1);
+    table[0] = 255;
+    for (size_t count = 1; count < table.size(); ++count) {
+        table[count] = gray(static_cast<uint32_t>(count));
+    }
+
+    std::vector<uint8_t> cellGray(m_counts.size());
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        const uint32_t count = m_counts[i];
+        cellGray[i] = count < table.size() ? table[count] : count >= *reference ? 0 : gray(count);
+    }
+    for (int y = 0; y < m_height; ++y) {
+        const uint8_t* cells = cellGray.data() + static_cast<size_t>(y / m_cellSize) * m_columns;
+        uint8_t* pixels = image.row(y);
+        if (m_cellSize == 1) {
+            std::memcpy(pixels, cells, m_width);
+            continue;
+        }
+        for (int x = 0; x < m_width; ++x) {
+            pixels[x] = cells[x / m_cellSize];
+        }
+    }
+}
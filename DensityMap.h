@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Framebuffer.h"
+#include "GraphStorage.h"
+#include "ThreadPool.h"
+
+// Карта плотности рёбер для отрисовки очень плотных графов (level of detail). Вместо линий и кругов
+// в каждой ячейке холста считается число проходящих через неё рёбер, и счётчики переводятся
+// в оттенки серого по логарифмической шкале: скопления рёбер остаются различимыми, а не сливаются
+// в сплошное чёрное пятно. Вершины не рисуются, ребро с концами в одной ячейке добавляет
+// единицу в эту ячейку без растеризации.
+//
+// Ячейка — квадрат cellSize x cellSize пикселей. При cellSize = 0 сторона подбирается так,
+// чтобы суммарная длина рёбер в ячейках не превышала kStepsPerEdge шагов на ребро сверх числа
+// пикселей холста, поэтому время линейно по числу рёбер и площади при любой длине рёбер.
+// Рёбра проходятся отрезками Брезенхэма по ячейкам, строки ячеек делятся между потоками пула
+class DensityMap {
+public:
+    DensityMap(int width, int height);
+
+    void accumulate(const GraphStorage& graph, ThreadPool& pool, int cellSize = 0);
+    // Изображение размером с холст: пустые ячейки белые, непустые — от kLightestGray до чёрного
+    void toGray(GrayImage& image) const;
+
+    int cellSize() const { return m_cellSize; }
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+    uint32_t count(int column, int row) const { return m_counts[static_cast<size_t>(row) * m_columns + column]; }
+
+    static const int64_t kStepsPerEdge = 64;
+    static const int kLightestGray = 224; // Ячейка с одним ребром: заметно темнее белого фона
+    static const int kReferencePermille = 995; // Счётчик этой доли непустых ячеек соответствует чёрному
+
+private:
+    int m_width;
+    int m_height;
+    int m_cellSize;
+    int m_columns;
+    int m_rows;
+    std::vector<uint32_t> m_counts;
+};
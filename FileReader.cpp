@@ -1,9 +1,93 @@
 #include "FileReader.h"
 
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include "BinaryGraph.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+namespace {
+
+// Разбор целого числа с пропуском предшествующих пробельных символов.
+// Возвращает false, если до конца буфера не нашлось числа. Число вне диапазона int64_t читается
+// целиком и заменяется на INT64_MAX (INT64_MIN для отрицательного): вызывающий код отвергает его
+// как неверный номер вершины, а разбор файла продолжается.
+inline bool parseInteger(const char*& p, const char* end, int64_t& value) {
+    while (p != end && static_cast<unsigned char>(*p) <= ' ') {
+        ++p;
+    }
+    if (p == end) {
+        return false;
+    }
+    bool negative = *p == '-';
+    if (negative || *p == '+') {
+        ++p;
+    }
+    const char* start = p;
+    uint64_t result = 0;
+    while (p != end) {
+        unsigned digit = static_cast<unsigned char>(*p) - '0';
+        if (digit > 9) {
+            break;
+        }
+        result = result * 10 + digit;
+        ++p;
+    }
+    if (p == start) {
+        return false; // Не число
+    }
+    // До 19 цифр число помещается в uint64_t, поэтому основной цикл переполнение не проверяет
+    // (проверка на каждой цифре замедляла разбор на 20%); более длинное число пересчитывается с проверкой
+    bool overflow = false;
+    if (p - start > 19) {
+        result = 0;
+        for (const char* digits = start; digits != p && !overflow; ++digits) {
+            unsigned digit = static_cast<unsigned char>(*digits) - '0';
+            overflow = result > (UINT64_MAX - digit) / 10;
+            result = result * 10 + digit;
+        }
+    }
+    if (overflow || result > static_cast<uint64_t>(INT64_MAX)) {
+        value = negative ? INT64_MIN : INT64_MAX;
+        return true;
+    }
+    value = negative ? -static_cast<int64_t>(result) : static_cast<int64_t>(result);
+    return true;
+}
+
+// Число строк в буфере — верхняя оценка числа рёбер
+size_t countLines(const char* data, size_t size) {
+    size_t lines = 0;
+    const char* p = data;
+    const char* end = data + size;
+    while (p != end) {
+        const void* found = std::memchr(p, '\n', end - p);
+        if (!found) {
+            ++lines; // Последняя строка без перевода строки
+            break;
+        }
+        ++lines;
+        p = static_cast<const char*>(found) + 1;
+    }
+    return lines;
+}
+
+} // namespace
 
 void readInputFromFile(const std::string& filename, int& numVertices, int& width, int& height) {
+    // Двоичный файл графа содержит те же поля в заголовке
+    if (BinaryGraphFile::isBinaryGraphFile(filename)) {
+        BinaryGraphFile graph;
+        if (graph.open(filename)) {
+            numVertices = static_cast<int>(graph.numVertices());
+            width = graph.width();
+            height = graph.height();
+        }
+        return;
+    }
+
     std::ifstream file(filename); // Открытие файла для чтения
     if (file.is_open()) {
         file >> numVertices >> width >> height; // Чтение данных из файла
@@ -15,6 +99,15 @@ void readInputFromFile(const std::string& filename, int& numVertices, int& width
 }
 
 void readEdgesFromFile(const std::string& filename, std::vector<Edge>& edges) {
+    GRAPH_PROFILE_SCOPE("read.edges");
+    if (BinaryGraphFile::isBinaryGraphFile(filename)) {
+        BinaryGraphFile graph;
+        if (graph.open(filename)) {
+            graph.appendEdges(edges);
+        }
+        return;
+    }
+
     std::ifstream file(filename);
     if (file.is_open()) {
         int vertex1, vertex2;
@@ -23,6 +116,7 @@ void readEdgesFromFile(const std::string& filename, std::vector<Edge>& edges) {
             edge.vertex1 = vertex1; // Заполнение первой вершины ребра
             edge.vertex2 = vertex2; // Заполнение второй вершины ребра
             edges.push_back(edge); // Добавление ребра в вектор
+            GRAPH_PROFILE_COUNT("edges.read", 1);
         }
         file.close();
     }
@@ -30,3 +124,109 @@ void readEdgesFromFile(const std::string& filename, std::vector<Edge>& edges) {
         std::cerr << "Unable to open file: " << filename << std::endl;
     }
 }
+
+bool readEdgesFromFileFast(const std::string& filename, std::vector<Edge>& edges, size_t numVertices) {
+    GRAPH_PROFILE_SCOPE("read.edges");
+    if (BinaryGraphFile::isBinaryGraphFile(filename)) {
+        return readEdgesFromBinaryFile(filename, edges, numVertices);
+    }
+
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+    edges.reserve(edges.size() + countLines(p, file.size()));
+    const size_t firstEdge = edges.size();
+
+    size_t invalidEdges = 0;
+    int64_t vertex1, vertex2;
+    while (parseInteger(p, end, vertex1) && parseInteger(p, end, vertex2)) {
+        // Проверка номеров вершин в том же проходе
+        if (vertex1 < 0 || vertex2 < 0 || static_cast<uint64_t>(vertex1) >= numVertices || static_cast<uint64_t>(vertex2) >= numVertices) {
+            ++invalidEdges;
+            continue;
+        }
+        Edge edge;
+        edge.vertex1 = static_cast<size_t>(vertex1);
+        edge.vertex2 = static_cast<size_t>(vertex2);
+        edges.push_back(edge);
+    }
+
+    GRAPH_PROFILE_COUNT("edges.read", edges.size() - firstEdge);
+    if (invalidEdges > 0) {
+        std::cerr << "Skipped " << invalidEdges << " edges with vertex ids outside [0, " << numVertices << ") in file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readEdgesFromBinaryFile(const std::string& filename, std::vector<Edge>& edges, size_t numVertices) {
+    GRAPH_PROFILE_SCOPE("read.edges.binary");
+    BinaryGraphFile graph;
+    if (!graph.open(filename)) {
+        return false;
+    }
+
+    size_t invalidEdges = 0;
+    edges.reserve(edges.size() + graph.numEdges());
+    const size_t firstEdge = edges.size();
+    const EdgePair* pairs = graph.edges();
+    for (size_t i = 0; i < graph.numEdges(); ++i) {
+        if (pairs[i].vertex1 >= numVertices || pairs[i].vertex2 >= numVertices) {
+            ++invalidEdges;
+            continue;
+        }
+        Edge edge;
+        edge.vertex1 = pairs[i].vertex1;
+        edge.vertex2 = pairs[i].vertex2;
+        edges.push_back(edge);
+    }
+
+    GRAPH_PROFILE_COUNT("edges.read", edges.size() - firstEdge);
+    if (invalidEdges > 0) {
+        std::cerr << "Skipped " << invalidEdges << " edges with vertex ids outside [0, " << numVertices << ") in file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readEdgesFromFileFast(const std::string& filename, GraphStorage& graph, size_t numVertices) {
+    if (BinaryGraphFile::isBinaryGraphFile(filename)) {
+        return readEdgesFromBinaryFile(filename, graph, numVertices);
+    }
+    std::vector<Edge> edges;
+    bool valid = readEdgesFromFileFast(filename, edges, numVertices);
+    graph.appendEdges(edges);
+    return valid;
+}
+
+bool readEdgesFromBinaryFile(const std::string& filename, GraphStorage& graph, size_t numVertices) {
+    GRAPH_PROFILE_SCOPE("read.edges.binary");
+    BinaryGraphFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    size_t invalidEdges = 0;
+    const size_t firstEdge = graph.edgeCount();
+    graph.reserve(0, firstEdge + file.numEdges(), 0);
+    const EdgePair* pairs = file.edges();
+    for (size_t i = 0; i < file.numEdges(); ++i) {
+        if (pairs[i].vertex1 >= numVertices || pairs[i].vertex2 >= numVertices) {
+            ++invalidEdges;
+            continue;
+        }
+        graph.addEdge(pairs[i].vertex1, pairs[i].vertex2);
+    }
+
+    GRAPH_PROFILE_COUNT("edges.read", graph.edgeCount() - firstEdge);
+    if (invalidEdges > 0) {
+        std::cerr << "Skipped " << invalidEdges << " edges with vertex ids outside [0, " << numVertices << ") in file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -2,6 +2,24 @@
 #include <string>
 #include <vector>
 #include "Edge.h"
+#include "GraphStorage.h"
 
+// Обе функции определяют формат автоматически: текстовый файл или двоичный файл графа (BinaryGraph.h)
 void readInputFromFile(const std::string& filename, int& numVertices, int& width, int& height);
 void readEdgesFromFile(const std::string& filename, std::vector<Edge>& edges);
+
+// Быстрая загрузка списка рёбер: файл отображается в память и разбирается без промежуточных копий,
+// вектор рёбер заранее резервируется по числу строк. Номера вершин проверяются на попадание в
+// [0, numVertices) в том же проходе; рёбра с неверными номерами пропускаются.
+// Двоичный файл графа тоже распознаётся автоматически.
+// Возвращает false, если файл не удалось открыть или встретились неверные номера вершин.
+bool readEdgesFromFileFast(const std::string& filename, std::vector<Edge>& edges, size_t numVertices);
+
+// Загрузка рёбер из двоичного файла графа с той же проверкой номеров вершин
+bool readEdgesFromBinaryFile(const std::string& filename, std::vector<Edge>& edges, size_t numVertices);
+
+// Те же функции с загрузкой рёбер прямо в хранилище графа. Пары номеров из отображения двоичного
+// файла переносятся в GraphStorage::endpoints без промежуточного вектора Edge (8 байт на ребро вместо
+// 16 + 8); вектор Edge остаётся только для разбора текстового списка и освобождается после переноса
+bool readEdgesFromFileFast(const std::string& filename, GraphStorage& graph, size_t numVertices);
+bool readEdgesFromBinaryFile(const std::string& filename, GraphStorage& graph, size_t numVertices);
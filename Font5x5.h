@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+
+// Растровый шрифт 5x5 для печатных символов ASCII (коды 32..126).
+// Каждый символ — 5 строк сверху вниз; в строке бит j означает столбец j слева,
+// как и в словах Bitmap, поэтому строка глифа переносится в карту одним сдвигом.
+const int kGlyphWidth = 5;
+const int kGlyphHeight = 5;
+const char kFirstGlyph = ' ';
+const char kLastGlyph = '~';
+
+constexpr uint8_t kFont5x5[kLastGlyph - kFirstGlyph + 1][kGlyphHeight] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '  ..... ..... ..... ..... .....
+    { 0x04, 0x04, 0x04, 0x00, 0x04 }, // '!'  ..#.. ..#.. ..#.. ..... ..#..
+    { 0x0A, 0x0A, 0x00, 0x00, 0x00 }, // '"'  .#.#. .#.#. ..... ..... .....
+    { 0x0A, 0x1F, 0x0A, 0x1F, 0x0A }, // '#'  .#.#. ##### .#.#. ##### .#.#.
+    { 0x1E, 0x05, 0x0E, 0x14, 0x0F }, // '$'  .#### #.#.. .###. ..#.# ####.
+    { 0x13, 0x0B, 0x04, 0x1A, 0x19 }, // '%'  ##..# ##.#. ..#.. .#.## #..##
+    { 0x06, 0x09, 0x06, 0x09, 0x16 }, // '&'  .##.. #..#. .##.. #..#. .##.#
+    { 0x04, 0x04, 0x00, 0x00, 0x00 }, // '\''  ..#.. ..#.. ..... ..... .....
+    { 0x08, 0x04, 0x04, 0x04, 0x08 }, // '('  ...#. ..#.. ..#.. ..#.. ...#.
+    { 0x02, 0x04, 0x04, 0x04, 0x02 }, // ')'  .#... ..#.. ..#.. ..#.. .#...
+    { 0x15, 0x0E, 0x1F, 0x0E, 0x15 }, // '*'  #.#.# .###. ##### .###. #.#.#
+    { 0x00, 0x04, 0x0E, 0x04, 0x00 }, // '+'  ..... ..#.. .###. ..#.. .....
+    { 0x00, 0x00, 0x00, 0x04, 0x02 }, // ','  ..... ..... ..... ..#.. .#...
+    { 0x00, 0x00, 0x0E, 0x00, 0x00 }, // '-'  ..... ..... .###. ..... .....
+    { 0x00, 0x00, 0x00, 0x00, 0x04 }, // '.'  ..... ..... ..... ..... ..#..
+    { 0x10, 0x08, 0x04, 0x02, 0x01 }, // '/'  ....# ...#. ..#.. .#... #....
+    { 0x0E, 0x11, 0x11, 0x11, 0x0E }, // '0'  .###. #...# #...# #...# .###.
+    { 0x04, 0x06, 0x04, 0x04, 0x0E }, // '1'  ..#.. .##.. ..#.. ..#.. .###.
+    { 0x07, 0x04, 0x02, 0x01, 0x0F }, // '2'  ###.. ..#.. .#... #.... ####.
+    { 0x0E, 0x08, 0x0E, 0x08, 0x0E }, // '3'  .###. ...#. .###. ...#. .###.
+    { 0x0A, 0x0A, 0x0E, 0x08, 0x08 }, // '4'  .#.#. .#.#. .###. ...#. ...#.
+    { 0x0C, 0x04, 0x0C, 0x08, 0x0C }, // '5'  ..##. ..#.. ..##. ...#. ..##.
+    { 0x0E, 0x02, 0x0E, 0x0A, 0x0E }, // '6'  .###. .#... .###. .#.#. .###.
+    { 0x0E, 0x0A, 0x08, 0x08, 0x08 }, // '7'  .###. .#.#. ...#. ...#. ...#.
+    { 0x0E, 0x0A, 0x0E, 0x0A, 0x0E }, // '8'  .###. .#.#. .###. .#.#. .###.
+    { 0x0E, 0x0A, 0x0E, 0x08, 0x0E }, // '9'  .###. .#.#. .###. ...#. .###.
+    { 0x00, 0x04, 0x00, 0x04, 0x00 }, // ':'  ..... ..#.. ..... ..#.. .....
+    { 0x00, 0x04, 0x00, 0x04, 0x02 }, // ';'  ..... ..#.. ..... ..#.. .#...
+    { 0x08, 0x04, 0x02, 0x04, 0x08 }, // '<'  ...#. ..#.. .#... ..#.. ...#.
+    { 0x00, 0x0E, 0x00, 0x0E, 0x00 }, // '='  ..... .###. ..... .###. .....
+    { 0x02, 0x04, 0x08, 0x04, 0x02 }, // '>'  .#... ..#.. ...#. ..#.. .#...
+    { 0x0E, 0x08, 0x04, 0x00, 0x04 }, // '?'  .###. ...#. ..#.. ..... ..#..
+    { 0x0E, 0x1D, 0x15, 0x0D, 0x0E }, // '@'  .###. #.### #.#.# #.##. .###.
+    { 0x0E, 0x11, 0x1F, 0x11, 0x11 }, // 'A'  .###. #...# ##### #...# #...#
+    { 0x0F, 0x11, 0x0F, 0x11, 0x0F }, // 'B'  ####. #...# ####. #...# ####.
+    { 0x1E, 0x01, 0x01, 0x01, 0x1E }, // 'C'  .#### #.... #.... #.... .####
+    { 0x0F, 0x11, 0x11, 0x11, 0x0F }, // 'D'  ####. #...# #...# #...# ####.
+    { 0x1F, 0x01, 0x0F, 0x01, 0x1F }, // 'E'  ##### #.... ####. #.... #####
+    { 0x1F, 0x01, 0x0F, 0x01, 0x01 }, // 'F'  ##### #.... ####. #.... #....
+    { 0x1E, 0x01, 0x19, 0x11, 0x0E }, // 'G'  .#### #.... #..## #...# .###.
+    { 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 'H'  #...# #...# ##### #...# #...#
+    { 0x0E, 0x04, 0x04, 0x04, 0x0E }, // 'I'  .###. ..#.. ..#.. ..#.. .###.
+    { 0x1C, 0x08, 0x08, 0x09, 0x06 }, // 'J'  ..### ...#. ...#. #..#. .##..
+    { 0x11, 0x09, 0x07, 0x09, 0x11 }, // 'K'  #...# #..#. ###.. #..#. #...#
+    { 0x01, 0x01, 0x01, 0x01, 0x1F }, // 'L'  #.... #.... #.... #.... #####
+    { 0x11, 0x1B, 0x15, 0x11, 0x11 }, // 'M'  #...# ##.## #.#.# #...# #...#
+    { 0x11, 0x13, 0x15, 0x19, 0x11 }, // 'N'  #...# ##..# #.#.# #..## #...#
+    { 0x0E, 0x11, 0x11, 0x11, 0x0E }, // 'O'  .###. #...# #...# #...# .###.
+    { 0x0F, 0x11, 0x0F, 0x01, 0x01 }, // 'P'  ####. #...# ####. #.... #....
+    { 0x0E, 0x11, 0x15, 0x09, 0x16 }, // 'Q'  .###. #...# #.#.# #..#. .##.#
+    { 0x0F, 0x11, 0x0F, 0x09, 0x11 }, // 'R'  ####. #...# ####. #..#. #...#
+    { 0x1E, 0x01, 0x0E, 0x10, 0x0F }, // 'S'  .#### #.... .###. ....# ####.
+    { 0x1F, 0x04, 0x04, 0x04, 0x04 }, // 'T'  ##### ..#.. ..#.. ..#.. ..#..
+    { 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'  #...# #...# #...# #...# .###.
+    { 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'  #...# #...# #...# .#.#. ..#..
+    { 0x11, 0x11, 0x15, 0x1B, 0x11 }, // 'W'  #...# #...# #.#.# ##.## #...#
+    { 0x11, 0x0A, 0x04, 0x0A, 0x11 }, // 'X'  #...# .#.#. ..#.. .#.#. #...#
+    { 0x11, 0x0A, 0x04, 0x04, 0x04 }, // 'Y'  #...# .#.#. ..#.. ..#.. ..#..
+    { 0x1F, 0x08, 0x04, 0x02, 0x1F }, // 'Z'  ##### ...#. ..#.. .#... #####
+    { 0x06, 0x02, 0x02, 0x02, 0x06 }, // '['  .##.. .#... .#... .#... .##..
+    { 0x01, 0x02, 0x04, 0x08, 0x10 }, // '\\'  #.... .#... ..#.. ...#. ....#
+    { 0x0C, 0x08, 0x08, 0x08, 0x0C }, // ']'  ..##. ...#. ...#. ...#. ..##.
+    { 0x04, 0x0A, 0x00, 0x00, 0x00 }, // '^'  ..#.. .#.#. ..... ..... .....
+    { 0x00, 0x00, 0x00, 0x00, 0x1F }, // '_'  ..... ..... ..... ..... #####
+    { 0x02, 0x04, 0x00, 0x00, 0x00 }, // '`'  .#... ..#.. ..... ..... .....
+    { 0x00, 0x0E, 0x09, 0x09, 0x16 }, // 'a'  ..... .###. #..#. #..#. .##.#
+    { 0x01, 0x01, 0x07, 0x09, 0x07 }, // 'b'  #.... #.... ###.. #..#. ###..
+    { 0x00, 0x0E, 0x01, 0x01, 0x0E }, // 'c'  ..... .###. #.... #.... .###.
+    { 0x08, 0x08, 0x0E, 0x09, 0x0E }, // 'd'  ...#. ...#. .###. #..#. .###.
+    { 0x06, 0x09, 0x0F, 0x01, 0x0E }, // 'e'  .##.. #..#. ####. #.... .###.
+    { 0x0C, 0x02, 0x07, 0x02, 0x02 }, // 'f'  ..##. .#... ###.. .#... .#...
+    { 0x0E, 0x09, 0x0E, 0x08, 0x06 }, // 'g'  .###. #..#. .###. ...#. .##..
+    { 0x01, 0x01, 0x07, 0x09, 0x09 }, // 'h'  #.... #.... ###.. #..#. #..#.
+    { 0x02, 0x00, 0x02, 0x02, 0x02 }, // 'i'  .#... ..... .#... .#... .#...
+    { 0x08, 0x00, 0x08, 0x09, 0x06 }, // 'j'  ...#. ..... ...#. #..#. .##..
+    { 0x01, 0x09, 0x07, 0x09, 0x09 }, // 'k'  #.... #..#. ###.. #..#. #..#.
+    { 0x02, 0x02, 0x02, 0x02, 0x0C }, // 'l'  .#... .#... .#... .#... ..##.
+    { 0x00, 0x0B, 0x15, 0x15, 0x15 }, // 'm'  ..... ##.#. #.#.# #.#.# #.#.#
+    { 0x00, 0x07, 0x09, 0x09, 0x09 }, // 'n'  ..... ###.. #..#. #..#. #..#.
+    { 0x00, 0x06, 0x09, 0x09, 0x06 }, // 'o'  ..... .##.. #..#. #..#. .##..
+    { 0x00, 0x07, 0x09, 0x07, 0x01 }, // 'p'  ..... ###.. #..#. ###.. #....
+    { 0x00, 0x0E, 0x09, 0x0E, 0x08 }, // 'q'  ..... .###. #..#. .###. ...#.
+    { 0x00, 0x0D, 0x03, 0x01, 0x01 }, // 'r'  ..... #.##. ##... #.... #....
+    { 0x00, 0x0E, 0x03, 0x0C, 0x07 }, // 's'  ..... .###. ##... ..##. ###..
+    { 0x02, 0x07, 0x02, 0x02, 0x0C }, // 't'  .#... ###.. .#... .#... ..##.
+    { 0x00, 0x09, 0x09, 0x09, 0x0E }, // 'u'  ..... #..#. #..#. #..#. .###.
+    { 0x00, 0x11, 0x11, 0x0A, 0x04 }, // 'v'  ..... #...# #...# .#.#. ..#..
+    { 0x00, 0x11, 0x15, 0x15, 0x0A }, // 'w'  ..... #...# #.#.# #.#.# .#.#.
+    { 0x00, 0x09, 0x06, 0x06, 0x09 }, // 'x'  ..... #..#. .##.. .##.. #..#.
+    { 0x00, 0x09, 0x0E, 0x08, 0x06 }, // 'y'  ..... #..#. .###. ...#. .##..
+    { 0x00, 0x0F, 0x04, 0x02, 0x0F }, // 'z'  ..... ####. ..#.. .#... ####.
+    { 0x0C, 0x04, 0x02, 0x04, 0x0C }, // '{'  ..##. ..#.. .#... ..#.. ..##.
+    { 0x04, 0x04, 0x04, 0x04, 0x04 }, // '|'  ..#.. ..#.. ..#.. ..#.. ..#..
+    { 0x06, 0x04, 0x08, 0x04, 0x06 }, // '}'  .##.. ..#.. ...#. ..#.. .##..
+    { 0x00, 0x02, 0x15, 0x08, 0x00 }, // '~'  ..... .#... #.#.# ...#. .....
+};
+
+// Строки глифа символа или nullptr для непечатаемых символов
+inline const uint8_t* glyphRows(char character) {
+    return character >= kFirstGlyph && character <= kLastGlyph ? kFont5x5[character - kFirstGlyph] : nullptr;
+}
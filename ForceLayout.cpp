@@ -0,0 +1,298 @@
+#include "ForceLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "Profiler.h"
+
+namespace {
+
+// Квадродерево Barnes–Hut над текущими позициями вершин
+class QuadTree {
+public:
+    void build(const std::vector<double>& xs, const std::vector<double>& ys);
+
+    // Вершины в порядке обхода дерева: соседние в этом порядке вершины обходят одни и те же узлы,
+    // поэтому расчёт сил в нём лучше использует кэш
+    const std::vector<int>& order() const { return m_order; }
+
+    // Суммарная сила отталкивания k^2 / d, действующая на вершину index
+    void repulsion(size_t index, double x, double y, double k2, double theta, double& fx, double& fy);
+
+private:
+    static const int kMaxDepth = 48; // Совпадающие точки перестают делиться на этой глубине
+
+    struct Node {
+        double minX, minY, size; // Квадрат, покрываемый узлом
+        double massX, massY; // Сумма координат вершин, после build — центр масс
+        double mass; // Число вершин в узле
+        int child[4]; // Дети по квадрантам, -1 — нет
+        int body; // Вершина листа; -1 — внутренний или пустой узел
+    };
+
+    int newNode(double minX, double minY, double size);
+    void insert(int body, double x, double y);
+    int quadrant(const Node& node, double x, double y) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_stack;
+    std::vector<int> m_order;
+    const std::vector<double>* m_xs;
+    const std::vector<double>* m_ys;
+};
+
+int QuadTree::newNode(double minX, double minY, double size) {
+    Node node;
+    node.minX = minX;
+    node.minY = minY;
+    node.size = size;
+    node.massX = node.massY = node.mass = 0;
+    node.child[0] = node.child[1] = node.child[2] = node.child[3] = -1;
+    node.body = -1;
+    m_nodes.push_back(node);
+    return static_cast<int>(m_nodes.size() - 1);
+}
+
+int QuadTree::quadrant(const Node& node, double x, double y) const {
+    double half = node.size / 2;
+    return (x >= node.minX + half ? 1 : 0) | (y >= node.minY + half ? 2 : 0);
+}
+
+void QuadTree::build(const std::vector<double>& xs, const std::vector<double>& ys) {
+    m_xs = &xs;
+    m_ys = &ys;
+    m_nodes.clear();
+    m_nodes.reserve(2 * xs.size() + 1);
+    if (xs.empty()) {
+        return;
+    }
+    double minX = *std::min_element(xs.begin(), xs.end());
+    double maxX = *std::max_element(xs.begin(), xs.end());
+    double minY = *std::min_element(ys.begin(), ys.end());
+    double maxY = *std::max_element(ys.begin(), ys.end());
+    newNode(minX, minY, std::max(std::max(maxX - minX, maxY - minY), 1e-9) * (1 + 1e-9));
+    for (size_t i = 0; i < xs.size(); ++i) {
+        insert(static_cast<int>(i), xs[i], ys[i]);
+    }
+
+    // Суммы координат заменяются центрами масс, вершины собираются в порядке обхода
+    m_order.clear();
+    m_order.reserve(xs.size());
+    m_stack.assign(1, 0);
+    while (!m_stack.empty()) {
+        Node& node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        node.massX /= node.mass;
+        node.massY /= node.mass;
+        if (node.body >= 0) {
+            m_order.push_back(node.body);
+        }
+        for (int q = 3; q >= 0; --q) {
+            if (node.child[q] >= 0) {
+                m_stack.push_back(node.child[q]);
+            }
+        }
+    }
+    if (m_order.size() < xs.size()) {
+        // Совпадающие точки на предельной глубине хранятся только массой листа
+        std::vector<bool> seen(xs.size(), false);
+        for (size_t i = 0; i < m_order.size(); ++i) {
+            seen[m_order[i]] = true;
+        }
+        for (size_t i = 0; i < xs.size(); ++i) {
+            if (!seen[i]) {
+                m_order.push_back(static_cast<int>(i));
+            }
+        }
+    }
+}
+
+void QuadTree::insert(int body, double x, double y) {
+    int current = 0;
+    for (int depth = 0;; ++depth) {
+        // Центр масс обновляется по пути вниз
+        m_nodes[current].massX += x;
+        m_nodes[current].massY += y;
+        m_nodes[current].mass += 1;
+        if (m_nodes[current].mass == 1) {
+            m_nodes[current].body = body; // Пустой лист
+            return;
+        }
+        if (depth >= kMaxDepth) {
+            return; // Совпадающие точки остаются в одном листе с суммарной массой
+        }
+        if (m_nodes[current].body >= 0) {
+            // Лист с одной вершиной становится внутренним узлом: переносим прежнюю вершину в ребёнка
+            int previous = m_nodes[current].body;
+            m_nodes[current].body = -1;
+            double px = (*m_xs)[previous];
+            double py = (*m_ys)[previous];
+            int q = quadrant(m_nodes[current], px, py);
+            double half = m_nodes[current].size / 2;
+            int child = newNode(m_nodes[current].minX + (q & 1 ? half : 0), m_nodes[current].minY + (q & 2 ? half : 0), half);
+            m_nodes[current].child[q] = child;
+            m_nodes[child].massX = px;
+            m_nodes[child].massY = py;
+            m_nodes[child].mass = 1;
+            m_nodes[child].body = previous;
+        }
+        int q = quadrant(m_nodes[current], x, y);
+        if (m_nodes[current].child[q] < 0) {
+            double half = m_nodes[current].size / 2;
+            int child = newNode(m_nodes[current].minX + (q & 1 ? half : 0), m_nodes[current].minY + (q & 2 ? half : 0), half);
+            m_nodes[current].child[q] = child;
+        }
+        current = m_nodes[current].child[q];
+    }
+}
+
+void QuadTree::repulsion(size_t index, double x, double y, double k2, double theta, double& fx, double& fy) {
+    fx = fy = 0;
+    if (m_nodes.empty()) {
+        return;
+    }
+    // Глубина дерева ограничена, поэтому стек обхода помещается в массив фиксированного размера
+    int stack[3 * kMaxDepth + 4];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        double mass = node.mass;
+        bool leaf = node.child[0] < 0 && node.child[1] < 0 && node.child[2] < 0 && node.child[3] < 0;
+        if (leaf && node.body == static_cast<int>(index)) {
+            mass -= 1; // Вершина не отталкивает сама себя
+            if (mass <= 0) {
+                continue;
+            }
+        }
+        double dx = x - node.massX;
+        double dy = y - node.massY;
+        double distance2 = dx * dx + dy * dy;
+        if (leaf || node.size * node.size < theta * theta * distance2) {
+            if (distance2 < 1e-12) {
+                // Совпадающие точки расталкиваем в детерминированном направлении
+                dx = 1e-3 * ((index & 1) ? 1 : -1);
+                dy = 1e-3 * ((index & 2) ? 1 : -1);
+                distance2 = dx * dx + dy * dy;
+            }
+            // |F| = k^2 / d, направление (dx, dy) / d
+            double scale = k2 * mass / distance2;
+            fx += dx * scale;
+            fy += dy * scale;
+            continue;
+        }
+        for (int q = 0; q < 4; ++q) {
+            if (node.child[q] >= 0) {
+                stack[top++] = node.child[q];
+            }
+        }
+    }
+}
+
+} // namespace
+
+const int ForceLayout::kMaxIterations;
+const int ForceLayout::kMinIterations;
+const size_t ForceLayout::kVertexIterations;
+
+ForceLayout::ForceLayout(const ForceLayoutSettings& settings) : m_settings(settings) {}
+
+int ForceLayout::defaultIterations(size_t numVertices) {
+    if (numVertices == 0) {
+        return kMaxIterations;
+    }
+    size_t iterations = kVertexIterations / numVertices;
+    return static_cast<int>(std::min<size_t>(std::max<size_t>(iterations, kMinIterations), kMaxIterations));
+}
+
+void ForceLayout::run(std::vector<Vertex>& vertices, const std::vector<Edge>& edges, int width, int height) const {
+    runFrom(vertices, edges.size(), [&](size_t i, size_t& a, size_t& b) {
+        a = edges[i].vertex1;
+        b = edges[i].vertex2;
+    }, width, height);
+}
+
+void ForceLayout::run(std::vector<Vertex>& vertices, const std::vector<uint32_t>& endpoints, int width, int height) const {
+    runFrom(vertices, endpoints.size() / 2, [&](size_t i, size_t& a, size_t& b) {
+        a = endpoints[2 * i];
+        b = endpoints[2 * i + 1];
+    }, width, height);
+}
+
+template <typename EdgeAt>
+void ForceLayout::runFrom(std::vector<Vertex>& vertices, size_t numEdges, EdgeAt edgeAt, int width, int height) const {
+    GRAPH_PROFILE_SCOPE("layout");
+    const size_t n = vertices.size();
+    if (n == 0) {
+        return;
+    }
+    const double areaWidth = std::max(width - 2 * m_settings.margin, 1);
+    const double areaHeight = std::max(height - 2 * m_settings.margin, 1);
+
+    // Детерминированная начальная расстановка
+    std::mt19937 random(m_settings.seed);
+    std::uniform_real_distribution<double> unitInterval(0.0, 1.0);
+    std::vector<double> xs(n), ys(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = unitInterval(random) * areaWidth;
+        ys[i] = unitInterval(random) * areaHeight;
+    }
+
+    // Оптимальное расстояние между вершинами и начальная «температура» (максимальный шаг)
+    const double k = std::sqrt(areaWidth * areaHeight / n);
+    const double k2 = k * k;
+    const double initialTemperature = std::max(areaWidth, areaHeight) / 10;
+
+    const int iterations = m_settings.iterations > 0 ? m_settings.iterations : defaultIterations(n);
+    QuadTree tree;
+    std::vector<double> dispX(n), dispY(n);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        // Отталкивание всех пар через квадродерево
+        tree.build(xs, ys);
+        for (int i : tree.order()) {
+            tree.repulsion(i, xs[i], ys[i], k2, m_settings.theta, dispX[i], dispY[i]);
+        }
+
+        // Притяжение вдоль рёбер: |F| = d^2 / k
+        for (size_t e = 0; e < numEdges; ++e) {
+            size_t a, b;
+            edgeAt(e, a, b);
+            if (a >= n || b >= n || a == b) {
+                continue;
+            }
+            double dx = xs[a] - xs[b];
+            double dy = ys[a] - ys[b];
+            double distance = std::sqrt(dx * dx + dy * dy);
+            double scale = distance / k;
+            dispX[a] -= dx * scale;
+            dispY[a] -= dy * scale;
+            dispX[b] += dx * scale;
+            dispY[b] += dy * scale;
+        }
+
+        // Сдвиг не больше текущей температуры, с линейным охлаждением. Позиции не прижимаются к области:
+        // отталкивание тогда собирает большинство вершин на рамке и рёбра вдоль неё пересекаются;
+        // на холст укладка переносится масштабированием после итераций
+        double temperature = initialTemperature * (1.0 - static_cast<double>(iteration) / iterations);
+        for (size_t i = 0; i < n; ++i) {
+            double length = std::sqrt(dispX[i] * dispX[i] + dispY[i] * dispY[i]);
+            if (length > 0) {
+                double step = std::min(length, temperature) / length;
+                xs[i] += dispX[i] * step;
+                ys[i] += dispY[i] * step;
+            }
+        }
+    }
+
+    // Масштабирование ограничивающего прямоугольника на холст с отступами
+    double minX = *std::min_element(xs.begin(), xs.end());
+    double maxX = *std::max_element(xs.begin(), xs.end());
+    double minY = *std::min_element(ys.begin(), ys.end());
+    double maxY = *std::max_element(ys.begin(), ys.end());
+    double scaleX = maxX > minX ? areaWidth / (maxX - minX) : 0;
+    double scaleY = maxY > minY ? areaHeight / (maxY - minY) : 0;
+    for (size_t i = 0; i < n; ++i) {
+        vertices[i].x = m_settings.margin + static_cast<int>(std::lround((xs[i] - minX) * scaleX));
+        vertices[i].y = m_settings.margin + static_cast<int>(std::lround((ys[i] - minY) * scaleY));
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+#include "Edge.h"
+
+// Параметры силовой укладки
+struct ForceLayoutSettings {
+    int iterations; // Бюджет итераций; 0 — по числу вершин (ForceLayout::defaultIterations)
+    unsigned seed; // Зерно начальной случайной расстановки (одинаковое зерно — одинаковый результат)
+    double theta; // Критерий Barnes–Hut: узел дерева заменяется центром масс при size / distance < theta
+    int margin; // Отступ от края холста в пикселях
+
+    ForceLayoutSettings() : iterations(0), seed(1), theta(0.8), margin(20) {}
+};
+
+// Силовая укладка Фрюхтермана–Рейнгольда. Отталкивание считается приближённо по квадродереву
+// Barnes–Hut за O(V log V) на итерацию, притяжение — по рёбрам за O(E).
+class ForceLayout {
+public:
+    explicit ForceLayout(const ForceLayoutSettings& settings = ForceLayoutSettings());
+
+    // Расстановка вершин на холсте width x height; прежние координаты вершин не используются
+    void run(std::vector<Vertex>& vertices, const std::vector<Edge>& edges, int width, int height) const;
+    // То же по концам рёбер, записанным подряд парами (как GraphStorage::endpoints)
+    void run(std::vector<Vertex>& vertices, const std::vector<uint32_t>& endpoints, int width, int height) const;
+
+    // Бюджет итераций по умолчанию: kMaxIterations для небольших графов, для больших — так, чтобы
+    // итераций на вершины было не больше kVertexIterations, но не меньше kMinIterations.
+    // Итерация на 100000 вершин стоит 0.2–0.4 с, поэтому 300 итераций заняли бы минуты
+    static int defaultIterations(size_t numVertices);
+
+    static const int kMaxIterations = 300;
+    static const int kMinIterations = 20;
+    static const size_t kVertexIterations = 1 << 21;
+
+private:
+    // edgeAt(i, a, b) записывает концы ребра i
+    template <typename EdgeAt>
+    void runFrom(std::vector<Vertex>& vertices, size_t numEdges, EdgeAt edgeAt, int width, int height) const;
+
+    ForceLayoutSettings m_settings;
+};
@@ -0,0 +1,569 @@
+#include "Framebuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GRAPH_HAVE_SSE2 1
+#endif
+
+namespace {
+
+// Смешивание по каналам: (c * a + p * (255 - a) + 128), делённое на 255 через (v + (v >> 8)) >> 8.
+// Каналы B и R (и отдельно G и A) считаются вместе в 16-битных полях одного 32-битного слова:
+// промежуточное значение не превышает 65535, поэтому поля не переполняются
+inline uint32_t blendLanes(uint32_t color, uint32_t pixel, uint32_t alpha) {
+    uint32_t value = color * alpha + pixel * (255 - alpha) + 0x00800080u;
+    return ((value + ((value >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+}
+
+inline Color blendPixel(Color pixel, Color color, uint32_t alpha) {
+    return blendLanes(color & 0x00FF00FFu, pixel & 0x00FF00FFu, alpha)
+        | (blendLanes((color >> 8) & 0x00FF00FFu, (pixel >> 8) & 0x00FF00FFu, alpha) << 8);
+}
+
+#ifdef GRAPH_HAVE_SSE2
+// Смешивание четырёх пикселей по покрытиям alpha: a0 a0 a1 a1 a2 a2 a3 a3 в 16-битных полях.
+// Каналы расширяются до 16 бит; покрытие каждого пикселя повторяется на его 4 канала
+inline void blendQuad(Color* pixels, __m128i colorWide, __m128i alpha) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+    __m128i alphaLow = _mm_unpacklo_epi32(alpha, alpha); // a0 x4, a1 x4
+    __m128i alphaHigh = _mm_unpackhi_epi32(alpha, alpha); // a2 x4, a3 x4
+
+    __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    __m128i low = _mm_unpacklo_epi8(destination, zero);
+    __m128i high = _mm_unpackhi_epi8(destination, zero);
+    low = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(colorWide, alphaLow),
+        _mm_mullo_epi16(low, _mm_sub_epi16(full, alphaLow))), half);
+    high = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(colorWide, alphaHigh),
+        _mm_mullo_epi16(high, _mm_sub_epi16(full, alphaHigh))), half);
+    low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+    high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_packus_epi16(low, high));
+}
+
+// Смешивание четырёх пикселей по покрытиям из младших 4 байт packed
+inline void blendFour(Color* pixels, __m128i colorWide, uint32_t packed) {
+    __m128i alpha = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(packed)), _mm_setzero_si128());
+    blendQuad(pixels, colorWide, _mm_unpacklo_epi16(alpha, alpha));
+}
+
+// Смешивание четырёх пикселей по масштабированным покрытиям scaled (s0 s0 s1 s1 s2 s2 s3 s3, s = a * 128.5):
+// p + (c - p) * a / 255 одним умножением старших половин вместо двух полных. Результат отличается
+// от blendQuad не больше чем на 1; при покрытии 0 пиксель не меняется. colorDouble — каналы цвета, умноженные на 2
+inline void blendQuadScaled(Color* pixels, __m128i colorDouble, __m128i scaled) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    __m128i low = _mm_unpacklo_epi8(destination, zero);
+    __m128i high = _mm_unpackhi_epi8(destination, zero);
+    low = _mm_add_epi16(low, _mm_mulhi_epi16(_mm_sub_epi16(colorDouble, _mm_add_epi16(low, low)), _mm_unpacklo_epi32(scaled, scaled)));
+    high = _mm_add_epi16(high, _mm_mulhi_epi16(_mm_sub_epi16(colorDouble, _mm_add_epi16(high, high)), _mm_unpackhi_epi32(scaled, scaled)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), _mm_packus_epi16(low, high));
+}
+
+// Смешивание 16 пикселей по 16 покрытиям coverage без ветвлений (blendQuadScaled)
+inline void blendSixteen(Color* pixels, __m128i colorDouble, __m128i coverage) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low = _mm_unpacklo_epi8(coverage, zero);
+    __m128i high = _mm_unpackhi_epi8(coverage, zero);
+    low = _mm_add_epi16(_mm_slli_epi16(low, 7), _mm_srli_epi16(low, 1));
+    high = _mm_add_epi16(_mm_slli_epi16(high, 7), _mm_srli_epi16(high, 1));
+    blendQuadScaled(pixels, colorDouble, _mm_unpacklo_epi16(low, low));
+    blendQuadScaled(pixels + 4, colorDouble, _mm_unpackhi_epi16(low, low));
+    blendQuadScaled(pixels + 8, colorDouble, _mm_unpacklo_epi16(high, high));
+    blendQuadScaled(pixels + 12, colorDouble, _mm_unpackhi_epi16(high, high));
+}
+
+inline __m128i loadFour(const uint8_t* values) {
+    int32_t packed;
+    std::memcpy(&packed, values, sizeof(packed));
+    return _mm_cvtsi32_si128(packed);
+}
+
+inline void storeFour(uint8_t* values, __m128i packed) {
+    int32_t low = _mm_cvtsi128_si32(packed);
+    std::memcpy(values, &low, sizeof(low));
+}
+#endif
+
+inline float clampUnit(float value) {
+    return value < 0 ? 0 : (value > 1 ? 1 : value);
+}
+
+// Покрытие пикселя отрезка: поперёк по расстоянию across до оси, вдоль по проекции along (CoverageMask::addSegmentSpan)
+inline uint8_t segmentCoverage(float across, float along, float reach, float length) {
+    float value = clampUnit(reach - std::fabs(across)) * clampUnit(along + 0.5f) * clampUnit(length - along + 0.5f);
+    return static_cast<uint8_t>(value * 255 + 0.5f);
+}
+
+// Покрытия отрезка по полной формуле (CoverageMask::addSegmentSpan), объединяемые с маской максимумом.
+// Те же действия над float в том же порядке, что и в segmentCoverage, поэтому покрытия совпадают
+class SegmentCoverage {
+public:
+    SegmentCoverage(float acrossStep, float alongStep, float reach, float length)
+        : m_acrossStep(acrossStep), m_alongStep(alongStep), m_reach(reach), m_length(length) {
+#ifdef GRAPH_HAVE_SSE2
+        m_acrossSteps = _mm_set1_ps(acrossStep);
+        m_alongSteps = _mm_set1_ps(alongStep);
+        m_reaches = _mm_set1_ps(reach);
+        m_lengths = _mm_set1_ps(length);
+#endif
+    }
+
+    void add(uint8_t* values, int count, float across, float along) const {
+        int i = 0;
+#ifdef GRAPH_HAVE_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 halfPixel = _mm_set1_ps(0.5f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 acrossStart = _mm_set1_ps(across), alongStart = _mm_set1_ps(along);
+        __m128 indices = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        for (; i + 4 <= count; i += 4, indices = _mm_add_ps(indices, _mm_set1_ps(4.0f))) {
+            __m128 distance = _mm_andnot_ps(signMask, _mm_sub_ps(acrossStart, _mm_mul_ps(indices, m_acrossSteps)));
+            __m128 position = _mm_add_ps(alongStart, _mm_mul_ps(indices, m_alongSteps));
+            __m128 value = _mm_max_ps(_mm_min_ps(_mm_sub_ps(m_reaches, distance), one), zero);
+            value = _mm_mul_ps(value, _mm_max_ps(_mm_min_ps(_mm_add_ps(position, halfPixel), one), zero));
+            value = _mm_mul_ps(value, _mm_max_ps(_mm_min_ps(_mm_add_ps(_mm_sub_ps(m_lengths, position), halfPixel), one), zero));
+            __m128i coverage = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), halfPixel));
+            coverage = _mm_packs_epi32(coverage, coverage);
+            coverage = _mm_packus_epi16(coverage, coverage);
+            storeFour(values + i, _mm_max_epu8(coverage, loadFour(values + i)));
+        }
+#endif
+        for (; i < count; ++i) {
+            values[i] = std::max(values[i], segmentCoverage(across - i * m_acrossStep, along + i * m_alongStep, m_reach, m_length));
+        }
+    }
+
+private:
+    float m_acrossStep;
+    float m_alongStep;
+    float m_reach;
+    float m_length;
+#ifdef GRAPH_HAVE_SSE2
+    __m128 m_acrossSteps;
+    __m128 m_alongSteps;
+    __m128 m_reaches;
+    __m128 m_lengths;
+#endif
+};
+
+inline uint8_t rampCoverage(int32_t distance, int32_t limit) {
+    int32_t value = (limit - std::abs(distance)) >> 8;
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Покрытия с линейно меняющимся расстоянием (см. CoverageMask::addRamp), объединяемые с маской максимумом.
+// Константы SIMD готовятся один раз в конструкторе, поэтому addSteepLine не повторяет их для каждой строки
+class RampCoverage {
+public:
+    RampCoverage(int32_t step, int32_t limit) : m_step(step), m_limit(limit) {
+#ifdef GRAPH_HAVE_SSE2
+        m_limits = _mm_set1_epi32(limit);
+        m_steps = _mm_set1_epi32(step * 4);
+        m_offsets = _mm_setr_epi32(0, step, step * 2, step * 3);
+#endif
+    }
+
+    void add(uint8_t* values, int count, int32_t distance) const {
+        int i = 0;
+#ifdef GRAPH_HAVE_SSE2
+        // Покрытия четырёх пикселей: |d| через (d ^ s) - s, ограничение 0..255 — насыщающей упаковкой в 16 и 8 бит
+        __m128i distances = _mm_sub_epi32(_mm_set1_epi32(distance), m_offsets);
+        for (; i + 4 <= count; i += 4) {
+            __m128i sign = _mm_srai_epi32(distances, 31);
+            __m128i absolute = _mm_sub_epi32(_mm_xor_si128(distances, sign), sign);
+            __m128i value = _mm_srai_epi32(_mm_sub_epi32(m_limits, absolute), 8);
+            value = _mm_packs_epi32(value, value);
+            value = _mm_packus_epi16(value, value);
+            int32_t previous;
+            std::memcpy(&previous, values + i, sizeof(previous));
+            int32_t merged = _mm_cvtsi128_si32(_mm_max_epu8(value, _mm_cvtsi32_si128(previous)));
+            std::memcpy(values + i, &merged, sizeof(merged));
+            distances = _mm_sub_epi32(distances, m_steps);
+        }
+        distance -= m_step * i;
+#endif
+        for (; i < count; ++i) {
+            values[i] = std::max(values[i], rampCoverage(distance, m_limit));
+            distance -= m_step;
+        }
+    }
+
+private:
+    int32_t m_step;
+    int32_t m_limit;
+#ifdef GRAPH_HAVE_SSE2
+    __m128i m_limits;
+    __m128i m_steps;
+    __m128i m_offsets;
+#endif
+};
+
+#ifdef GRAPH_HAVE_SSE2
+// Покрытия в 16-битных полях: limit - |distance - offset| с насыщением; упаковка в байты
+// (_mm_packus_epi16) затем ограничивает их диапазоном 0..255
+inline __m128i rampWords(__m128i distances, __m128i offsets, __m128i limits) {
+    __m128i value = _mm_sub_epi16(distances, offsets);
+    value = _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+    return _mm_subs_epi16(limits, value);
+}
+
+// 8 байт low в младшую половину регистра и 8 байт high в старшую (movlps и movhps)
+inline __m128i loadEightPair(const uint8_t* low, const uint8_t* high) {
+    __m128 pair = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(low)));
+    return _mm_castps_si128(_mm_loadh_pi(pair, reinterpret_cast<const __m64*>(high)));
+}
+
+inline void storeEightPair(uint8_t* low, uint8_t* high, __m128i pair) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(low), pair);
+    _mm_storeh_pi(reinterpret_cast<__m64*>(high), _mm_castsi128_ps(pair));
+}
+
+// Четыре строки крутой линии: shifted — x оси строк в формате 16.16, сдвинутый на 1 - halfWidth, поэтому
+// начало окна — его целая часть, а расстояние от оси до начала окна растёт с дробной частью. Строки 1..3
+// лежат на offset1..offset3 байт дальше строки 0 (совпадающие строки допустимы: повторный max ничего не меняет)
+template<int Window>
+inline void addSteepQuad(uint8_t* line, size_t offset1, size_t offset2, size_t offset3, __m128i shifted, int chunks,
+    __m128i steps, __m128i offsets, __m128i chunkOffset, __m128i limits) {
+    __m128i firsts = _mm_srai_epi32(shifted, 16);
+    uint8_t* values0 = line + _mm_cvtsi128_si32(firsts);
+    uint8_t* values1 = line + offset1 + _mm_cvtsi128_si32(_mm_shuffle_epi32(firsts, 0x55));
+    uint8_t* values2 = line + offset2 + _mm_cvtsi128_si32(_mm_unpackhi_epi64(firsts, firsts));
+    uint8_t* values3 = line + offset3 + _mm_cvtsi128_si32(_mm_shuffle_epi32(firsts, 0xFF));
+    // Дробная часть (младшие 16 бит поля) и step делятся пополам, чтобы произведение со знаком уместилось в 16 бит
+    __m128i distances = _mm_srai_epi16(_mm_mulhi_epi16(_mm_srli_epi16(shifted, 1), steps), 6);
+    distances = _mm_shufflehi_epi16(_mm_shufflelo_epi16(distances, 0xA0), 0xA0); // d0 d0 d1 d1 d2 d2 d3 d3
+    if (Window == 4) {
+        __m128i coverage = _mm_packus_epi16(rampWords(_mm_unpacklo_epi32(distances, distances), offsets, limits),
+            rampWords(_mm_unpackhi_epi32(distances, distances), offsets, limits));
+        __m128i previous = _mm_unpacklo_epi64(_mm_unpacklo_epi32(loadFour(values0), loadFour(values1)),
+            _mm_unpacklo_epi32(loadFour(values2), loadFour(values3)));
+        __m128i merged = _mm_max_epu8(coverage, previous);
+        storeFour(values0, merged);
+        storeFour(values1, _mm_srli_si128(merged, 4));
+        storeFour(values2, _mm_srli_si128(merged, 8));
+        storeFour(values3, _mm_srli_si128(merged, 12));
+        return;
+    }
+    const __m128i distances0 = _mm_shuffle_epi32(distances, 0x00);
+    const __m128i distances1 = _mm_shuffle_epi32(distances, 0x55);
+    const __m128i distances2 = _mm_shuffle_epi32(distances, 0xAA);
+    const __m128i distances3 = _mm_shuffle_epi32(distances, 0xFF);
+    if (Window == 8) {
+        chunks = 1; // Окно из одной восьмёрки: цикл разворачивается
+    }
+    __m128i chunk = offsets;
+    for (int i = 0; i < chunks * 8; i += 8, chunk = _mm_add_epi16(chunk, chunkOffset)) {
+        __m128i coverage01 = _mm_packus_epi16(rampWords(distances0, chunk, limits), rampWords(distances1, chunk, limits));
+        __m128i coverage23 = _mm_packus_epi16(rampWords(distances2, chunk, limits), rampWords(distances3, chunk, limits));
+        __m128i merged01 = _mm_max_epu8(coverage01, loadEightPair(values0 + i, values1 + i));
+        __m128i merged23 = _mm_max_epu8(coverage23, loadEightPair(values2 + i, values3 + i));
+        storeEightPair(values0 + i, values1 + i, merged01);
+        storeEightPair(values2 + i, values3 + i, merged23);
+    }
+}
+
+// Крутая линия по четыре строки за шаг (addSteepQuad). При Window == 4 покрытия четырёх окон собираются
+// в один регистр, при Window == 8 и 16 окно из 8 или chunks * 8 пикселей рисуется по 8 пикселей двух строк за раз.
+// center, slope и halfWidth — в формате 16.16, x оси во всех строках должен умещаться в 30 бит,
+// а halfWidth — быть не больше 16 пикселей. offsets — смещения пикселей i * step в единицах 1/255 пикселя,
+// chunkOffset — смещение следующих 8 пикселей
+template<int Window>
+void addSteepRowsByFour(uint8_t* line, size_t stride, int rows, int chunks, int32_t center, int32_t slope,
+    int32_t halfWidth, int32_t step, __m128i offsets, __m128i chunkOffset, __m128i limits) {
+    // Расстояние от оси до начала окна — (дробная часть shifted - bias) * step / 2^24: вычитаемое
+    // постоянно и переносится в смещения пикселей
+    const int32_t bias = 0xFFFF - halfWidth;
+    const int16_t shift = static_cast<int16_t>((static_cast<int64_t>(bias) * step + (1 << 23)) >> 24);
+    offsets = _mm_add_epi16(offsets, _mm_set1_epi16(shift));
+    const __m128i steps = _mm_set1_epi16(static_cast<int16_t>(step >> 1));
+    const __m128i centerStep = _mm_set1_epi32(4 * slope);
+    __m128i shifted = _mm_setr_epi32(center + bias, center + bias + slope, center + bias + 2 * slope, center + bias + 3 * slope);
+    int k = 0;
+    for (; k + 4 <= rows; k += 4, line += 4 * stride, shifted = _mm_add_epi32(shifted, centerStep)) {
+        addSteepQuad<Window>(line, stride, 2 * stride, 3 * stride, shifted, chunks, steps, offsets, chunkOffset, limits);
+    }
+    if (k < rows) {
+        // Последние строки: недостающие поля повторяют последнюю строку
+        int last = rows - 1 - k;
+        int32_t current = _mm_cvtsi128_si32(shifted);
+        shifted = _mm_setr_epi32(current, current + std::min(1, last) * slope,
+            current + std::min(2, last) * slope, current + std::min(3, last) * slope);
+        addSteepQuad<Window>(line, std::min(1, last) * stride, std::min(2, last) * stride, std::min(3, last) * stride,
+            shifted, chunks, steps, offsets, chunkOffset, limits);
+    }
+}
+#endif
+
+} // namespace
+
+Framebuffer::Framebuffer() : m_width(0), m_height(0) {}
+
+Framebuffer::Framebuffer(int width, int height) : m_width(0), m_height(0) {
+    reset(width, height);
+}
+
+void Framebuffer::reset(int width, int height, Color background) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height, background);
+}
+
+void Framebuffer::clear(Color background) {
+    std::fill(m_pixels.begin(), m_pixels.end(), background);
+}
+
+void Framebuffer::fillSpan(int y, int x0, int x1, Color color) {
+    if (y < 0 || y >= m_height) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, m_width - 1);
+    if (x0 <= x1) {
+        std::fill(row(y) + x0, row(y) + x1 + 1, color);
+    }
+}
+
+void Framebuffer::blendSpan(int y, int x, int count, Color color, const uint8_t* coverage) {
+    GRAPH_PROFILE_COUNT("pixels.touched", count);
+    Color* pixels = row(y) + x;
+    int i = 0;
+#ifdef GRAPH_HAVE_SSE2
+    const __m128i colorWide = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), _mm_setzero_si128());
+    for (; i + 4 <= count; i += 4) {
+        uint32_t packed;
+        std::memcpy(&packed, coverage + i, sizeof(packed));
+        if (packed != 0) {
+            blendFour(pixels + i, colorWide, packed);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        pixels[i] = blendPixel(pixels[i], color, coverage[i]);
+    }
+}
+
+void Framebuffer::blendMask(const CoverageMask& mask, Color color, int y0, int y1) {
+    y0 = std::max(y0, mask.boundsY0());
+    y1 = std::min(y1, mask.boundsY1() + 1);
+    if (mask.empty() || y0 >= y1) {
+        return;
+    }
+    const int x0 = mask.boundsX0();
+    const int count = mask.boundsX1() - x0 + 1;
+    int64_t touched = 0;
+#ifdef GRAPH_HAVE_SSE2
+    __m128i colorDouble = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), _mm_setzero_si128());
+    colorDouble = _mm_add_epi16(colorDouble, colorDouble);
+    const __m128i colors = _mm_set1_epi32(static_cast<int>(color));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi8(static_cast<char>(-1));
+#endif
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* coverage = mask.row(y) + x0;
+        Color* pixels = row(y) + x0;
+        int i = 0;
+#ifdef GRAPH_HAVE_SSE2
+        // По 16 покрытий: пустые группы пропускаются, полностью покрытые записываются цветом,
+        // остальные смешиваются целиком — проверка каждой четвёрки пикселей дороже смешивания
+        for (; i + 16 <= count; i += 16) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(values, zero)) == 0xFFFF) {
+                continue;
+            }
+            touched += 16;
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(values, full)) == 0xFFFF) {
+                for (int k = 0; k < 16; k += 4) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i + k), colors);
+                }
+                continue;
+            }
+            blendSixteen(pixels + i, colorDouble, values);
+        }
+#endif
+        for (; i < count; ++i) {
+            if (coverage[i] == 255) {
+                pixels[i] = color;
+            }
+            else if (coverage[i] != 0) {
+                pixels[i] = blendPixel(pixels[i], color, coverage[i]);
+            }
+        }
+    }
+    GRAPH_PROFILE_COUNT("pixels.touched", touched);
+}
+
+CoverageMask::CoverageMask() : m_width(0), m_top(0), m_rows(0), m_x0(0), m_y0(0), m_x1(-1), m_y1(-1) {}
+
+void CoverageMask::reset(int width, int top, int rows) {
+    // Пустая маска уже обнулена: для полосы той же ширины и не выше переносится только начальная строка
+    if (width == m_width && rows >= 0 && static_cast<size_t>(width) * rows <= m_values.size() && empty()) {
+        m_top = top;
+        m_rows = rows;
+        return;
+    }
+    m_width = std::max(width, 0);
+    m_top = top;
+    m_rows = std::max(rows, 0);
+    m_values.assign(static_cast<size_t>(m_width) * m_rows, 0);
+    m_x0 = m_y0 = 0;
+    m_x1 = m_y1 = -1;
+}
+
+void CoverageMask::clear() {
+    if (empty()) {
+        return;
+    }
+    for (int y = m_y0; y <= m_y1; ++y) {
+        std::memset(row(y) + m_x0, 0, m_x1 - m_x0 + 1);
+    }
+    m_x0 = m_y0 = 0;
+    m_x1 = m_y1 = -1;
+}
+
+void CoverageMask::touch(int x0, int y0, int x1, int y1) {
+    if (empty()) {
+        m_x0 = x0;
+        m_y0 = y0;
+        m_x1 = x1;
+        m_y1 = y1;
+        return;
+    }
+    m_x0 = std::min(m_x0, x0);
+    m_y0 = std::min(m_y0, y0);
+    m_x1 = std::max(m_x1, x1);
+    m_y1 = std::max(m_y1, y1);
+}
+
+void CoverageMask::addSegmentSpan(int y, int x, int count, float across, float acrossStep, float along, float alongStep,
+    float reach, float length) {
+    if (count <= 0) {
+        return;
+    }
+    touch(x, y, x + count - 1, y);
+    SegmentCoverage(acrossStep, alongStep, reach, length).add(row(y) + x, count, across, along);
+}
+
+void CoverageMask::addSegmentWindows(int y, int rows, int window, int64_t center, int64_t slope, int64_t halfWidth,
+    int originX, int originY, float ux, float uy, float reach, float length) {
+    if (rows <= 0) {
+        return;
+    }
+    int64_t firstStart = (center - halfWidth + 0xFFFF) >> 16;
+    int64_t lastStart = (center + slope * (rows - 1) - halfWidth + 0xFFFF) >> 16;
+    touch(static_cast<int>(std::min(firstStart, lastStart)), y, static_cast<int>(std::max(firstStart, lastStart)) + window - 1, y + rows - 1);
+    const SegmentCoverage segment(uy, ux, reach, length);
+    for (int k = 0; k < rows; ++k, center += slope) {
+        int first = static_cast<int>((center - halfWidth + 0xFFFF) >> 16); // ceil(center - halfWidth)
+        float ry = static_cast<float>(y + k - originY);
+        float offset = static_cast<float>(first - originX);
+        segment.add(row(y + k) + first, window, ry * ux - offset * uy, ry * uy + offset * ux);
+    }
+}
+
+void CoverageMask::addRamp(int y, int x, int count, int32_t distance, int32_t step, int32_t limit) {
+    if (count <= 0) {
+        return;
+    }
+    touch(x, y, x + count - 1, y);
+    uint8_t* values = row(y) + x;
+    int i = 0;
+#ifdef GRAPH_HAVE_SSE2
+    // Как в addSteepLine, расстояния в 16-битных полях в единицах 1/255 пикселя: 8 покрытий за команду.
+    // Расстояние до каждой восьмёрки пикселей считается заново в 32 битах, поэтому ошибка округления не копится
+    const int32_t kWordLimit = 1 << 22;
+    int64_t lastDistance = distance - static_cast<int64_t>(step) * (count - 1);
+    if (limit < kWordLimit && std::abs(distance) < kWordLimit && std::abs(lastDistance) < kWordLimit) {
+        const __m128i limits = _mm_set1_epi16(static_cast<int16_t>(limit >> 8));
+        int16_t laneOffsets[8];
+        for (int lane = 0; lane < 8; ++lane) {
+            laneOffsets[lane] = static_cast<int16_t>((lane * step + 128) >> 8);
+        }
+        const __m128i offsets = _mm_loadu_si128(reinterpret_cast<const __m128i*>(laneOffsets));
+        for (; i + 8 <= count; i += 8) {
+            __m128i value = rampWords(_mm_set1_epi16(static_cast<int16_t>((distance - i * step + 128) >> 8)), offsets, limits);
+            value = _mm_packus_epi16(value, value);
+            __m128i previous = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(values + i), _mm_max_epu8(value, previous));
+        }
+    }
+#endif
+    RampCoverage(step, limit).add(values + i, count - i, distance - i * step);
+}
+
+void CoverageMask::addSteepLine(int y, int rows, int window, int64_t center, int64_t slope,
+    int64_t halfWidth, int32_t step, int32_t limit) {
+    if (rows <= 0) {
+        return;
+    }
+    // Окно сдвигается монотонно: прямоугольник задают первая и последняя строки
+    int64_t firstStart = (center - halfWidth + 0xFFFF) >> 16;
+    int64_t lastStart = (center + slope * (rows - 1) - halfWidth + 0xFFFF) >> 16;
+    touch(static_cast<int>(std::min(firstStart, lastStart)), y, static_cast<int>(std::max(firstStart, lastStart)) + window - 1, y + rows - 1);
+#ifdef GRAPH_HAVE_SSE2
+    // Окна не длиннее 64 пикселей, поэтому расстояния умещаются в 16 бит в единицах 1/255 пикселя
+    // (limit и distance делятся на 256, смещения пикселей i * step округляются точно): 8 покрытий
+    // считаются одной командой. Покрытия отличаются от addRamp не больше чем на 1
+    const __m128i limits = _mm_set1_epi16(static_cast<int16_t>(limit >> 8));
+    int16_t laneOffsets[8];
+    for (int i = 0; i < 8; ++i) {
+        laneOffsets[i] = static_cast<int16_t>(((i & (window == 4 ? 3 : 7)) * step + 128) >> 8);
+    }
+    const __m128i offsets = _mm_loadu_si128(reinterpret_cast<const __m128i*>(laneOffsets));
+    const int32_t chunkStep = (8 * step + 128) >> 8;
+    const __m128i chunkOffset = _mm_set1_epi16(static_cast<int16_t>(chunkStep));
+    // Строки адресуются от начала окна; указатели на строки и ширина держатся в регистрах
+    const size_t stride = static_cast<size_t>(m_width);
+    uint8_t* line = row(y);
+    // Окна шириной 4 и кратные 8 до 32 пикселей рисуются по четыре строки за шаг
+    const int64_t kCenterLimit = int64_t(1) << 30;
+    int64_t lastCenter = center + slope * (rows - 1);
+    if ((window == 4 || (window % 8 == 0 && window <= 32)) && std::max(std::abs(center), std::abs(lastCenter)) < kCenterLimit) {
+        if (window == 4) {
+            addSteepRowsByFour<4>(line, stride, rows, 0, static_cast<int32_t>(center), static_cast<int32_t>(slope),
+                static_cast<int32_t>(halfWidth), step, offsets, chunkOffset, limits);
+        }
+        else if (window == 8) {
+            addSteepRowsByFour<8>(line, stride, rows, 1, static_cast<int32_t>(center), static_cast<int32_t>(slope),
+                static_cast<int32_t>(halfWidth), step, offsets, chunkOffset, limits);
+        }
+        else {
+            addSteepRowsByFour<16>(line, stride, rows, window / 8, static_cast<int32_t>(center), static_cast<int32_t>(slope),
+                static_cast<int32_t>(halfWidth), step, offsets, chunkOffset, limits);
+        }
+        return;
+    }
+    for (int k = 0; k < rows; ++k, center += slope, line += stride) {
+        int64_t first = (center - halfWidth + 0xFFFF) >> 16; // ceil(center - halfWidth)
+        int distance = static_cast<int>(((center - (first << 16)) * step + (1 << 23)) >> 24);
+        uint8_t* values = line + first;
+        for (int i = 0; i < window; i += 8, distance -= chunkStep) {
+            __m128i value = rampWords(_mm_set1_epi16(static_cast<int16_t>(distance)), offsets, limits);
+            value = _mm_packus_epi16(value, value);
+            if (i + 8 <= window) {
+                __m128i previous = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(values + i), _mm_max_epu8(value, previous));
+            }
+            else {
+                storeFour(values + i, _mm_max_epu8(value, loadFour(values + i)));
+            }
+        }
+    }
+#else
+    RampCoverage ramp(step, limit);
+    for (int k = 0; k < rows; ++k, center += slope) {
+        int64_t first = (center - halfWidth + 0xFFFF) >> 16; // ceil(center - halfWidth)
+        int32_t distance = static_cast<int32_t>(((center - (first << 16)) * step) >> 16);
+        ramp.add(row(y + k) + first, window, distance);
+    }
+#endif
+}
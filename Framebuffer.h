@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Цвет 0xAARRGGBB: в памяти байты идут как B, G, R, A — в том же порядке, что и пиксели BMP
+typedef uint32_t Color;
+
+inline Color makeColor(uint8_t red, uint8_t green, uint8_t blue) {
+    return 0xFF000000u | (static_cast<uint32_t>(red) << 16) | (static_cast<uint32_t>(green) << 8) | blue;
+}
+
+const Color kBlack = 0xFF000000u;
+const Color kWhite = 0xFFFFFFFFu;
+
+// Маска покрытий 0..255 для полосы из rows строк шириной width, начиная со строки top буфера кадра.
+// Фигуры одного цвета сначала рисуются в маску: покрытия объединяются максимумом, поэтому в местах
+// наложения рёбра не темнеют, — а затем маска смешивается с буфером одним проходом (Framebuffer::blendMask).
+// Покрытия фигур считаются в целых числах: clamp((limit - |distance|) >> 8, 0, 255), где distance — расстояние
+// от оси линии, меняющееся на step за пиксель строки. Маска помнит прямоугольник, в котором могут быть
+// ненулевые покрытия; clear обнуляет только его
+class CoverageMask {
+public:
+    CoverageMask();
+
+    // Маска width x rows для строк буфера кадра, начиная с top; все покрытия нулевые
+    void reset(int width, int top, int rows);
+    void clear();
+
+    int width() const { return m_width; }
+    int top() const { return m_top; }
+    int rows() const { return m_rows; }
+    bool empty() const { return m_x0 > m_x1; }
+    // Прямоугольник ненулевых покрытий: столбцы [x0, x1] и строки [y0, y1] включительно
+    int boundsX0() const { return m_x0; }
+    int boundsX1() const { return m_x1; }
+    int boundsY0() const { return m_y0; }
+    int boundsY1() const { return m_y1; }
+
+    const uint8_t* row(int y) const { return m_values.data() + static_cast<size_t>(y - m_top) * m_width; }
+
+    // Покрытия отрезка шириной 2 * reach - 1 и длиной length для count пикселей строки y, начиная с x:
+    // пиксель i получает clamp(reach - |across - i * acrossStep|) * clamp(a + 0.5) * clamp(length - a + 0.5),
+    // a = along + i * alongStep (clamp — к отрезку [0, 1]). Пиксели должны лежать внутри маски
+    void addSegmentSpan(int y, int x, int count, float across, float acrossStep, float along, float alongStep,
+        float reach, float length);
+
+    // Строки у концов отрезка из (originX, originY) с направлением (ux, uy): окна строк выбираются как
+    // в addSteepLine, покрытия пикселей окон — как в addSegmentSpan
+    void addSegmentWindows(int y, int rows, int window, int64_t center, int64_t slope, int64_t halfWidth,
+        int originX, int originY, float ux, float uy, float reach, float length);
+
+    // Покрытия clamp((limit - |distance - i * step|) >> 8, 0, 255) для count пикселей строки y, начиная с x
+    // (с SSE2 расстояния округляются до 1/255 пикселя, и покрытия могут отличаться на 1)
+    void addRamp(int y, int x, int count, int32_t distance, int32_t step, int32_t limit);
+
+    // Крутая линия: в rows строках, начиная с y, покрывается окно из window пикселей (4 или кратно 8), начинающееся
+    // с ceil(center - halfWidth), где center — x оси в строке (фиксированная точка 16.16, растёт на slope
+    // за строку). Покрытия — как в addRamp с distance от оси до первого пикселя окна. Все окна
+    // должны лежать внутри маски
+    void addSteepLine(int y, int rows, int window, int64_t center, int64_t slope, int64_t halfWidth,
+        int32_t step, int32_t limit);
+
+private:
+    uint8_t* row(int y) { return m_values.data() + static_cast<size_t>(y - m_top) * m_width; }
+    void touch(int x0, int y0, int x1, int y1);
+
+    int m_width;
+    int m_top;
+    int m_rows;
+    int m_x0, m_y0, m_x1, m_y1;
+    std::vector<uint8_t> m_values;
+};
+
+// Цветной буфер кадра: 32 бита на пиксель, строки подряд в одном буфере.
+// Смешивание по покрытию 0..255: result = (color * a + pixel * (255 - a)) / 255 с округлением;
+// при наличии SSE2 четыре пикселя смешиваются одной командой, результат совпадает со скалярным.
+class Framebuffer {
+public:
+    Framebuffer();
+    Framebuffer(int width, int height);
+
+    // Изменение размера с заливкой цветом фона
+    void reset(int width, int height, Color background = kWhite);
+    void clear(Color background = kWhite);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    size_t memoryBytes() const { return m_pixels.size() * sizeof(Color); }
+
+    Color* row(int y) { return m_pixels.data() + static_cast<size_t>(y) * m_width; }
+    const Color* row(int y) const { return m_pixels.data() + static_cast<size_t>(y) * m_width; }
+
+    // Непрозрачная заливка отрезка строки y от x0 до x1 включительно (с отсечением по границам)
+    void fillSpan(int y, int x0, int x1, Color color);
+
+    // Смешивание count пикселей строки y, начиная с x, с цветом color по покрытиям coverage[i];
+    // отрезок должен лежать внутри буфера
+    void blendSpan(int y, int x, int count, Color color, const uint8_t* coverage);
+
+    // Смешивание с цветом color по маске покрытий (см. CoverageMask) в пределах её прямоугольника
+    // и строк [y0, y1). Пиксели с покрытием 255 записываются без смешивания, группы с нулевым
+    // покрытием пропускаются
+    void blendMask(const CoverageMask& mask, Color color, int y0, int y1);
+    void blendMask(const CoverageMask& mask, Color color) { blendMask(mask, color, mask.top(), mask.top() + mask.rows()); }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<Color> m_pixels;
+};
+
+// Полутоновое изображение: 8 бит на пиксель (0 — чёрный, 255 — белый), строки подряд в одном буфере
+class GrayImage {
+public:
+    GrayImage() : m_width(0), m_height(0) {}
+
+    void reset(int width, int height, uint8_t background = 255) {
+        m_width = width > 0 ? width : 0;
+        m_height = height > 0 ? height : 0;
+        m_pixels.assign(static_cast<size_t>(m_width) * m_height, background);
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    size_t memoryBytes() const { return m_pixels.size(); }
+
+    uint8_t* row(int y) { return m_pixels.data() + static_cast<size_t>(y) * m_width; }
+    const uint8_t* row(int y) const { return m_pixels.data() + static_cast<size_t>(y) * m_width; }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint8_t> m_pixels;
+};
@@ -0,0 +1,144 @@
+#include "GraphGenerators.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace {
+
+// Равномерно случайное число из [0, bound) (bound > 0); смещение от взятия остатка для размеров графов пренебрежимо мало
+inline size_t randomBelow(std::mt19937_64& random, size_t bound) {
+    return static_cast<size_t>(random() % bound);
+}
+
+// k различных случайных вершин
+std::vector<size_t> pickDistinct(size_t numVertices, size_t k, unsigned seed) {
+    std::mt19937_64 random(seed);
+    std::vector<size_t> picked;
+    while (picked.size() < k) {
+        size_t v = randomBelow(random, numVertices);
+        if (std::find(picked.begin(), picked.end(), v) == picked.end()) {
+            picked.push_back(v);
+        }
+    }
+    return picked;
+}
+
+} // namespace
+
+void generateRandomGraph(size_t numVertices, size_t numEdges, unsigned seed, std::vector<Edge>& edges) {
+    if (numVertices == 0) {
+        return;
+    }
+    std::mt19937_64 random(seed);
+    edges.reserve(edges.size() + numEdges);
+    for (size_t i = 0; i < numEdges; ++i) {
+        size_t v1 = randomBelow(random, numVertices);
+        size_t v2 = randomBelow(random, numVertices);
+        edges.push_back({ v1, v2 });
+    }
+}
+
+void generateGridGraph(size_t columns, size_t rows, std::vector<Edge>& edges) {
+    edges.reserve(edges.size() + 2 * columns * rows);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t column = 0; column < columns; ++column) {
+            size_t v = row * columns + column;
+            if (column + 1 < columns) {
+                edges.push_back({ v, v + 1 });
+            }
+            if (row + 1 < rows) {
+                edges.push_back({ v, v + columns });
+            }
+        }
+    }
+}
+
+void generateTriangulation(size_t numVertices, unsigned seed, std::vector<Edge>& edges) {
+    if (numVertices < 3) {
+        if (numVertices == 2) {
+            edges.push_back({ 0, 1 });
+        }
+        return;
+    }
+    std::mt19937_64 random(seed);
+    edges.reserve(edges.size() + 3 * numVertices - 6);
+    edges.push_back({ 0, 1 });
+    edges.push_back({ 1, 2 });
+    edges.push_back({ 2, 0 });
+
+    // Грани по три вершины; внешняя грань 0-1-2 тоже делится, поэтому граф остаётся триангуляцией сферы.
+    // Новая вершина заменяет выбранную грань одной из трёх новых и дописывает две остальные
+    std::vector<uint32_t> faces = { 0, 1, 2, 0, 2, 1 };
+    faces.reserve(6 * numVertices);
+    for (size_t v = 3; v < numVertices; ++v) {
+        size_t face = randomBelow(random, faces.size() / 3) * 3;
+        uint32_t a = faces[face], b = faces[face + 1], c = faces[face + 2];
+        uint32_t n = static_cast<uint32_t>(v);
+        edges.push_back({ a, v });
+        edges.push_back({ b, v });
+        edges.push_back({ c, v });
+        faces[face + 2] = n;
+        faces.insert(faces.end(), { b, c, n, c, a, n });
+    }
+}
+
+void generatePowerLawGraph(size_t numVertices, size_t edgesPerVertex, unsigned seed, std::vector<Edge>& edges) {
+    if (numVertices < 2 || edgesPerVertex == 0) {
+        return;
+    }
+    std::mt19937_64 random(seed);
+    edges.reserve(edges.size() + numVertices * edgesPerVertex);
+    // Каждый конец каждого ребра записан в ends, поэтому случайный элемент ends — вершина,
+    // выбранная с вероятностью, пропорциональной степени
+    std::vector<uint32_t> ends = { 0, 1 };
+    ends.reserve(2 * numVertices * edgesPerVertex + 2);
+    edges.push_back({ 0, 1 });
+    for (size_t v = 2; v < numVertices; ++v) {
+        size_t count = std::min(edgesPerVertex, v);
+        size_t degreeTotal = ends.size(); // Новые рёбра вершины v не влияют на выбор её же соседей
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t target = ends[randomBelow(random, degreeTotal)];
+            edges.push_back({ v, target });
+            ends.push_back(static_cast<uint32_t>(v));
+            ends.push_back(target);
+        }
+    }
+}
+
+std::vector<size_t> plantK5(size_t numVertices, unsigned seed, std::vector<Edge>& edges) {
+    if (numVertices < 5) {
+        return std::vector<size_t>();
+    }
+    std::vector<size_t> vertices = pickDistinct(numVertices, 5, seed);
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = i + 1; j < 5; ++j) {
+            edges.push_back({ vertices[i], vertices[j] });
+        }
+    }
+    return vertices;
+}
+
+std::vector<size_t> plantK33(size_t numVertices, unsigned seed, std::vector<Edge>& edges) {
+    if (numVertices < 6) {
+        return std::vector<size_t>();
+    }
+    std::vector<size_t> vertices = pickDistinct(numVertices, 6, seed);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 3; j < 6; ++j) {
+            edges.push_back({ vertices[i], vertices[j] });
+        }
+    }
+    return vertices;
+}
+
+void placeVertices(size_t numVertices, int width, int height, unsigned seed, std::vector<Vertex>& vertices, bool withLabels) {
+    std::mt19937_64 random(seed);
+    vertices.reserve(vertices.size() + numVertices);
+    for (size_t i = 0; i < numVertices; ++i) {
+        int x = static_cast<int>(randomBelow(random, static_cast<size_t>(std::max(width, 1))));
+        int y = static_cast<int>(randomBelow(random, static_cast<size_t>(std::max(height, 1))));
+        vertices.push_back({ x, y, withLabels ? std::to_string(i) : std::string() });
+    }
+}
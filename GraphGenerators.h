@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Vertex.h"
+#include "Edge.h"
+
+// Детерминированные генераторы синтетических графов: одинаковое зерно — одинаковый граф на любой платформе
+// (используется только std::mt19937 без распределений стандартной библиотеки). Рёбра дописываются в конец edges,
+// номера вершин — от 0 до numVertices - 1
+
+// Случайные рёбра: numEdges пар равномерно случайных вершин; петли и повторы возможны, как во входных файлах
+void generateRandomGraph(size_t numVertices, size_t numEdges, unsigned seed, std::vector<Edge>& edges);
+
+// Решётка columns x rows: вершина row * columns + column соединена с правым и с нижним соседом
+void generateGridGraph(size_t columns, size_t rows, std::vector<Edge>& edges);
+
+// Максимальная планарная триангуляция с 3V - 6 рёбрами (при V >= 3): каждая следующая вершина
+// вставляется в случайную треугольную грань и соединяется с тремя её вершинами
+void generateTriangulation(size_t numVertices, unsigned seed, std::vector<Edge>& edges);
+
+// Степенной граф предпочтительного присоединения (Барабаши–Альберт): каждая следующая вершина
+// соединяется с edgesPerVertex вершинами, выбранными с вероятностью, пропорциональной степени
+void generatePowerLawGraph(size_t numVertices, size_t edgesPerVertex, unsigned seed, std::vector<Edge>& edges);
+
+// Вставка K5 или K3,3 на случайные различные вершины (нужно не меньше 5 или 6 вершин).
+// Возвращаются выбранные вершины; у K3,3 первые три — одна доля, последние три — другая
+std::vector<size_t> plantK5(size_t numVertices, unsigned seed, std::vector<Edge>& edges);
+std::vector<size_t> plantK33(size_t numVertices, unsigned seed, std::vector<Edge>& edges);
+
+// Вершины со случайными координатами на холсте width x height и метками-номерами
+void placeVertices(size_t numVertices, int width, int height, unsigned seed, std::vector<Vertex>& vertices, bool withLabels = true);
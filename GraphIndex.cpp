@@ -0,0 +1,131 @@
+#include "GraphIndex.h"
+
+#include <algorithm>
+#include "Profiler.h"
+
+const size_t GraphIndex::kDenseMatrixLimit;
+
+GraphIndex::GraphIndex() : m_matrixStride(0), m_numEdges(0) {}
+
+GraphIndex::GraphIndex(size_t numVertices, const std::vector<Edge>& edges, bool denseMatrix)
+    : m_matrixStride(0), m_numEdges(0) {
+    build(numVertices, edges, denseMatrix);
+}
+
+GraphIndex::GraphIndex(size_t numVertices, const std::vector<uint32_t>& endpoints, bool denseMatrix)
+    : m_matrixStride(0), m_numEdges(0) {
+    build(numVertices, endpoints, denseMatrix);
+}
+
+void GraphIndex::build(size_t numVertices, const std::vector<Edge>& edges, bool denseMatrix) {
+    buildFrom(numVertices, edges.size(), [&](size_t i, size_t& a, size_t& b) {
+        a = edges[i].vertex1;
+        b = edges[i].vertex2;
+    }, denseMatrix);
+}
+
+void GraphIndex::build(size_t numVertices, const std::vector<uint32_t>& endpoints, bool denseMatrix) {
+    buildFrom(numVertices, endpoints.size() / 2, [&](size_t i, size_t& a, size_t& b) {
+        a = endpoints[2 * i];
+        b = endpoints[2 * i + 1];
+    }, denseMatrix);
+}
+
+template <typename EdgeAt>
+void GraphIndex::buildFrom(size_t numVertices, size_t numEdges, EdgeAt edgeAt, bool denseMatrix) {
+    GRAPH_PROFILE_SCOPE("index.build");
+    // Первый проход: раскладываем ориентированные пары по второй вершине (сортировка подсчётом),
+    // второй проход: устойчиво раскладываем их по первой вершине — списки соседей получаются отсортированными
+    std::vector<uint32_t> count(numVertices + 1, 0);
+    for (size_t i = 0; i < numEdges; ++i) {
+        size_t a, b;
+        edgeAt(i, a, b);
+        if (a < numVertices && b < numVertices) {
+            ++count[a + 1];
+            if (a != b) {
+                ++count[b + 1];
+            }
+        }
+    }
+    for (size_t v = 0; v < numVertices; ++v) {
+        count[v + 1] += count[v];
+    }
+    const size_t total = count[numVertices];
+
+    std::vector<uint32_t> bySecond(total); // Первые вершины пар, упорядоченные по второй вершине
+    std::vector<uint32_t> secondOf(total);
+    {
+        std::vector<uint32_t> fill(count.begin(), count.end() - 1);
+        for (size_t i = 0; i < numEdges; ++i) {
+            size_t first, second;
+            edgeAt(i, first, second);
+            if (first < numVertices && second < numVertices) {
+                uint32_t a = static_cast<uint32_t>(first);
+                uint32_t b = static_cast<uint32_t>(second);
+                bySecond[fill[b]] = a;
+                secondOf[fill[b]++] = b;
+                if (a != b) {
+                    bySecond[fill[a]] = b;
+                    secondOf[fill[a]++] = a;
+                }
+            }
+        }
+    }
+
+    m_offsets.assign(count.begin(), count.end());
+    std::vector<uint32_t> neighbors(total);
+    {
+        std::vector<uint32_t> fill(count.begin(), count.end() - 1);
+        for (size_t i = 0; i < total; ++i) {
+            neighbors[fill[bySecond[i]]++] = secondOf[i];
+        }
+    }
+
+    // Удаление повторов внутри отсортированных списков
+    m_neighbors.clear();
+    m_neighbors.reserve(total);
+    size_t loops = 0;
+    for (size_t v = 0; v < numVertices; ++v) {
+        uint32_t begin = count[v];
+        uint32_t end = count[v + 1];
+        m_offsets[v] = static_cast<uint32_t>(m_neighbors.size());
+        for (uint32_t i = begin; i < end; ++i) {
+            if (i == begin || neighbors[i] != neighbors[i - 1]) {
+                m_neighbors.push_back(neighbors[i]);
+                if (neighbors[i] == v) {
+                    ++loops;
+                }
+            }
+        }
+    }
+    m_offsets[numVertices] = static_cast<uint32_t>(m_neighbors.size());
+    m_numEdges = (m_neighbors.size() - loops) / 2 + loops;
+
+    // Плотная битовая матрица для небольших графов
+    m_matrix.clear();
+    m_matrixStride = 0;
+    if (denseMatrix && numVertices <= kDenseMatrixLimit) {
+        m_matrixStride = (numVertices + 63) / 64;
+        m_matrix.assign(m_matrixStride * numVertices, 0);
+        for (size_t v = 0; v < numVertices; ++v) {
+            for (const uint32_t* w = neighborsBegin(v); w != neighborsEnd(v); ++w) {
+                m_matrix[v * m_matrixStride + (*w >> 6)] |= uint64_t(1) << (*w & 63);
+            }
+        }
+    }
+}
+
+bool GraphIndex::hasEdge(size_t v1, size_t v2) const {
+    GRAPH_PROFILE_COUNT("edge.lookups", 1);
+    if (v1 >= numVertices() || v2 >= numVertices()) {
+        return false;
+    }
+    if (!m_matrix.empty()) {
+        return (m_matrix[v1 * m_matrixStride + (v2 >> 6)] >> (v2 & 63)) & 1;
+    }
+    // Двоичный поиск в более коротком из двух списков
+    if (degree(v1) > degree(v2)) {
+        std::swap(v1, v2);
+    }
+    return std::binary_search(neighborsBegin(v1), neighborsEnd(v1), static_cast<uint32_t>(v2));
+}
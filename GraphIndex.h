@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Edge.h"
+
+// Индекс смежности графа в формате CSR (compressed sparse row).
+// Строится один раз по списку рёбер; списки соседей отсортированы и не содержат повторов.
+// Для небольших графов дополнительно хранится плотная битовая матрица смежности,
+// поэтому проверка ребра выполняется за O(1), иначе — двоичным поиском за O(log d).
+class GraphIndex {
+public:
+    // Максимальное число вершин, при котором строится битовая матрица (4096^2 бит = 2 МБ)
+    static const size_t kDenseMatrixLimit = 4096;
+
+    GraphIndex();
+    GraphIndex(size_t numVertices, const std::vector<Edge>& edges, bool denseMatrix = true);
+    GraphIndex(size_t numVertices, const std::vector<uint32_t>& endpoints, bool denseMatrix = true);
+
+    // Перестроение индекса; рёбра с несуществующими вершинами пропускаются
+    void build(size_t numVertices, const std::vector<Edge>& edges, bool denseMatrix = true);
+    // То же по концам рёбер, записанным подряд парами (как GraphStorage::endpoints)
+    void build(size_t numVertices, const std::vector<uint32_t>& endpoints, bool denseMatrix = true);
+
+    size_t numVertices() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+    size_t numEdges() const { return m_numEdges; } // Число различных неориентированных рёбер
+    size_t degree(size_t v) const { return m_offsets[v + 1] - m_offsets[v]; }
+    const uint32_t* neighborsBegin(size_t v) const { return m_neighbors.data() + m_offsets[v]; }
+    const uint32_t* neighborsEnd(size_t v) const { return m_neighbors.data() + m_offsets[v + 1]; }
+
+    bool hasEdge(size_t v1, size_t v2) const;
+
+private:
+    // edgeAt(i, a, b) записывает концы ребра i
+    template <typename EdgeAt>
+    void buildFrom(size_t numVertices, size_t numEdges, EdgeAt edgeAt, bool denseMatrix);
+
+    std::vector<uint32_t> m_offsets; // Начало списка соседей каждой вершины (numVertices + 1)
+    std::vector<uint32_t> m_neighbors; // Отсортированные списки соседей
+    std::vector<uint64_t> m_matrix; // Битовая матрица смежности (пустая для больших графов)
+    size_t m_matrixStride; // Число 64-битных слов в строке матрицы
+    size_t m_numEdges;
+};
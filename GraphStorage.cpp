@@ -0,0 +1,79 @@
+#include "GraphStorage.h"
+
+#include <algorithm>
+
+GraphStorage::GraphStorage(const std::vector<Vertex>& vertices, const std::vector<Edge>& edges) : m_labelOffsets(1, 0) {
+    appendEdges(edges);
+    appendVertices(vertices);
+}
+
+GraphStorage::GraphStorage(std::vector<Vertex>&& vertices, std::vector<Edge>&& edges) : m_labelOffsets(1, 0) {
+    appendEdges(edges);
+    std::vector<Edge>().swap(edges);
+    appendVertices(vertices);
+    std::vector<Vertex>().swap(vertices);
+}
+
+void GraphStorage::appendEdges(const std::vector<Edge>& edges) {
+    m_endpoints.reserve(m_endpoints.size() + 2 * edges.size());
+    for (const Edge& edge : edges) {
+        addEdge(static_cast<uint32_t>(std::min<size_t>(edge.vertex1, UINT32_MAX)),
+            static_cast<uint32_t>(std::min<size_t>(edge.vertex2, UINT32_MAX)));
+    }
+}
+
+void GraphStorage::appendVertices(const std::vector<Vertex>& vertices) {
+    size_t labelBytes = 0;
+    for (const Vertex& vertex : vertices) {
+        labelBytes += vertex.label.size();
+    }
+    reserve(vertexCount() + vertices.size(), 0, m_labels.size() + labelBytes);
+    for (const Vertex& vertex : vertices) {
+        addVertex(vertex.x, vertex.y, vertex.label);
+    }
+}
+
+void GraphStorage::reserve(size_t vertices, size_t edges, size_t labelBytes) {
+    m_x.reserve(vertices);
+    m_y.reserve(vertices);
+    m_labelOffsets.reserve(vertices + 1);
+    m_labels.reserve(labelBytes);
+    m_endpoints.reserve(2 * edges);
+}
+
+uint32_t GraphStorage::addVertex(int x, int y, const char* label, size_t length) {
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_labels.insert(m_labels.end(), label, label + length);
+    m_labelOffsets.push_back(static_cast<uint32_t>(m_labels.size()));
+    return static_cast<uint32_t>(m_x.size() - 1);
+}
+
+void GraphStorage::setIndexLabels() {
+    const size_t n = vertexCount();
+    // Длина всех номеров: по символу на каждую вершину и ещё по одному на каждую с номером от 10, от 100 и т. д.
+    size_t labelBytes = n;
+    for (size_t power = 10; power < n; power *= 10) {
+        labelBytes += n - power;
+    }
+    m_labels.clear();
+    m_labels.reserve(labelBytes);
+    char digits[20];
+    for (size_t v = 0; v < n; ++v) {
+        size_t length = 0;
+        size_t value = v;
+        do {
+            digits[length++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        for (size_t i = length; i > 0; --i) {
+            m_labels.push_back(digits[i - 1]);
+        }
+        m_labelOffsets[v + 1] = static_cast<uint32_t>(m_labels.size());
+    }
+}
+
+size_t GraphStorage::memoryBytes() const {
+    return (m_x.capacity() + m_y.capacity()) * sizeof(int32_t) + m_labelOffsets.capacity() * sizeof(uint32_t) +
+        m_labels.capacity() + m_endpoints.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Vertex.h"
+#include "Edge.h"
+
+// Компактное хранилище графа для отрисовки. Вершины хранятся столбцами: координаты x и y — отдельные
+// массивы int32, метки — подряд в одном буфере символов со смещениями; рёбра — парами 32-битных
+// номеров концов. Каждый массив занимает один непрерывный блок памяти, поэтому вершина стоит
+// 12 байт и символы метки вместо 40 байт Vertex (координаты и std::string), а ребро — 8 байт вместо 16.
+// Число вершин и общая длина меток ограничены 2^32 - 1
+class GraphStorage {
+public:
+    GraphStorage() : m_labelOffsets(1, 0) {}
+    // Перенос из векторов Vertex и Edge. Переданные перемещением векторы освобождаются, как только
+    // их данные перенесены, поэтому обе формы графа не лежат в памяти целиком одновременно.
+    // Номера концов рёбер, не помещающиеся в 32 бита, заменяются на UINT32_MAX (несуществующая вершина)
+    GraphStorage(const std::vector<Vertex>& vertices, const std::vector<Edge>& edges);
+    GraphStorage(std::vector<Vertex>&& vertices, std::vector<Edge>&& edges);
+
+    void reserve(size_t vertices, size_t edges, size_t labelBytes);
+    // Добавление вершин и рёбер в конец хранилища
+    void appendVertices(const std::vector<Vertex>& vertices);
+    void appendEdges(const std::vector<Edge>& edges);
+
+    // Новая вершина; возвращает её номер
+    uint32_t addVertex(int x, int y, const char* label, size_t length);
+    uint32_t addVertex(int x, int y, const std::string& label) { return addVertex(x, y, label.data(), label.size()); }
+    // Замена всех меток десятичными номерами вершин
+    void setIndexLabels();
+
+    size_t vertexCount() const { return m_x.size(); }
+    int x(size_t v) const { return m_x[v]; }
+    int y(size_t v) const { return m_y[v]; }
+    void setPosition(size_t v, int x, int y) {
+        m_x[v] = x;
+        m_y[v] = y;
+    }
+    // Символы метки (без завершающего нуля) и их число
+    const char* label(size_t v) const { return m_labels.data() + m_labelOffsets[v]; }
+    size_t labelLength(size_t v) const { return m_labelOffsets[v + 1] - m_labelOffsets[v]; }
+
+    size_t edgeCount() const { return m_endpoints.size() / 2; }
+    uint32_t vertex1(size_t e) const { return m_endpoints[2 * e]; }
+    uint32_t vertex2(size_t e) const { return m_endpoints[2 * e + 1]; }
+    Edge edge(size_t e) const {
+        Edge result = { vertex1(e), vertex2(e) };
+        return result;
+    }
+    // Концы всех рёбер подряд: vertex1 и vertex2 ребра e лежат на местах 2e и 2e + 1
+    const std::vector<uint32_t>& endpoints() const { return m_endpoints; }
+    void addEdge(uint32_t v1, uint32_t v2) {
+        m_endpoints.push_back(v1);
+        m_endpoints.push_back(v2);
+    }
+    void setEdge(size_t e, uint32_t v1, uint32_t v2) {
+        m_endpoints[2 * e] = v1;
+        m_endpoints[2 * e + 1] = v2;
+    }
+    void removeLastEdge() { m_endpoints.resize(m_endpoints.size() - 2); }
+
+    // Память под массивы хранилища (по выделенной ёмкости)
+    size_t memoryBytes() const;
+
+private:
+    std::vector<int32_t> m_x;
+    std::vector<int32_t> m_y;
+    std::vector<uint32_t> m_labelOffsets; // Начало метки каждой вершины в m_labels (vertexCount() + 1)
+    std::vector<char> m_labels;
+    std::vector<uint32_t> m_endpoints;
+};
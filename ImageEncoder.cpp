@@ -0,0 +1,47 @@
+#include "ImageEncoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include "BMPEncoder.h"
+#include "PNGEncoder.h"
+
+std::unique_ptr<ImageEncoder> createImageEncoder(ImageFormat format, ThreadPool* pool) {
+    switch (format) {
+    case ImageFormat::BmpRle8:
+        return std::unique_ptr<ImageEncoder>(new BMPRle8Encoder(pool));
+    case ImageFormat::Png:
+        return std::unique_ptr<ImageEncoder>(new PNGEncoder(pool));
+    default:
+        return std::unique_ptr<ImageEncoder>(new BMPEncoder(BMPFormat::Rgb24));
+    }
+}
+
+bool parseImageFormat(const std::string& name, ImageFormat& format) {
+    if (name == "bmp") {
+        format = ImageFormat::Bmp;
+    }
+    else if (name == "rle8") {
+        format = ImageFormat::BmpRle8;
+    }
+    else if (name == "png") {
+        format = ImageFormat::Png;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+const char* imageFormatExtension(ImageFormat format) {
+    return format == ImageFormat::Png ? "png" : "bmp";
+}
+
+ImageFormat imageFormatForFile(const std::string& filename) {
+    size_t dot = filename.rfind('.');
+    if (dot == std::string::npos) {
+        return ImageFormat::Bmp;
+    }
+    std::string extension = filename.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "png" ? ImageFormat::Png : ImageFormat::Bmp;
+}
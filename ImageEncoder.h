@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include <ostream>
+#include <string>
+#include "Bitmap.h"
+#include "Framebuffer.h"
+#include "ThreadPool.h"
+
+// Формат выходного файла изображения
+enum class ImageFormat {
+    Bmp, // Несжатый BMP (BMPEncoder)
+    BmpRle8, // BMP с палитрой и сжатием RLE8 (BMPRle8Encoder)
+    Png // PNG со сжатием deflate (PNGEncoder)
+};
+
+// Кодировщик готового изображения в файл одного формата: заголовок и данные за один вызов.
+// Изображения — монохромная битовая карта (установленный бит — чёрный пиксель), цветной буфер
+// кадра и полутоновое изображение. Возвращает false при ошибке записи или если изображение
+// нельзя записать в этом формате (сообщение выводится в std::cerr)
+class ImageEncoder {
+public:
+    virtual ~ImageEncoder() {}
+
+    virtual bool encode(std::ostream& file, const Bitmap& bitmap) = 0;
+    virtual bool encode(std::ostream& file, const Framebuffer& framebuffer) = 0;
+    virtual bool encode(std::ostream& file, const GrayImage& image) = 0;
+};
+
+// Кодировщик формата format. Сжимающие кодировщики делят изображение на полосы и сжимают их
+// на pool; без пула полосы сжимаются в вызывающем потоке
+std::unique_ptr<ImageEncoder> createImageEncoder(ImageFormat format, ThreadPool* pool = nullptr);
+
+// Имена форматов в командной строке: bmp, rle8, png; false для неизвестного имени
+bool parseImageFormat(const std::string& name, ImageFormat& format);
+// Расширение имени файла без точки
+const char* imageFormatExtension(ImageFormat format);
+// Формат по расширению имени файла: .png — PNG, остальные — несжатый BMP
+ImageFormat imageFormatForFile(const std::string& filename);
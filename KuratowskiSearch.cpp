@@ -0,0 +1,333 @@
+#include "KuratowskiSearch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "Profiler.h"
+
+namespace {
+
+int popCount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word != 0; word &= word - 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+int lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!((word >> bit) & 1)) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+// Порядок вырождения и номера ядер (алгоритм Батагеля–Заверсника, O(V + E)):
+// вершины снимаются по одной с наименьшей оставшейся степенью; position[v] — место v в этом порядке,
+// core[v] — наибольшее k, при котором v лежит в k-ядре. Петли в степени не учитываются.
+void coreDecomposition(const GraphIndex& index, std::vector<uint32_t>& position, std::vector<uint32_t>& core) {
+    const size_t n = index.numVertices();
+    std::vector<uint32_t>& degree = core; // Оставшиеся степени становятся номерами ядер
+    degree.assign(n, 0);
+    uint32_t maxDegree = 0;
+    for (size_t v = 0; v < n; ++v) {
+        for (const uint32_t* u = index.neighborsBegin(v); u != index.neighborsEnd(v); ++u) {
+            degree[v] += *u != v;
+        }
+        maxDegree = std::max(maxDegree, degree[v]);
+    }
+
+    // Вершины, отсортированные по степени подсчётом; binStart[d] — начало вершин степени d
+    std::vector<uint32_t> binStart(maxDegree + 2, 0), order(n);
+    position.assign(n, 0);
+    for (size_t v = 0; v < n; ++v) {
+        ++binStart[degree[v] + 1];
+    }
+    for (uint32_t d = 0; d <= maxDegree; ++d) {
+        binStart[d + 1] += binStart[d];
+    }
+    for (size_t v = 0; v < n; ++v) {
+        position[v] = binStart[degree[v]]++;
+        order[position[v]] = static_cast<uint32_t>(v);
+    }
+    for (uint32_t d = maxDegree + 1; d > 0; --d) {
+        binStart[d] = binStart[d - 1];
+    }
+    binStart[0] = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t v = order[i];
+        for (const uint32_t* it = index.neighborsBegin(v); it != index.neighborsEnd(v); ++it) {
+            uint32_t u = *it;
+            if (u == v || degree[u] <= degree[v]) {
+                continue;
+            }
+            // u переходит в корзину на единицу меньше: меняем его местами с первой вершиной своей корзины
+            uint32_t first = binStart[degree[u]];
+            uint32_t w = order[first];
+            if (w != u) {
+                std::swap(order[position[u]], order[first]);
+                std::swap(position[u], position[w]);
+            }
+            ++binStart[degree[u]];
+            --degree[u];
+        }
+    }
+}
+
+// Общая часть обоих поисков: ветви по вершинам в порядке вырождения, разбитые на части для пула,
+// флаг остановки и запись первого найденного результата
+class ParallelSearch {
+public:
+    ParallelSearch(const GraphIndex& index, ThreadPool& pool, uint32_t minCore)
+        : m_pool(pool), m_minCore(minCore), m_found(false) {
+        coreDecomposition(index, m_position, m_core);
+        m_order.resize(index.numVertices());
+        for (size_t v = 0; v < m_position.size(); ++v) {
+            m_order[m_position[v]] = static_cast<uint32_t>(v);
+        }
+    }
+
+    // branch(v, scratch) проверяет ветвь с первой вершиной v; scratch — массивы части размером V
+    template<typename Branch>
+    std::vector<size_t> run(Branch branch) {
+        const size_t n = m_order.size();
+        const size_t chunks = std::min(n, m_pool.size() * 16);
+        m_pool.run(chunks, [&](size_t chunk) {
+            Scratch scratch(n);
+            for (size_t i = n * chunk / chunks; i < n * (chunk + 1) / chunks && !m_found.load(std::memory_order_relaxed); ++i) {
+                uint32_t v = m_order[i];
+                if (m_core[v] >= m_minCore) {
+                    branch(v, scratch);
+                }
+            }
+        });
+        return m_result;
+    }
+
+    // Массивы части размером V: номера вершин в локальных наборах ветви (-1 — нет).
+    // Ветвь возвращает изменённые ячейки к -1, поэтому массивы выделяются один раз на часть
+    struct Scratch {
+        explicit Scratch(size_t n) : local(n, -1), other(n, -1) {}
+        std::vector<int32_t> local;
+        std::vector<int32_t> other;
+    };
+
+    bool stopped() const { return m_found.load(std::memory_order_relaxed); }
+
+    // Запись результата, если другой поток не успел раньше
+    void report(const std::vector<size_t>& vertices) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_found) {
+            m_result = vertices;
+            m_found = true;
+        }
+    }
+
+    // u стоит позже v в порядке вырождения и лежит в нужном ядре
+    bool isLater(uint32_t v, uint32_t u) const { return u != v && m_position[u] > m_position[v] && m_core[u] >= m_minCore; }
+    bool inCore(uint32_t u) const { return m_core[u] >= m_minCore; }
+
+private:
+    ThreadPool& m_pool;
+    uint32_t m_minCore;
+    std::vector<uint32_t> m_position;
+    std::vector<uint32_t> m_core;
+    std::vector<uint32_t> m_order;
+    std::atomic<bool> m_found;
+    std::mutex m_mutex;
+    std::vector<size_t> m_result;
+};
+
+} // namespace
+
+std::vector<size_t> findK5Clique(const GraphIndex& index, ThreadPool& pool) {
+    GRAPH_PROFILE_SCOPE("kuratowski.k5");
+    ParallelSearch search(index, pool, 4);
+
+    // Первая в порядке вырождения вершина клики видит остальные четыре среди более поздних соседей;
+    // их не больше вырожденности графа, поэтому K4 среди них ищется по локальным битовым строкам смежности
+    return search.run([&](uint32_t v, ParallelSearch::Scratch& scratch) {
+        std::vector<uint32_t> later;
+        for (const uint32_t* u = index.neighborsBegin(v); u != index.neighborsEnd(v); ++u) {
+            if (search.isLater(v, *u)) {
+                later.push_back(*u);
+            }
+        }
+        const size_t size = later.size();
+        if (size < 4) {
+            return;
+        }
+        const size_t words = (size + 63) / 64;
+        for (size_t i = 0; i < size; ++i) {
+            scratch.local[later[i]] = static_cast<int32_t>(i);
+        }
+        std::vector<uint64_t> adjacency(size * words, 0);
+        for (size_t i = 0; i < size; ++i) {
+            for (const uint32_t* w = index.neighborsBegin(later[i]); w != index.neighborsEnd(later[i]); ++w) {
+                int32_t j = scratch.local[*w];
+                if (j >= 0 && static_cast<size_t>(j) != i) {
+                    adjacency[i * words + j / 64] |= uint64_t(1) << (j % 64);
+                }
+            }
+        }
+        for (size_t i = 0; i < size; ++i) {
+            scratch.local[later[i]] = -1;
+        }
+
+        // Кандидаты уровня: вершины с номером больше текущей, смежные со всеми выбранными
+        std::vector<uint64_t> candidates(3 * words);
+        auto intersect = [&](uint64_t* target, const uint64_t* source, size_t row, size_t after) {
+            bool any = false;
+            for (size_t k = 0; k < words; ++k) {
+                uint64_t mask = k > after / 64 ? ~uint64_t(0) : (k < after / 64 ? 0 : ~uint64_t(0) << (after % 64) << 1);
+                target[k] = (source ? source[k] : ~uint64_t(0)) & adjacency[row * words + k] & mask;
+                any = any || target[k] != 0;
+            }
+            return any;
+        };
+        auto degreeAtLeast = [&](size_t row, int minimum) {
+            int count = 0;
+            for (size_t k = 0; k < words && count < minimum; ++k) {
+                count += popCount(adjacency[row * words + k]);
+            }
+            return count >= minimum;
+        };
+        uint64_t* level1 = candidates.data();
+        uint64_t* level2 = level1 + words;
+        uint64_t* level3 = level2 + words;
+        for (size_t a = 0; a < size && !search.stopped(); ++a) {
+            if (!degreeAtLeast(a, 3) || !intersect(level1, nullptr, a, a)) {
+                continue;
+            }
+            for (size_t kb = 0; kb < words; ++kb) {
+                for (uint64_t bitsB = level1[kb]; bitsB != 0; bitsB &= bitsB - 1) {
+                    size_t b = kb * 64 + lowestBit(bitsB);
+                    if (!intersect(level2, level1, b, b)) {
+                        continue;
+                    }
+                    for (size_t kc = 0; kc < words; ++kc) {
+                        for (uint64_t bitsC = level2[kc]; bitsC != 0; bitsC &= bitsC - 1) {
+                            size_t c = kc * 64 + lowestBit(bitsC);
+                            if (!intersect(level3, level2, c, c)) {
+                                continue;
+                            }
+                            for (size_t kd = 0; kd < words; ++kd) {
+                                if (level3[kd] != 0) {
+                                    size_t d = kd * 64 + lowestBit(level3[kd]);
+                                    search.report({ v, later[a], later[b], later[c], later[d] });
+                                    return;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+std::vector<size_t> findK33Biclique(const GraphIndex& index, ThreadPool& pool) {
+    GRAPH_PROFILE_SCOPE("kuratowski.k33");
+    ParallelSearch search(index, pool, 3);
+
+    // Ветвь v — доли {v, b, c}, где v раньше b и c в порядке вырождения. Для каждой вершины w,
+    // достижимой путём v - x - w, собирается битовая строка общих соседей с v (по номерам в N(v));
+    // K3,3 найден, если у двух таких вершин b и c пересечение строк содержит три вершины, кроме самих b и c
+    return search.run([&](uint32_t v, ParallelSearch::Scratch& scratch) {
+        std::vector<uint32_t> neighbors;
+        for (const uint32_t* x = index.neighborsBegin(v); x != index.neighborsEnd(v); ++x) {
+            if (*x != v && search.inCore(*x)) {
+                neighbors.push_back(*x);
+            }
+        }
+        const size_t size = neighbors.size();
+        if (size < 3) {
+            return;
+        }
+        const size_t words = (size + 63) / 64;
+        for (size_t i = 0; i < size; ++i) {
+            scratch.other[neighbors[i]] = static_cast<int32_t>(i);
+        }
+
+        // Счёт «клиньев» v - x - w по строкам общих соседей
+        std::vector<uint32_t> wedgeEnds;
+        std::vector<uint64_t> common;
+        for (size_t i = 0; i < size; ++i) {
+            for (const uint32_t* w = index.neighborsBegin(neighbors[i]); w != index.neighborsEnd(neighbors[i]); ++w) {
+                if (*w == neighbors[i] || !search.isLater(v, *w)) {
+                    continue;
+                }
+                int32_t& row = scratch.local[*w];
+                if (row < 0) {
+                    row = static_cast<int32_t>(wedgeEnds.size());
+                    wedgeEnds.push_back(*w);
+                    common.resize(common.size() + words, 0);
+                }
+                common[row * words + i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+        for (uint32_t w : wedgeEnds) {
+            scratch.local[w] = -1;
+        }
+
+        // Кандидаты второй и третьей вершины доли: не меньше трёх общих соседей с v
+        std::vector<uint32_t> rows;
+        for (size_t row = 0; row < wedgeEnds.size(); ++row) {
+            int count = 0;
+            for (size_t k = 0; k < words && count < 3; ++k) {
+                count += popCount(common[row * words + k]);
+            }
+            if (count >= 3) {
+                rows.push_back(static_cast<uint32_t>(row));
+            }
+        }
+
+        std::vector<uint64_t> shared(words);
+        bool found = false;
+        for (size_t i = 0; i < rows.size() && !found && !search.stopped(); ++i) {
+            uint32_t b = wedgeEnds[rows[i]];
+            for (size_t j = i + 1; j < rows.size() && !found; ++j) {
+                uint32_t c = wedgeEnds[rows[j]];
+                for (size_t k = 0; k < words; ++k) {
+                    shared[k] = common[rows[i] * words + k] & common[rows[j] * words + k];
+                }
+                // b и c сами могут быть соседями v и общими соседями друг друга — в другую долю они не идут
+                if (scratch.other[b] >= 0) {
+                    shared[scratch.other[b] / 64] &= ~(uint64_t(1) << (scratch.other[b] % 64));
+                }
+                if (scratch.other[c] >= 0) {
+                    shared[scratch.other[c] / 64] &= ~(uint64_t(1) << (scratch.other[c] % 64));
+                }
+                int count = 0;
+                for (size_t k = 0; k < words && count < 3; ++k) {
+                    count += popCount(shared[k]);
+                }
+                if (count < 3) {
+                    continue;
+                }
+                std::vector<size_t> result = { v, b, c };
+                for (size_t k = 0; k < words && result.size() < 6; ++k) {
+                    for (uint64_t bits = shared[k]; bits != 0 && result.size() < 6; bits &= bits - 1) {
+                        result.push_back(neighbors[k * 64 + lowestBit(bits)]);
+                    }
+                }
+                search.report(result);
+                found = true;
+            }
+        }
+        for (size_t i = 0; i < size; ++i) {
+            scratch.other[neighbors[i]] = -1;
+        }
+    });
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "GraphIndex.h"
+#include "ThreadPool.h"
+
+// Поиск K5 и K3,3 как подграфов (не подразбиений): пяти попарно смежных вершин
+// и двух троек вершин, где каждая вершина одной тройки смежна с каждой вершиной другой.
+// Вершины K5 лежат в 4-ядре графа, вершины K3,3 — в 3-ядре, поэтому поиск идёт только по ним.
+// Верхние ветви перебора (первая вершина в порядке вырождения) делятся между потоками пула;
+// первая найденная структура останавливает остальные ветви через общий флаг.
+
+// 5 вершин клики K5 или пустой вектор, если её нет
+std::vector<size_t> findK5Clique(const GraphIndex& index, ThreadPool& pool);
+
+// 6 вершин K3,3 (первые три — одна доля, последние три — другая) или пустой вектор
+std::vector<size_t> findK33Biclique(const GraphIndex& index, ThreadPool& pool);
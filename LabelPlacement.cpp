@@ -0,0 +1,165 @@
+#include "LabelPlacement.h"
+
+#include <algorithm>
+#include <cstdint>
+#include "Profiler.h"
+#include "SpatialGrid.h"
+
+namespace {
+
+const int kVertexRadius = 7; // Радиус круга вершины (см. BMPGenerator::drawCircle)
+const int kCandidateCount = 8;
+const int kMaxEdgeHits = 16; // Кандидаты, закрывающие столько рёбер или больше, считаются одинаково плохими
+// Рёбер в ячейке сетки не больше: метка, задевающая ячейку со столькими рёбрами, обычно закрывает
+// kMaxEdgeHits из них, и остальные рёбра выбор кандидата почти не меняют. Без ограничения сетка длинных
+// рёбер растёт как E * (длина ребра в ячейках): на случайном графе в 100000 вершин — 28 миллионов записей
+const size_t kMaxCellEdges = 2 * kMaxEdgeHits;
+
+// Прямоугольник с границами включительно
+struct Box {
+    int x0, y0, x1, y1;
+};
+
+bool overlaps(const Box& a, const Box& b) {
+    return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+// Рамка метки из length символов с точкой привязки (x, y), как её рисует drawText
+Box labelBox(int x, int y, int length) {
+    Box box = { x - length, y - 1, x + 9 * length, y + 11 };
+    return box;
+}
+
+// Кандидат i: смещение точки привязки метки из length символов. Первая позиция — прежняя справа снизу,
+// остальные прилегают к кругу вершины справа, сверху справа, снизу слева, слева, сверху слева, сверху и снизу
+void candidateOffset(int i, int length, int& dx, int& dy) {
+    const int right = kVertexRadius + 1 + length; // Левая граница рамки сразу за кругом
+    const int left = -kVertexRadius - 1 - 9 * length; // Правая граница рамки перед кругом
+    const int centered = -4 * length;
+    const int above = -kVertexRadius - 1 - 11; // Нижняя граница рамки над кругом
+    const int below = kVertexRadius + 2; // Верхняя граница рамки под кругом
+    const int middle = -5; // Рамка высотой 13 пикселей по центру круга
+    const int offsets[kCandidateCount][2] = {
+        { 7, 7 }, { right, middle }, { 7, above }, { left, 7 }, { left, middle }, { left, above }, { centered, above }, { centered, below }
+    };
+    dx = offsets[i][0];
+    dy = offsets[i][1];
+}
+
+// Касается ли отрезок прямоугольника (пиксели линии считаются квадратами со стороной 1): разделяющие
+// оси — стороны рамки и нормаль отрезка; углы рамки, расширенной на полпикселя, — в удвоенных координатах
+bool segmentTouchesBox(int x0, int y0, int x1, int y1, const Box& box) {
+    if (std::max(x0, x1) < box.x0 || std::min(x0, x1) > box.x1 || std::max(y0, y1) < box.y0 || std::min(y0, y1) > box.y1) {
+        return false;
+    }
+    const int64_t dx = x1 - x0, dy = y1 - y0;
+    const int64_t left = 2 * static_cast<int64_t>(box.x0 - x0) - 1, right = 2 * static_cast<int64_t>(box.x1 - x0) + 1;
+    const int64_t top = 2 * static_cast<int64_t>(box.y0 - y0) - 1, bottom = 2 * static_cast<int64_t>(box.y1 - y0) + 1;
+    const int64_t corners[4] = { dx * top - dy * left, dx * top - dy * right, dx * bottom - dy * left, dx * bottom - dy * right };
+    const bool above = corners[0] > 0 && corners[1] > 0 && corners[2] > 0 && corners[3] > 0;
+    const bool below = corners[0] < 0 && corners[1] < 0 && corners[2] < 0 && corners[3] < 0;
+    return !above && !below;
+}
+
+} // namespace
+
+LabelPlacer::LabelPlacer(int width, int height) : m_width(width), m_height(height) {}
+
+size_t LabelPlacer::place(const GraphStorage& graph, std::vector<LabelOffset>& offsets) const {
+    GRAPH_PROFILE_SCOPE("labels.place");
+    const size_t n = graph.vertexCount();
+    offsets.assign(n, LabelOffset());
+
+    SpatialGrid discs(m_width, m_height, kCellSize);
+    SpatialGrid segments(m_width, m_height, kCellSize);
+    SpatialGrid labels(m_width, m_height, kCellSize);
+    for (size_t v = 0; v < n; ++v) {
+        discs.insertRect(static_cast<uint32_t>(v), graph.x(v) - kVertexRadius, graph.y(v) - kVertexRadius,
+            graph.x(v) + kVertexRadius, graph.y(v) + kVertexRadius);
+    }
+    // Концы отрезков хранятся рядом: проверка ребра не обращается к вершинам
+    const size_t m = graph.edgeCount();
+    std::vector<Box> ends(m);
+    for (size_t i = 0; i < m; ++i) {
+        const uint32_t a = graph.vertex1(i), b = graph.vertex2(i);
+        if (a < n && b < n && a != b) {
+            ends[i] = { graph.x(a), graph.y(a), graph.x(b), graph.y(b) };
+            segments.insertSegment(static_cast<uint32_t>(i), ends[i].x0, ends[i].y0, ends[i].x1, ends[i].y1, kMaxCellEdges);
+        }
+    }
+
+    // Ребро, лежащее в нескольких ячейках, считается один раз за проверку кандидата
+    std::vector<uint32_t> edgeStamp(m, 0);
+    uint32_t stamp = 0;
+    std::vector<Box> placed(n);
+    std::vector<uint32_t> cells, bestCells;
+    size_t visible = 0;
+    for (size_t v = 0; v < n; ++v) {
+        const int length = static_cast<int>(graph.labelLength(v));
+        if (length == 0) {
+            continue; // Пустая метка ничего не закрывает и остаётся на прежнем месте
+        }
+        int bestCandidate = -1;
+        int bestHits = kMaxEdgeHits;
+        for (int candidate = 0; candidate < kCandidateCount && bestHits > 0; ++candidate) {
+            int dx, dy;
+            candidateOffset(candidate, length, dx, dy);
+            Box box = labelBox(graph.x(v) + dx, graph.y(v) + dy, length);
+            // Та же проверка границ, что и в drawText
+            if (box.x0 < 0 || box.x1 >= m_width || box.y0 < 0 || box.y1 >= m_height) {
+                continue;
+            }
+            cells.clear();
+            discs.rectCells(box.x0, box.y0, box.x1, box.y1, cells);
+            bool blocked = false;
+            for (size_t c = 0; c < cells.size() && !blocked; ++c) {
+                for (uint32_t u : discs.cell(cells[c])) {
+                    Box disc = { graph.x(u) - kVertexRadius, graph.y(u) - kVertexRadius, graph.x(u) + kVertexRadius, graph.y(u) + kVertexRadius };
+                    if (u != v && overlaps(box, disc)) {
+                        blocked = true;
+                        break;
+                    }
+                }
+                for (uint32_t u : labels.cell(cells[c])) {
+                    if (blocked || overlaps(box, placed[u])) {
+                        blocked = true;
+                        break;
+                    }
+                }
+            }
+            if (blocked) {
+                continue;
+            }
+            // Рёбра под меткой; подсчёт прекращается, как только кандидат не лучше уже найденного
+            // (первый допустимый кандидат считается до kMaxEdgeHits)
+            ++stamp;
+            int hits = 0;
+            for (size_t c = 0; c < cells.size() && hits < bestHits; ++c) {
+                for (uint32_t i : segments.cell(cells[c])) {
+                    if (edgeStamp[i] == stamp) {
+                        continue;
+                    }
+                    edgeStamp[i] = stamp;
+                    if (segmentTouchesBox(ends[i].x0, ends[i].y0, ends[i].x1, ends[i].y1, box) && ++hits >= bestHits) {
+                        break;
+                    }
+                }
+            }
+            if (bestCandidate < 0 || hits < bestHits) {
+                bestCandidate = candidate;
+                bestHits = hits;
+                placed[v] = box;
+                bestCells.swap(cells);
+            }
+        }
+        if (bestCandidate < 0) {
+            offsets[v].visible = false;
+            GRAPH_PROFILE_COUNT("labels.hidden", 1);
+            continue;
+        }
+        candidateOffset(bestCandidate, length, offsets[v].dx, offsets[v].dy);
+        labels.insert(static_cast<uint32_t>(v), bestCells);
+        ++visible;
+    }
+    return visible;
+}
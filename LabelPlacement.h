@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "GraphStorage.h"
+
+// Положение метки вершины: смещение точки привязки drawText от центра вершины (по умолчанию (7, 7)).
+// Рамка метки из n символов занимает [x + dx - n, x + dx + 9n] x [y + dy - 1, y + dy + 11]
+struct LabelOffset {
+    int dx;
+    int dy;
+    bool visible; // false — метке не нашлось места, она не рисуется
+
+    LabelOffset() : dx(7), dy(7), visible(true) {}
+    LabelOffset(int dx, int dy, bool visible) : dx(dx), dy(dy), visible(visible) {}
+};
+
+// Жадная расстановка меток без наложений. Круги вершин, рёбра и уже поставленные метки лежат
+// в равномерных сетках (SpatialGrid.h), поэтому проверка кандидата смотрит только соседние ячейки,
+// а не все пары меток и рёбер. Для каждой вершины по очереди перебираются позиции вокруг круга,
+// начиная с прежней (справа снизу): метка не должна выходить за холст, задевать чужие круги и
+// поставленные метки; из допустимых берётся первая без пересечений с рёбрами или, если такой нет,
+// с наименьшим их числом. Метка, которой некуда встать, скрывается
+class LabelPlacer {
+public:
+    LabelPlacer(int width, int height);
+
+    // offsets получает положение метки каждой вершины; возвращает число видимых меток
+    size_t place(const GraphStorage& graph, std::vector<LabelOffset>& offsets) const;
+
+    static const int kCellSize = 32; // Сторона ячейки сетки: порядка размера метки
+
+private:
+    int m_width;
+    int m_height;
+};
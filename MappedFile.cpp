@@ -0,0 +1,76 @@
+#include "MappedFile.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GRAPH_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_open(false), m_mapped(false) {}
+
+MappedFile::MappedFile(const std::string& filename) : m_data(nullptr), m_size(0), m_open(false), m_mapped(false) {
+    open(filename);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+#ifdef GRAPH_HAVE_MMAP
+    int descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0) {
+        ::close(descriptor);
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size > 0) {
+        void* address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED) {
+            ::close(descriptor);
+            m_size = 0;
+            return false;
+        }
+        madvise(address, m_size, MADV_SEQUENTIAL); // Файл читается подряд
+        m_data = static_cast<const char*>(address);
+        m_mapped = true;
+    }
+    ::close(descriptor); // Отображение остаётся действительным и после закрытия дескриптора
+    m_open = true;
+    return true;
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    m_fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(m_fallback.data(), m_fallback.size());
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+    m_open = true;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef GRAPH_HAVE_MMAP
+    if (m_mapped) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_fallback.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+    m_mapped = false;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Файл, отображённый в память только для чтения. На платформах без mmap содержимое
+// читается в буфер целиком, интерфейс при этом не меняется.
+class MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return m_open; }
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    bool m_open;
+    bool m_mapped; // true — память получена через mmap, false — через m_fallback
+    std::vector<char> m_fallback;
+};
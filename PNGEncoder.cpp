@@ -0,0 +1,203 @@
+#include "PNGEncoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "BMPEncoder.h"
+#include "Deflate.h"
+#include "Profiler.h"
+
+const size_t PNGEncoder::kStripBytes;
+
+namespace {
+
+const uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+const int kGrayscale = 0; // Типы цвета IHDR
+const int kTruecolor = 2;
+
+void putBigEndian(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+// Блок PNG: chunk содержит 4 байта под длину, тип и данные; дописываются длина и CRC типа и данных
+void finishChunk(std::vector<uint8_t>& chunk) {
+    putBigEndian(chunk.data(), static_cast<uint32_t>(chunk.size() - 8));
+    uint8_t crc[4];
+    putBigEndian(crc, crc32(0, chunk.data() + 4, chunk.size() - 4));
+    chunk.insert(chunk.end(), crc, crc + 4);
+}
+
+std::vector<uint8_t> startChunk(const char* type) {
+    std::vector<uint8_t> chunk(8);
+    std::memcpy(chunk.data() + 4, type, 4);
+    return chunk;
+}
+
+int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : pb <= pc ? b : c;
+}
+
+// Фильтрованная строка: байт типа фильтра и rowBytes байт разностей. Выбирается фильтр
+// с наименьшей суммой модулей разностей как знаковых байтов
+void filterRow(const uint8_t* row, const uint8_t* above, size_t rowBytes, int pixelBytes, uint8_t* out) {
+    uint64_t sums[5] = {};
+    for (size_t i = 0; i < rowBytes; ++i) {
+        int x = row[i];
+        int a = i >= static_cast<size_t>(pixelBytes) ? row[i - pixelBytes] : 0;
+        int b = above[i];
+        int c = i >= static_cast<size_t>(pixelBytes) ? above[i - pixelBytes] : 0;
+        sums[0] += std::abs(static_cast<int8_t>(x));
+        sums[1] += std::abs(static_cast<int8_t>(x - a));
+        sums[2] += std::abs(static_cast<int8_t>(x - b));
+        sums[3] += std::abs(static_cast<int8_t>(x - (a + b) / 2));
+        sums[4] += std::abs(static_cast<int8_t>(x - paeth(a, b, c)));
+    }
+    const int filter = static_cast<int>(std::min_element(sums, sums + 5) - sums);
+    *out++ = static_cast<uint8_t>(filter);
+    for (size_t i = 0; i < rowBytes; ++i) {
+        int x = row[i];
+        int a = i >= static_cast<size_t>(pixelBytes) ? row[i - pixelBytes] : 0;
+        int b = above[i];
+        int c = i >= static_cast<size_t>(pixelBytes) ? above[i - pixelBytes] : 0;
+        int predicted = filter == 0 ? 0 : filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b) / 2 : paeth(a, b, c);
+        out[i] = static_cast<uint8_t>(x - predicted);
+    }
+}
+
+} // namespace
+
+PNGEncoder::PNGEncoder(ThreadPool* pool) : m_pool(pool) {}
+
+bool PNGEncoder::encodeRows(std::ostream& file, int width, int height, int colorType, int bitDepth, size_t rowBytes,
+    int pixelBytes, const RowSource& rowSource) {
+    GRAPH_PROFILE_SCOPE("encode.image");
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Error: PNG image must not be empty." << std::endl;
+        return false;
+    }
+    const int rowsPerStrip = static_cast<int>(std::min<size_t>(std::max<size_t>(kStripBytes / (rowBytes + 1), 1), height));
+    const size_t stripCount = (static_cast<size_t>(height) + rowsPerStrip - 1) / rowsPerStrip;
+
+    // Каждая полоса — готовый блок IDAT; первая начинается с заголовка zlib
+    struct Strip {
+        std::vector<uint8_t> chunk;
+        uint32_t adler;
+        size_t rawBytes;
+    };
+    std::vector<Strip> strips(stripCount);
+    auto compressStrip = [&](size_t index) {
+        const int first = static_cast<int>(index) * rowsPerStrip;
+        const int last = std::min(first + rowsPerStrip, height);
+        std::vector<uint8_t> above(rowBytes, 0), row(rowBytes);
+        std::vector<uint8_t> filtered((rowBytes + 1) * (last - first));
+        if (first > 0 && bitDepth == 8) {
+            rowSource(first - 1, above.data()); // Фильтры первой строки полосы смотрят на строку над ней
+        }
+        for (int y = first; y < last; ++y) {
+            uint8_t* out = filtered.data() + (rowBytes + 1) * (y - first);
+            rowSource(y, row.data());
+            if (bitDepth == 8) {
+                filterRow(row.data(), above.data(), rowBytes, pixelBytes, out);
+                above.swap(row);
+            }
+            else {
+                out[0] = 0;
+                std::memcpy(out + 1, row.data(), rowBytes);
+            }
+        }
+
+        Strip& strip = strips[index];
+        strip.adler = adler32(1, filtered.data(), filtered.size());
+        strip.rawBytes = filtered.size();
+        strip.chunk = startChunk("IDAT");
+        if (index == 0) {
+            strip.chunk.push_back(0x78); // Метод deflate с окном 32 КБ
+            strip.chunk.push_back(0x9C);
+        }
+        Deflater deflater;
+        deflater.compress(filtered.data(), filtered.size(), strip.chunk);
+        finishChunk(strip.chunk);
+    };
+    if (m_pool != nullptr) {
+        m_pool->run(stripCount, compressStrip);
+    }
+    else {
+        for (size_t index = 0; index < stripCount; ++index) {
+            compressStrip(index);
+        }
+    }
+
+    std::vector<uint8_t> header = startChunk("IHDR");
+    header.resize(header.size() + 13);
+    putBigEndian(header.data() + 8, static_cast<uint32_t>(width));
+    putBigEndian(header.data() + 12, static_cast<uint32_t>(height));
+    header[16] = static_cast<uint8_t>(bitDepth);
+    header[17] = static_cast<uint8_t>(colorType);
+    header[18] = 0; // Сжатие deflate
+    header[19] = 0; // Стандартные фильтры
+    header[20] = 0; // Без чересстрочности
+    finishChunk(header);
+
+    // Последний блок deflate и Adler-32 всех несжатых данных
+    uint32_t adler = 1;
+    for (const Strip& strip : strips) {
+        adler = adler32Combine(adler, strip.adler, strip.rawBytes);
+    }
+    std::vector<uint8_t> tail = startChunk("IDAT");
+    Deflater::finish(tail);
+    tail.resize(tail.size() + 4);
+    putBigEndian(tail.data() + tail.size() - 4, adler);
+    finishChunk(tail);
+    std::vector<uint8_t> end = startChunk("IEND");
+    finishChunk(end);
+
+    size_t bytes = sizeof(kSignature) + header.size() + tail.size() + end.size();
+    file.write(reinterpret_cast<const char*>(kSignature), sizeof(kSignature));
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    for (const Strip& strip : strips) {
+        file.write(reinterpret_cast<const char*>(strip.chunk.data()), strip.chunk.size());
+        bytes += strip.chunk.size();
+    }
+    file.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+    file.write(reinterpret_cast<const char*>(end.data()), end.size());
+    GRAPH_PROFILE_COUNT("bytes.written", bytes);
+    return file.good();
+}
+
+bool PNGEncoder::encode(std::ostream& file, const Bitmap& bitmap) {
+    // В 1-битном PNG старший бит — левый пиксель, как в 1-битном BMP, но 0 — чёрный
+    const BMPEncoder packer(BMPFormat::Palette1);
+    const int width = bitmap.width();
+    const size_t rowBytes = (static_cast<size_t>(std::max(width, 0)) + 7) / 8;
+    return encodeRows(file, width, bitmap.height(), kGrayscale, 1, rowBytes, 1, [&](int y, uint8_t* row) {
+        packer.encodeSpan(bitmap.row(bitmap.top() + y), 0, width, row);
+        for (size_t i = 0; i < rowBytes; ++i) {
+            row[i] = static_cast<uint8_t>(~row[i]);
+        }
+    });
+}
+
+bool PNGEncoder::encode(std::ostream& file, const GrayImage& image) {
+    return encodeRows(file, image.width(), image.height(), kGrayscale, 8, static_cast<size_t>(std::max(image.width(), 0)), 1,
+        [&](int y, uint8_t* row) { std::memcpy(row, image.row(y), image.width()); });
+}
+
+bool PNGEncoder::encode(std::ostream& file, const Framebuffer& framebuffer) {
+    const int width = framebuffer.width();
+    return encodeRows(file, width, framebuffer.height(), kTruecolor, 8, static_cast<size_t>(std::max(width, 0)) * 3, 3,
+        [&](int y, uint8_t* row) {
+            const Color* pixels = framebuffer.row(y);
+            for (int x = 0; x < width; ++x) {
+                row[3 * x] = static_cast<uint8_t>(pixels[x] >> 16);
+                row[3 * x + 1] = static_cast<uint8_t>(pixels[x] >> 8);
+                row[3 * x + 2] = static_cast<uint8_t>(pixels[x]);
+            }
+        });
+}
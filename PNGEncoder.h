@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include "ImageEncoder.h"
+
+// Кодировщик PNG со встроенным сжатием deflate (Deflate.h), без внешних библиотек. Монохромная карта
+// пишется 1-битным полутоновым изображением, полутоновое — 8-битным, буфер кадра — 24-битным RGB.
+// Перед сжатием к каждой 8-битной строке применяется фильтр PNG с наименьшей суммой модулей
+// разностей (без фильтра, Sub, Up, Average или Paeth); 1-битные строки не фильтруются.
+//
+// Строки делятся на полосы примерно по kStripBytes байт, и полосы сжимаются независимо (параллельно
+// на pool): каждая полоса — отдельный кусок потока deflate со своим словарём, выровненный до байта,
+// и отдельный блок IDAT со своей CRC. Контрольная сумма Adler-32 всего потока собирается из сумм полос
+class PNGEncoder : public ImageEncoder {
+public:
+    explicit PNGEncoder(ThreadPool* pool = nullptr);
+
+    // Пустое изображение PNG не допускает: для него возвращается false
+    bool encode(std::ostream& file, const Bitmap& bitmap) override;
+    bool encode(std::ostream& file, const Framebuffer& framebuffer) override;
+    bool encode(std::ostream& file, const GrayImage& image) override;
+
+    static const size_t kStripBytes = 1 << 20; // Несжатых байт в полосе, которую сжимает одно задание
+
+private:
+    // rowSource записывает rowBytes байт строки y без фильтра; colorType и bitDepth — поля заголовка IHDR,
+    // pixelBytes — байт на пиксель для фильтров (не меньше одного)
+    typedef std::function<void(int, uint8_t*)> RowSource;
+    bool encodeRows(std::ostream& file, int width, int height, int colorType, int bitDepth, size_t rowBytes,
+        int pixelBytes, const RowSource& rowSource);
+
+    ThreadPool* m_pool;
+};
@@ -0,0 +1,502 @@
+#include "PlanarLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "Profiler.h"
+
+namespace {
+
+const uint32_t kNone = UINT32_MAX;
+
+// Множество неориентированных рёбер с открытой адресацией: ключ — пара концов, 0 означает пустую ячейку.
+// Размер фиксируется при создании, поэтому число рёбер должно быть известно заранее
+class EdgeSet {
+public:
+    explicit EdgeSet(size_t maxEdges) {
+        size_t capacity = 16;
+        while (capacity < 2 * maxEdges) {
+            capacity *= 2;
+        }
+        m_keys.assign(capacity, 0);
+        m_mask = capacity - 1;
+    }
+
+    void insert(uint32_t u, uint32_t v) {
+        uint64_t key = edgeKey(u, v);
+        size_t slot = hash(key);
+        while (m_keys[slot] != 0 && m_keys[slot] != key) {
+            slot = (slot + 1) & m_mask;
+        }
+        m_keys[slot] = key;
+    }
+
+    bool contains(uint32_t u, uint32_t v) const {
+        uint64_t key = edgeKey(u, v);
+        for (size_t slot = hash(key); m_keys[slot] != 0; slot = (slot + 1) & m_mask) {
+            if (m_keys[slot] == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // Меньший конец в старших битах; +1, чтобы ключ не совпал с пустой ячейкой
+    static uint64_t edgeKey(uint32_t u, uint32_t v) {
+        return u < v ? ((static_cast<uint64_t>(u) << 32) | v) + 1 : ((static_cast<uint64_t>(v) << 32) | u) + 1;
+    }
+
+    size_t hash(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & m_mask;
+    }
+
+    std::vector<uint64_t> m_keys;
+    size_t m_mask;
+};
+
+// Укладка на полурёбрах: рёбра хранятся парами (h и h ^ 1 — противоположные направления),
+// полурёбра каждой вершины связаны в кольцо по часовой стрелке. Грань обходится переходом
+// h → ccw(h ^ 1): из конца полуребра к соседу, следующему против часовой стрелки
+class HalfEdgeEmbedding {
+public:
+    // Триангуляция доводит число рёбер до 3V - 6, связывание компонент добавляет меньше V
+    explicit HalfEdgeEmbedding(const std::vector<std::vector<size_t>>& embedding)
+        : m_first(embedding.size(), kNone), m_edges(4 * embedding.size()) {
+        const uint32_t n = static_cast<uint32_t>(embedding.size());
+        m_target.reserve(8 * n);
+        m_cw.reserve(8 * n);
+        m_ccw.reserve(8 * n);
+
+        // Пара полурёбер создаётся со стороны меньшего конца и записывается в список ожидающих
+        // у большего; при обходе большего конца номер пары берётся из рабочего массива slot
+        std::vector<uint32_t> pendingOffsets(n + 1, 0);
+        for (uint32_t v = 0; v < n; ++v) {
+            for (size_t w : embedding[v]) {
+                if (w > v) {
+                    ++pendingOffsets[w + 1];
+                }
+            }
+        }
+        for (uint32_t v = 0; v < n; ++v) {
+            pendingOffsets[v + 1] += pendingOffsets[v];
+        }
+        std::vector<uint32_t> pendingFill(pendingOffsets.begin(), pendingOffsets.end() - 1);
+        std::vector<uint32_t> pending(pendingOffsets[n]);
+        std::vector<uint32_t> slot(n, kNone);
+        std::vector<uint32_t> ring;
+        for (uint32_t v = 0; v < n; ++v) {
+            for (uint32_t i = pendingOffsets[v]; i < pendingOffsets[v + 1]; ++i) {
+                slot[origin(pending[i])] = pending[i] ^ 1;
+            }
+            ring.clear();
+            for (size_t neighbor : embedding[v]) {
+                uint32_t w = static_cast<uint32_t>(neighbor);
+                if (w > v) {
+                    uint32_t h = static_cast<uint32_t>(m_target.size());
+                    pushEdge(v, w);
+                    pending[pendingFill[w]++] = h;
+                    ring.push_back(h);
+                }
+                else {
+                    ring.push_back(slot[w]);
+                }
+            }
+            for (size_t i = 0; i < ring.size(); ++i) {
+                m_cw[ring[i]] = ring[(i + 1) % ring.size()];
+                m_ccw[ring[(i + 1) % ring.size()]] = ring[i];
+            }
+            if (!ring.empty()) {
+                m_first[v] = ring[0];
+            }
+        }
+    }
+
+    size_t numVertices() const { return m_first.size(); }
+    size_t numHalfEdges() const { return m_target.size(); }
+    uint32_t first(uint32_t v) const { return m_first[v]; }
+    uint32_t target(uint32_t h) const { return m_target[h]; }
+    uint32_t origin(uint32_t h) const { return m_target[h ^ 1]; }
+    uint32_t cw(uint32_t h) const { return m_cw[h]; }
+    uint32_t ccw(uint32_t h) const { return m_ccw[h]; }
+    uint32_t faceNext(uint32_t h) const { return m_ccw[h ^ 1]; }
+    bool hasEdge(uint32_t u, uint32_t v) const { return m_edges.contains(u, v); }
+
+    // Новое ребро u–v: полуребро u→v встаёт по часовой стрелке сразу за afterU, v→u — сразу за afterV
+    // (kNone — у вершины ещё нет рёбер). Возвращает полуребро u→v
+    uint32_t addEdge(uint32_t u, uint32_t afterU, uint32_t v, uint32_t afterV) {
+        uint32_t h = static_cast<uint32_t>(m_target.size());
+        pushEdge(u, v);
+        linkAfter(u, afterU, h);
+        linkAfter(v, afterV, h ^ 1);
+        return h;
+    }
+
+private:
+    void pushEdge(uint32_t u, uint32_t v) {
+        m_target.push_back(v);
+        m_target.push_back(u);
+        m_cw.resize(m_target.size(), kNone);
+        m_ccw.resize(m_target.size(), kNone);
+        m_edges.insert(u, v);
+    }
+
+    void linkAfter(uint32_t v, uint32_t after, uint32_t h) {
+        if (after == kNone) {
+            m_cw[h] = m_ccw[h] = h;
+            m_first[v] = h;
+            return;
+        }
+        uint32_t next = m_cw[after];
+        m_cw[after] = h;
+        m_ccw[h] = after;
+        m_cw[h] = next;
+        m_ccw[next] = h;
+    }
+
+    std::vector<uint32_t> m_first; // Любое полуребро из вершины
+    std::vector<uint32_t> m_target;
+    std::vector<uint32_t> m_cw; // Следующее полуребро из той же вершины по часовой стрелке
+    std::vector<uint32_t> m_ccw; // ... и против часовой стрелки
+    EdgeSet m_edges;
+};
+
+// Компоненты связности соединяются цепочкой рёбер между их представителями: компоненты лежат
+// в разных гранях друг друга, поэтому новое ребро можно вставить в любое место кольца
+void connectComponents(HalfEdgeEmbedding& graph) {
+    const uint32_t n = static_cast<uint32_t>(graph.numVertices());
+    std::vector<uint8_t> seen(n, 0);
+    std::vector<uint32_t> stack;
+    uint32_t previous = kNone;
+    for (uint32_t root = 0; root < n; ++root) {
+        if (seen[root]) {
+            continue;
+        }
+        seen[root] = 1;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t v = stack.back();
+            stack.pop_back();
+            uint32_t first = graph.first(v);
+            if (first == kNone) {
+                continue;
+            }
+            uint32_t h = first;
+            do {
+                uint32_t w = graph.target(h);
+                if (!seen[w]) {
+                    seen[w] = 1;
+                    stack.push_back(w);
+                }
+                h = graph.cw(h);
+            } while (h != first);
+        }
+        if (previous != kNone) {
+            graph.addEdge(previous, graph.first(previous), root, graph.first(root));
+        }
+        previous = root;
+    }
+}
+
+// Двусвязность: при обходе каждой грани повторное появление вершины v2 между соседями v1 и v3
+// закрывается ребром v1–v3, отрезающим от грани треугольник v1, v2, v3. Возвращает по одному
+// полуребру каждой грани; outer — грань с наибольшим числом вершин, она станет внешней
+std::vector<uint32_t> makeBiconnected(HalfEdgeEmbedding& graph, uint32_t& outer) {
+    std::vector<uint32_t> faces;
+    std::vector<uint8_t> visited(graph.numHalfEdges(), 0);
+    std::vector<uint32_t> faceStamp(graph.numVertices(), 0);
+    size_t outerSize = 0;
+    for (uint32_t start = 0; start < graph.numHalfEdges(); ++start) {
+        if (visited[start]) {
+            continue;
+        }
+        const uint32_t stamp = static_cast<uint32_t>(faces.size() + 1);
+        faces.push_back(start);
+        faceStamp[graph.origin(start)] = stamp;
+        size_t faceSize = 1;
+        visited[start] = 1;
+        uint32_t a = start;
+        uint32_t b = graph.faceNext(a);
+        while (b != start) {
+            uint32_t v2 = graph.target(a);
+            if (faceStamp[v2] == stamp) {
+                uint32_t v1 = graph.origin(a), v3 = graph.target(b);
+                uint32_t h = graph.addEdge(v1, a, v3, graph.ccw(b ^ 1));
+                visited.resize(graph.numHalfEdges(), 0);
+                visited[b] = 1;
+                visited[h ^ 1] = 1; // Грань отрезанного треугольника
+                a = h;
+            }
+            else {
+                faceStamp[v2] = stamp;
+                ++faceSize;
+                a = b;
+            }
+            visited[a] = 1;
+            b = graph.faceNext(a);
+        }
+        if (faceSize > outerSize) {
+            outerSize = faceSize;
+            outer = start;
+        }
+    }
+    return faces;
+}
+
+// Триангуляция грани веером из текущей вершины v1; если диагональ v1–v3 уже есть в графе,
+// веер начинается заново со следующей вершины грани
+void triangulateFace(HalfEdgeEmbedding& graph, uint32_t h1) {
+    uint32_t h2 = graph.faceNext(h1);
+    uint32_t h3 = graph.faceNext(h2);
+    uint32_t v1 = graph.origin(h1);
+    if (v1 == graph.target(h1) || v1 == graph.target(h2)) {
+        return;
+    }
+    while (v1 != graph.target(h3)) {
+        uint32_t v3 = graph.target(h2);
+        if (graph.hasEdge(v1, v3)) {
+            h1 = h2;
+        }
+        else {
+            h1 = graph.addEdge(v1, h1, v3, graph.ccw(h2 ^ 1));
+        }
+        h2 = h3;
+        h3 = graph.faceNext(h2);
+        v1 = graph.origin(h1);
+    }
+}
+
+// Каноническая нумерация триангуляции: order[k] — k-я вершина, для k >= 2 её соседи на внешнем контуре
+// (от wp со стороны v1 до wq со стороны v2) лежат в contour[contourBegin[k] .. contourEnd[k])
+struct CanonicalOrdering {
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> contourBegin;
+    std::vector<uint32_t> contourEnd;
+    std::vector<uint32_t> contour;
+};
+
+// Вершины снимаются с внешнего контура триангуляции (внешняя грань v1, v2, v3), начиная с v3: снимать
+// можно вершину контура без хорд, кроме v1 и v2. Хорды контура считаются для каждой вершины и
+// обновляются только у вершин, вышедших на контур, поэтому всё построение занимает O(V)
+void canonicalOrdering(const HalfEdgeEmbedding& graph, uint32_t v1, uint32_t v2, uint32_t v3, CanonicalOrdering& result) {
+    const uint32_t n = static_cast<uint32_t>(graph.numVertices());
+    // Соседи по текущему внешнему контуру; у v1 нет соседа против часовой стрелки, у v2 — по часовой
+    std::vector<uint32_t> contourCw(n, kNone), contourCcw(n, kNone);
+    std::vector<uint8_t> marked(n, 0), ready(n, 0);
+    std::vector<uint32_t> chords(n, 0); // Хорды внешнего контура, выходящие из вершины
+    std::vector<uint32_t> newOnContour(n, kNone); // Шаг, на котором вершина вышла на контур
+    std::vector<uint32_t> readyStack;
+    contourCcw[v2] = v3;
+    contourCcw[v3] = v1;
+    contourCw[v1] = v3;
+    contourCw[v3] = v2;
+
+    auto onContour = [&](uint32_t x) { return !marked[x] && (contourCcw[x] != kNone || x == v1); };
+    auto contourNeighbors = [&](uint32_t x, uint32_t y) { return contourCw[x] == y || contourCcw[x] == y; };
+    auto makeReady = [&](uint32_t x) {
+        if (!ready[x] && x != v1 && x != v2) {
+            ready[x] = 1;
+            readyStack.push_back(x);
+        }
+    };
+    makeReady(v3);
+
+    result.order.assign(n, kNone);
+    result.contourBegin.assign(n, 0);
+    result.contourEnd.assign(n, 0);
+    result.contour.clear();
+    result.contour.reserve(4 * n);
+    result.order[0] = v1;
+    result.order[1] = v2;
+    for (uint32_t k = n - 1; k >= 2; --k) {
+        // Снятые с готовности вершины остаются в стеке и пропускаются
+        uint32_t v = kNone;
+        while (v == kNone) {
+            uint32_t candidate = readyStack.back();
+            readyStack.pop_back();
+            if (ready[candidate]) {
+                v = candidate;
+            }
+        }
+        ready[v] = 0;
+        marked[v] = 1;
+
+        uint32_t wp = kNone, wq = kNone, toWp = kNone;
+        uint32_t h = graph.first(v);
+        while (wp == kNone || wq == kNone) {
+            uint32_t w = graph.target(h);
+            if (onContour(w)) {
+                if (w == v1 || (w != v2 && contourCw[w] == v)) {
+                    wp = w;
+                    toWp = h;
+                }
+                else {
+                    wq = w;
+                }
+            }
+            h = graph.cw(h);
+        }
+
+        // Соседи v от wp до wq против часовой стрелки заменяют v на контуре
+        const uint32_t begin = static_cast<uint32_t>(result.contour.size());
+        result.contour.push_back(wp);
+        for (uint32_t w = wp; w != wq;) {
+            toWp = graph.ccw(toWp);
+            uint32_t next = graph.target(toWp);
+            result.contour.push_back(next);
+            contourCw[w] = next;
+            contourCcw[next] = w;
+            w = next;
+        }
+        const uint32_t end = static_cast<uint32_t>(result.contour.size());
+        result.order[k] = v;
+        result.contourBegin[k] = begin;
+        result.contourEnd[k] = end;
+
+        if (end - begin == 2) {
+            // Ребро wp–wq было хордой и стало ребром контура
+            if (--chords[wp] == 0) {
+                makeReady(wp);
+            }
+            if (--chords[wq] == 0) {
+                makeReady(wq);
+            }
+            continue;
+        }
+        for (uint32_t i = begin + 1; i + 1 < end; ++i) {
+            newOnContour[result.contour[i]] = k;
+        }
+        for (uint32_t i = begin + 1; i + 1 < end; ++i) {
+            uint32_t w = result.contour[i];
+            makeReady(w);
+            uint32_t first = graph.first(w);
+            uint32_t e = first;
+            do {
+                uint32_t x = graph.target(e);
+                if (onContour(x) && !contourNeighbors(w, x)) {
+                    ++chords[w];
+                    ready[w] = 0;
+                    // Хорда между двумя новыми вершинами учтётся при обходе второй из них
+                    if (newOnContour[x] != k) {
+                        ++chords[x];
+                        ready[x] = 0;
+                    }
+                }
+                e = graph.cw(e);
+            } while (e != first);
+        }
+    }
+}
+
+// Метод сдвигов: вершина k ставится над своими соседями wp..wq на контуре на пересечении прямых
+// с наклонами +1 и -1, а контур правее wp раздвигается. Координата x хранится смещением относительно
+// родителя в дереве, где у каждой вершины контура правый ребёнок — следующая вершина контура,
+// а левый — первая вершина, закрытая ею; сдвиг поддерева стоит O(1), и абсолютные x находятся
+// одним обходом в конце (Chrobak–Payne)
+void shiftCoordinates(const CanonicalOrdering& ordering, std::vector<int>& xs, std::vector<int>& ys) {
+    const size_t n = ordering.order.size();
+    std::vector<int> deltaX(n, 0);
+    std::vector<uint32_t> left(n, kNone), right(n, kNone);
+    ys.assign(n, 0);
+    const uint32_t v1 = ordering.order[0], v2 = ordering.order[1], v3 = ordering.order[2];
+    deltaX[v2] = 1;
+    deltaX[v3] = 1;
+    ys[v3] = 1;
+    right[v1] = v3;
+    right[v3] = v2;
+    for (size_t k = 3; k < n; ++k) {
+        const uint32_t vk = ordering.order[k];
+        const uint32_t* contour = ordering.contour.data() + ordering.contourBegin[k];
+        const size_t length = ordering.contourEnd[k] - ordering.contourBegin[k];
+        const uint32_t wp = contour[0], wp1 = contour[1], wq = contour[length - 1];
+        const bool coversContour = length > 2;
+        ++deltaX[wp1];
+        ++deltaX[wq];
+        int span = 0; // x(wq) - x(wp) после сдвига
+        for (size_t i = 1; i < length; ++i) {
+            span += deltaX[contour[i]];
+        }
+        deltaX[vk] = (span - ys[wp] + ys[wq]) / 2;
+        ys[vk] = (span + ys[wp] + ys[wq]) / 2;
+        deltaX[wq] = span - deltaX[vk];
+        if (coversContour) {
+            deltaX[wp1] -= deltaX[vk];
+            left[vk] = wp1;
+            right[contour[length - 2]] = kNone;
+        }
+        right[wp] = vk;
+        right[vk] = wq;
+    }
+
+    xs.assign(n, 0);
+    std::vector<uint32_t> stack(1, v1);
+    while (!stack.empty()) {
+        uint32_t parent = stack.back();
+        stack.pop_back();
+        for (uint32_t child : { left[parent], right[parent] }) {
+            if (child != kNone) {
+                xs[child] = xs[parent] + deltaX[child];
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+} // namespace
+
+PlanarLayout::PlanarLayout(int margin) : m_margin(margin) {}
+
+void PlanarLayout::gridCoordinates(const std::vector<std::vector<size_t>>& embedding, std::vector<int>& xs, std::vector<int>& ys) {
+    GRAPH_PROFILE_SCOPE("layout.planar");
+    const size_t n = embedding.size();
+    if (n <= 3) {
+        // Любые три точки не на одной прямой
+        const int smallX[] = { 0, 2, 1 };
+        const int smallY[] = { 0, 0, 1 };
+        xs.assign(smallX, smallX + n);
+        ys.assign(smallY, smallY + n);
+        return;
+    }
+
+    HalfEdgeEmbedding graph(embedding);
+    connectComponents(graph);
+    uint32_t outer = 0;
+    std::vector<uint32_t> faces = makeBiconnected(graph, outer);
+    for (uint32_t face : faces) {
+        triangulateFace(graph, face);
+    }
+    GRAPH_PROFILE_COUNT("layout.planar.edges.added", graph.numHalfEdges() / 2);
+
+    // Внешняя грань — треугольник, оставшийся у самой длинной грани после триангуляции
+    CanonicalOrdering ordering;
+    canonicalOrdering(graph, graph.origin(outer), graph.target(outer), graph.target(graph.faceNext(outer)), ordering);
+    shiftCoordinates(ordering, xs, ys);
+}
+
+bool PlanarLayout::run(std::vector<Vertex>& vertices, const std::vector<std::vector<size_t>>& embedding, int width, int height) const {
+    if (vertices.empty() || embedding.size() != vertices.size()) {
+        return true;
+    }
+    std::vector<int> xs, ys;
+    gridCoordinates(embedding, xs, ys);
+
+    // Решётка растягивается на холст независимо по осям (аффинное преобразование сохраняет
+    // отсутствие пересечений); ось y переворачивается, чтобы v1 и v2 оказались внизу. Если решётка
+    // помещается на холст, шаг по оси целый, а остаток поля делится поровну по краям: при дробном шаге
+    // округление до пикселей сдвигает почти коллинеарные вершины и может создать пересечения
+    const int areaWidth = std::max(width - 2 * m_margin, 1);
+    const int areaHeight = std::max(height - 2 * m_margin, 1);
+    const int maxX = *std::max_element(xs.begin(), xs.end());
+    const int maxY = *std::max_element(ys.begin(), ys.end());
+    const double stepX = maxX == 0 ? 0 : maxX <= areaWidth ? areaWidth / maxX : static_cast<double>(areaWidth) / maxX;
+    const double stepY = maxY == 0 ? 0 : maxY <= areaHeight ? areaHeight / maxY : static_cast<double>(areaHeight) / maxY;
+    const double offsetX = (areaWidth - stepX * maxX) / 2;
+    const double offsetY = (areaHeight - stepY * maxY) / 2;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        double x = offsetX + xs[i] * stepX;
+        double y = offsetY + (maxY - ys[i]) * stepY;
+        vertices[i].x = m_margin + static_cast<int>(std::lround(x));
+        vertices[i].y = m_margin + static_cast<int>(std::lround(y));
+    }
+    return maxX <= areaWidth && maxY <= areaHeight;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Vertex.h"
+
+// Укладка планарного графа прямыми отрезками без пересечений за O(V) на решётке (2V - 4) x (V - 2):
+// укладка дополняется до триангуляции, строится каноническая нумерация вершин, и вершины добавляются
+// по ней методом сдвигов de Fraysseix–Pach–Pollack с относительными смещениями Chrobak–Payne.
+// Без пересечений рисунок получается, только пока решётка помещается на холст (на 3160 x 2580 с отступами
+// 20 — у любого графа до 1562 вершин): иначе соседние узлы решётки сливаются в один пиксель
+class PlanarLayout {
+public:
+    explicit PlanarLayout(int margin = 20); // Отступ от края холста в пикселях
+
+    // Расстановка вершин на холсте width x height по планарной укладке (PlanarityResult::embedding:
+    // соседи каждой вершины по часовой стрелке, embedding.size() == vertices.size());
+    // прежние координаты вершин не используются. Возвращает false, если решётка не поместилась на холст:
+    // тогда она сжата с дробным шагом, и округление до пикселей может создать пересечения рёбер
+    bool run(std::vector<Vertex>& vertices, const std::vector<std::vector<size_t>>& embedding, int width, int height) const;
+
+    // Целочисленные координаты вершин на решётке, без масштабирования
+    static void gridCoordinates(const std::vector<std::vector<size_t>>& embedding, std::vector<int>& xs, std::vector<int>& ys);
+
+private:
+    int m_margin;
+};
@@ -0,0 +1,226 @@
+#include "PlanarityFilter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include "Profiler.h"
+
+namespace {
+
+// Наименьший граф Куратовского K3,3 имеет 9 рёбер: граф с меньшим числом простых рёбер планарен
+const size_t kMinNonPlanarEdges = 9;
+
+// Система непересекающихся множеств с чётностью пути до корня: ребро между вершинами одной
+// компоненты с одинаковой чётностью замыкает нечётный цикл, и компонента перестаёт быть двудольной
+class ParityUnionFind {
+public:
+    explicit ParityUnionFind(size_t n) : m_parent(n), m_parity(n, 0), m_size(n, 1), m_edges(n, 0), m_bipartite(n, 1) {
+        for (size_t v = 0; v < n; ++v) {
+            m_parent[v] = static_cast<uint32_t>(v);
+        }
+    }
+
+    void addEdge(uint32_t u, uint32_t v) {
+        uint32_t parityU, parityV;
+        uint32_t rootU = find(u, parityU);
+        uint32_t rootV = find(v, parityV);
+        if (rootU == rootV) {
+            ++m_edges[rootU];
+            if (parityU == parityV) {
+                m_bipartite[rootU] = 0;
+            }
+            return;
+        }
+        if (m_size[rootU] < m_size[rootV]) {
+            std::swap(rootU, rootV);
+        }
+        m_parent[rootV] = rootU;
+        m_parity[rootV] = static_cast<uint8_t>(parityU ^ parityV ^ 1); // Концы ребра получают разную чётность
+        m_size[rootU] += m_size[rootV];
+        m_edges[rootU] += m_edges[rootV] + 1;
+        m_bipartite[rootU] &= m_bipartite[rootV];
+    }
+
+    // Нарушает ли какая-либо компонента оценку Эйлера
+    bool violatesEulerBound() const {
+        for (size_t v = 0; v < m_parent.size(); ++v) {
+            if (m_parent[v] != v || m_size[v] < 3) {
+                continue;
+            }
+            uint64_t vertices = m_size[v];
+            if (m_edges[v] > 3 * vertices - 6 || (m_bipartite[v] && m_edges[v] > 2 * vertices - 4)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // Корень множества и чётность пути до него; путь сжимается вторым проходом
+    uint32_t find(uint32_t v, uint32_t& parity) {
+        uint32_t root = v;
+        uint32_t total = 0;
+        while (m_parent[root] != root) {
+            total ^= m_parity[root];
+            root = m_parent[root];
+        }
+        uint32_t current = v;
+        uint32_t currentParity = total;
+        while (current != root && m_parent[current] != root) {
+            uint32_t next = m_parent[current];
+            uint32_t own = m_parity[current];
+            m_parent[current] = root;
+            m_parity[current] = static_cast<uint8_t>(currentParity);
+            currentParity ^= own;
+            current = next;
+        }
+        parity = total;
+        return root;
+    }
+
+    std::vector<uint32_t> m_parent;
+    std::vector<uint8_t> m_parity; // Чётность ребра до родителя
+    std::vector<uint32_t> m_size;
+    std::vector<uint64_t> m_edges;
+    std::vector<uint8_t> m_bipartite;
+};
+
+} // namespace
+
+std::vector<size_t> PlanarityKernel::originalPath(size_t from, size_t to) const {
+    // Двоичный поиск группы меньшего конца, затем просмотр группы (её размер не больше степени вершины)
+    const size_t low = std::min(from, to), high = std::max(from, to);
+    auto edge = std::lower_bound(edges.begin(), edges.end(), low, [](const Edge& e, size_t v) { return e.vertex1 < v; });
+    while (edge != edges.end() && edge->vertex1 == low && edge->vertex2 != high) {
+        ++edge;
+    }
+    if (edge == edges.end() || edge->vertex1 != low) {
+        return std::vector<size_t>();
+    }
+    size_t i = static_cast<size_t>(edge - edges.begin());
+    std::vector<size_t> path(pathVertices.begin() + pathOffsets[i], pathVertices.begin() + pathOffsets[i + 1]);
+    if (edge->vertex1 != from) {
+        std::reverse(path.begin(), path.end());
+    }
+    return path;
+}
+
+PrefilterVerdict checkEulerBounds(const GraphIndex& index) {
+    GRAPH_PROFILE_SCOPE("planarity.prefilter");
+    const size_t n = index.numVertices();
+    ParityUnionFind components(n);
+    size_t simpleEdges = 0;
+    for (uint32_t u = 0; u < n; ++u) {
+        for (const uint32_t* w = index.neighborsBegin(u); w != index.neighborsEnd(u); ++w) {
+            if (*w > u) { // Каждое ребро один раз, петли пропускаются
+                components.addEdge(u, *w);
+                ++simpleEdges;
+            }
+        }
+    }
+    if (simpleEdges < kMinNonPlanarEdges) {
+        return PrefilterVerdict::Planar;
+    }
+    if (components.violatesEulerBound()) {
+        GRAPH_PROFILE_COUNT("planarity.prefilter.rejected", 1);
+        return PrefilterVerdict::NonPlanar;
+    }
+    return PrefilterVerdict::Undecided;
+}
+
+PrefilterVerdict reducePlanarityKernel(const GraphIndex& index, PlanarityKernel& kernel) {
+    GRAPH_PROFILE_SCOPE("planarity.kernel");
+    const size_t n = index.numVertices();
+    kernel = PlanarityKernel();
+
+    // Степени без петель; вершины степени не больше 1 срезаются очередью, пока такие есть
+    std::vector<uint32_t> degree(n);
+    std::vector<uint8_t> removed(n, 0);
+    std::vector<uint32_t> queue;
+    for (uint32_t v = 0; v < n; ++v) {
+        uint32_t d = static_cast<uint32_t>(index.degree(v));
+        if (std::binary_search(index.neighborsBegin(v), index.neighborsEnd(v), v)) {
+            --d;
+        }
+        degree[v] = d;
+        if (d <= 1) {
+            queue.push_back(v);
+        }
+    }
+    for (size_t i = 0; i < queue.size(); ++i) {
+        uint32_t v = queue[i];
+        removed[v] = 1;
+        for (const uint32_t* w = index.neighborsBegin(v); w != index.neighborsEnd(v); ++w) {
+            if (*w != v && !removed[*w] && --degree[*w] == 1) {
+                queue.push_back(*w);
+            }
+        }
+    }
+
+    // Вершины ядра — оставшиеся вершины степени не меньше 3
+    std::vector<uint32_t> kernelId(n, UINT32_MAX);
+    for (uint32_t v = 0; v < n; ++v) {
+        if (!removed[v] && degree[v] >= 3) {
+            kernelId[v] = static_cast<uint32_t>(kernel.originalVertex.size());
+            kernel.originalVertex.push_back(v);
+        }
+    }
+    kernel.numVertices = kernel.originalVertex.size();
+
+    // Цепочки: из каждой вершины ядра по каждому оставшемуся ребру идём через вершины степени 2
+    // до следующей вершины ядра. Цепочка проходится с обоих концов и записывается с меньшего,
+    // поэтому рёбра ядра идут группами по меньшему концу. Цепочка, вернувшаяся в начало, дала бы петлю
+    // и отбрасывается; из параллельных цепочек остаётся первая. Циклы без вершин ядра планарны
+    // и в ядро не попадают
+    std::vector<size_t> lastEdge(kernel.numVertices, SIZE_MAX); // Последнее ребро ядра к этой вершине
+    std::vector<size_t> chain;
+    kernel.edges.reserve(index.numEdges());
+    kernel.pathVertices.reserve(2 * index.numEdges());
+    kernel.pathOffsets.reserve(index.numEdges() + 1);
+    kernel.pathOffsets.push_back(0);
+    for (size_t k = 0; k < kernel.numVertices; ++k) {
+        const size_t groupStart = kernel.edges.size();
+        uint32_t start = static_cast<uint32_t>(kernel.originalVertex[k]);
+        for (const uint32_t* w = index.neighborsBegin(start); w != index.neighborsEnd(start); ++w) {
+            if (*w == start || removed[*w] || kernelId[*w] < k) {
+                continue;
+            }
+            chain.assign(1, start);
+            uint32_t previous = start;
+            uint32_t current = *w;
+            while (kernelId[current] == UINT32_MAX) {
+                chain.push_back(current);
+                uint32_t next = previous;
+                for (const uint32_t* x = index.neighborsBegin(current); x != index.neighborsEnd(current); ++x) {
+                    if (*x != current && *x != previous && !removed[*x]) {
+                        next = *x;
+                        break;
+                    }
+                }
+                previous = current;
+                current = next;
+            }
+            chain.push_back(current);
+            size_t end = kernelId[current];
+            if (end <= k || (lastEdge[end] != SIZE_MAX && lastEdge[end] >= groupStart)) {
+                continue;
+            }
+            lastEdge[end] = kernel.edges.size();
+            kernel.edges.push_back({ k, end });
+            kernel.pathVertices.insert(kernel.pathVertices.end(), chain.begin(), chain.end());
+            kernel.pathOffsets.push_back(kernel.pathVertices.size());
+        }
+    }
+
+    if (kernel.edges.size() < kMinNonPlanarEdges) {
+        return PrefilterVerdict::Planar;
+    }
+    ParityUnionFind components(kernel.numVertices);
+    for (const Edge& edge : kernel.edges) {
+        components.addEdge(static_cast<uint32_t>(edge.vertex1), static_cast<uint32_t>(edge.vertex2));
+    }
+    if (components.violatesEulerBound()) {
+        GRAPH_PROFILE_COUNT("planarity.prefilter.rejected", 1);
+        return PrefilterVerdict::NonPlanar;
+    }
+    return PrefilterVerdict::Undecided;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Edge.h"
+#include "GraphIndex.h"
+
+// Вердикт дешёвой предварительной проверки планарности
+enum class PrefilterVerdict {
+    Planar,
+    NonPlanar,
+    Undecided // Нужен полный тест
+};
+
+// Ядро графа: петли и кратные рёбра отброшены, висячие деревья срезаны, цепочки через вершины
+// степени 2 стянуты в рёбра. Ядро планарно тогда и только тогда, когда планарен исходный граф;
+// его вершины — вершины степени не меньше 3, оставшиеся после срезания деревьев
+struct PlanarityKernel {
+    size_t numVertices;
+    std::vector<Edge> edges; // Простые рёбра ядра (vertex1 < vertex2), сгруппированные по возрастанию vertex1
+    std::vector<size_t> originalVertex; // Номер вершины ядра в исходном графе
+    // Пути исходного графа для рёбер ядра подряд в одном массиве: путь ребра i (от vertex1 к vertex2)
+    // занимает pathVertices[pathOffsets[i] .. pathOffsets[i + 1])
+    std::vector<size_t> pathOffsets;
+    std::vector<size_t> pathVertices;
+
+    PlanarityKernel() : numVertices(0) {}
+
+    // Путь исходного графа между смежными вершинами ядра (в порядке from → to); пустой, если ребра нет
+    std::vector<size_t> originalPath(size_t from, size_t to) const;
+};
+
+// Оценки по формуле Эйлера для каждой компоненты связности (система непересекающихся множеств):
+// простой планарный граф с V >= 3 вершинами имеет не больше 3V - 6 рёбер, а двудольный (без треугольников) —
+// не больше 2V - 4. Двудольность компоненты проверяется тем же проходом по чётности путей до корня.
+// Возвращает NonPlanar при нарушении оценки, Planar для графов меньше чем с 9 рёбрами
+// (у K3,3 их 9, у K5 — 10), иначе Undecided. O(V + E α(V))
+PrefilterVerdict checkEulerBounds(const GraphIndex& index);
+
+// Построение ядра за O(V + E) и повторная проверка оценок Эйлера уже на ядре, где они заметно точнее:
+// пустое или маленькое ядро — Planar, нарушение оценки — NonPlanar, иначе Undecided
+PrefilterVerdict reducePlanarityKernel(const GraphIndex& index, PlanarityKernel& kernel);
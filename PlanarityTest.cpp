@@ -0,0 +1,906 @@
+#include "PlanarityTest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include "PlanarityFilter.h"
+#include "Profiler.h"
+
+namespace {
+
+// Простой граф без петель и кратных рёбер в компактном виде (списки смежности с номерами рёбер)
+struct SimpleGraph {
+    size_t numVertices;
+    std::vector<uint32_t> edgeA; // Концы рёбер
+    std::vector<uint32_t> edgeB;
+    std::vector<uint32_t> adjOffset; // Смещения списков смежности (numVertices + 1)
+    std::vector<uint32_t> adjEdge; // Номера инцидентных рёбер
+
+    size_t numEdges() const { return edgeA.size(); }
+};
+
+// Построение списков смежности по массивам концов рёбер
+void buildAdjacency(SimpleGraph& graph) {
+    graph.adjOffset.assign(graph.numVertices + 1, 0);
+    for (size_t e = 0; e < graph.numEdges(); ++e) {
+        ++graph.adjOffset[graph.edgeA[e] + 1];
+        ++graph.adjOffset[graph.edgeB[e] + 1];
+    }
+    for (size_t v = 0; v < graph.numVertices; ++v) {
+        graph.adjOffset[v + 1] += graph.adjOffset[v];
+    }
+    graph.adjEdge.resize(graph.adjOffset[graph.numVertices]);
+    std::vector<uint32_t> fill(graph.adjOffset.begin(), graph.adjOffset.end() - 1);
+    for (size_t e = 0; e < graph.numEdges(); ++e) {
+        graph.adjEdge[fill[graph.edgeA[e]]++] = static_cast<uint32_t>(e);
+        graph.adjEdge[fill[graph.edgeB[e]]++] = static_cast<uint32_t>(e);
+    }
+}
+
+// Построение простого графа по индексу смежности: списки соседей уже без повторов, остаётся отбросить петли
+SimpleGraph makeSimpleGraph(const GraphIndex& index) {
+    SimpleGraph graph;
+    graph.numVertices = index.numVertices();
+    graph.edgeA.reserve(index.numEdges());
+    graph.edgeB.reserve(index.numEdges());
+    for (uint32_t u = 0; u < graph.numVertices; ++u) {
+        for (const uint32_t* w = index.neighborsBegin(u); w != index.neighborsEnd(u); ++w) {
+            if (*w > u) {
+                graph.edgeA.push_back(u);
+                graph.edgeB.push_back(*w);
+            }
+        }
+    }
+    buildAdjacency(graph);
+    return graph;
+}
+
+// Простой граф ядра: его рёбра уже без петель и повторов
+SimpleGraph makeSimpleGraph(const PlanarityKernel& kernel) {
+    SimpleGraph graph;
+    graph.numVertices = kernel.numVertices;
+    graph.edgeA.reserve(kernel.edges.size());
+    graph.edgeB.reserve(kernel.edges.size());
+    for (const Edge& edge : kernel.edges) {
+        graph.edgeA.push_back(static_cast<uint32_t>(edge.vertex1));
+        graph.edgeB.push_back(static_cast<uint32_t>(edge.vertex2));
+    }
+    buildAdjacency(graph);
+    return graph;
+}
+
+// Left-right тест планарности. Все обходы в глубину итеративные, чтобы не упираться в размер стека.
+class LRPlanarity {
+public:
+    explicit LRPlanarity(const SimpleGraph& graph) : m_graph(graph) {}
+
+    bool run(bool buildEmbedding);
+    std::vector<std::vector<size_t>> embedding() const;
+
+private:
+    // Интервал рёбер в стеке конфликтов (-1 — пусто)
+    struct Interval {
+        int low;
+        int high;
+        Interval() : low(-1), high(-1) {}
+        Interval(int l, int h) : low(l), high(h) {}
+        bool empty() const { return low < 0 && high < 0; }
+    };
+
+    // Пара конфликтующих интервалов (левая и правая стороны)
+    struct ConflictPair {
+        Interval left;
+        Interval right;
+        void swap() { std::swap(left, right); }
+    };
+
+    int other(int e, int v) const { return static_cast<int>(m_graph.edgeA[e]) == v ? m_graph.edgeB[e] : m_graph.edgeA[e]; }
+    bool conflicting(const Interval& interval, int e) const { return !interval.empty() && m_lowpt[interval.high] > m_lowpt[e]; }
+    int lowest(const ConflictPair& pair) const;
+
+    void orient(int root);
+    bool test(int root);
+    bool addConstraints(int ei, int e);
+    void removeBackEdges(int e);
+    int sign(int e);
+    void sortOutEdges();
+    void embed(int root);
+
+    void addHalfEdgeCw(int vertex, int halfEdge, int reference);
+    void addHalfEdgeCcw(int vertex, int halfEdge, int reference);
+    void addHalfEdgeFirst(int vertex, int halfEdge) { addHalfEdgeCcw(vertex, halfEdge, m_firstHalfEdge[vertex]); }
+
+    const SimpleGraph& m_graph;
+
+    // Ориентация рёбер, полученная обходом в глубину
+    std::vector<int> m_from;
+    std::vector<int> m_to;
+    std::vector<int> m_height;
+    std::vector<int> m_parentEdge;
+    std::vector<int> m_roots;
+
+    // Характеристики рёбер
+    std::vector<int> m_lowpt;
+    std::vector<int> m_lowpt2;
+    std::vector<int> m_nestingDepth;
+    std::vector<int> m_ref;
+    std::vector<int> m_side;
+    std::vector<int> m_lowptEdge;
+    std::vector<size_t> m_stackBottom;
+
+    // Исходящие рёбра каждой вершины, упорядоченные по глубине вложенности
+    std::vector<uint32_t> m_outOffset;
+    std::vector<int> m_outEdge;
+
+    std::vector<ConflictPair> m_conflicts;
+
+    // Рабочие массивы обходов, общие для всех корней
+    std::vector<uint32_t> m_position;
+    std::vector<char> m_returning;
+    std::vector<int> m_stack;
+    std::vector<int> m_chain;
+
+    // Укладка: полурёбра 2e (у начала ребра e) и 2e+1 (у конца) в циклических списках вокруг вершин
+    std::vector<int> m_cw;
+    std::vector<int> m_ccw;
+    std::vector<int> m_firstHalfEdge;
+    std::vector<int> m_leftRef;
+    std::vector<int> m_rightRef;
+};
+
+int LRPlanarity::lowest(const ConflictPair& pair) const {
+    if (pair.left.empty()) {
+        return m_lowpt[pair.right.low];
+    }
+    if (pair.right.empty()) {
+        return m_lowpt[pair.left.low];
+    }
+    return std::min(m_lowpt[pair.left.low], m_lowpt[pair.right.low]);
+}
+
+bool LRPlanarity::run(bool buildEmbedding) {
+    const size_t n = m_graph.numVertices;
+    const size_t m = m_graph.numEdges();
+
+    // По формуле Эйлера у планарного графа не более 3V-6 рёбер
+    if (n > 2 && m > 3 * n - 6) {
+        return false;
+    }
+
+    m_from.assign(m, -1);
+    m_to.assign(m, -1);
+    m_height.assign(n, -1);
+    m_parentEdge.assign(n, -1);
+    m_lowpt.assign(m, 0);
+    m_lowpt2.assign(m, 0);
+    m_nestingDepth.assign(m, 0);
+    m_roots.clear();
+    m_position.assign(m_graph.adjOffset.begin(), m_graph.adjOffset.end() - 1);
+
+    // Фаза 1: ориентация рёбер обходом в глубину
+    for (size_t v = 0; v < n; ++v) {
+        if (m_height[v] < 0) {
+            m_height[v] = 0;
+            m_roots.push_back(static_cast<int>(v));
+            orient(static_cast<int>(v));
+        }
+    }
+
+    // Фаза 2: проверка ограничений left-right
+    m_ref.assign(m, -1);
+    m_side.assign(m, 1);
+    m_lowptEdge.assign(m, -1);
+    m_stackBottom.assign(m, 0);
+    m_conflicts.clear();
+    sortOutEdges();
+    m_position.assign(m_outOffset.begin(), m_outOffset.end() - 1);
+    m_returning.assign(n, 0);
+    for (size_t i = 0; i < m_roots.size(); ++i) {
+        if (!test(m_roots[i])) {
+            return false;
+        }
+    }
+
+    if (!buildEmbedding) {
+        return true;
+    }
+
+    // Фаза 3: построение укладки
+    for (size_t e = 0; e < m; ++e) {
+        m_nestingDepth[e] *= sign(static_cast<int>(e));
+    }
+    sortOutEdges();
+
+    m_cw.assign(2 * m, -1);
+    m_ccw.assign(2 * m, -1);
+    m_firstHalfEdge.assign(n, -1);
+    m_leftRef.assign(n, -1);
+    m_rightRef.assign(n, -1);
+    m_position.assign(m_outOffset.begin(), m_outOffset.end() - 1);
+    for (size_t v = 0; v < n; ++v) {
+        int previous = -1;
+        for (uint32_t i = m_outOffset[v]; i < m_outOffset[v + 1]; ++i) {
+            int halfEdge = 2 * m_outEdge[i];
+            addHalfEdgeCw(static_cast<int>(v), halfEdge, previous);
+            previous = halfEdge;
+        }
+    }
+    for (size_t i = 0; i < m_roots.size(); ++i) {
+        embed(m_roots[i]);
+    }
+    return true;
+}
+
+void LRPlanarity::orient(int root) {
+    std::vector<uint32_t>& position = m_position;
+    std::vector<int>& stack = m_stack;
+    stack.assign(1, root);
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        int e = m_parentEdge[v];
+        for (; position[v] < m_graph.adjOffset[v + 1]; ++position[v]) {
+            int vw = m_graph.adjEdge[position[v]];
+            if (m_from[vw] >= 0) {
+                if (m_from[vw] != v) {
+                    continue; // Ребро уже ориентировано с другой стороны
+                }
+                // Иначе это древесное ребро, обход поддерева которого только что завершился
+            }
+            else {
+                int w = other(vw, v);
+                m_from[vw] = v;
+                m_to[vw] = w;
+                m_lowpt[vw] = m_height[v];
+                m_lowpt2[vw] = m_height[v];
+                if (m_height[w] < 0) { // Древесное ребро
+                    m_parentEdge[w] = vw;
+                    m_height[w] = m_height[v] + 1;
+                    stack.push_back(v);
+                    stack.push_back(w);
+                    break;
+                }
+                m_lowpt[vw] = m_height[w]; // Обратное ребро
+            }
+
+            // Глубина вложенности ребра
+            m_nestingDepth[vw] = 2 * m_lowpt[vw];
+            if (m_lowpt2[vw] < m_height[v]) {
+                m_nestingDepth[vw] += 1; // Хордальное ребро
+            }
+
+            // Обновление точек возврата родительского ребра
+            if (e >= 0) {
+                if (m_lowpt[vw] < m_lowpt[e]) {
+                    m_lowpt2[e] = std::min(m_lowpt[e], m_lowpt2[vw]);
+                    m_lowpt[e] = m_lowpt[vw];
+                }
+                else if (m_lowpt[vw] > m_lowpt[e]) {
+                    m_lowpt2[e] = std::min(m_lowpt2[e], m_lowpt[vw]);
+                }
+                else {
+                    m_lowpt2[e] = std::min(m_lowpt2[e], m_lowpt2[vw]);
+                }
+            }
+        }
+    }
+}
+
+void LRPlanarity::sortOutEdges() {
+    // Сортировка подсчётом по глубине вложенности: значения лежат в [-(2V+1), 2V+1]
+    const size_t n = m_graph.numVertices;
+    const size_t m = m_graph.numEdges();
+    const int offset = static_cast<int>(2 * n + 1);
+    std::vector<uint32_t> bucket(2 * offset + 2, 0);
+    for (size_t e = 0; e < m; ++e) {
+        ++bucket[m_nestingDepth[e] + offset + 1];
+    }
+    for (size_t i = 1; i < bucket.size(); ++i) {
+        bucket[i] += bucket[i - 1];
+    }
+    std::vector<int> sorted(m);
+    for (size_t e = 0; e < m; ++e) {
+        sorted[bucket[m_nestingDepth[e] + offset]++] = static_cast<int>(e);
+    }
+
+    m_outOffset.assign(n + 1, 0);
+    for (size_t e = 0; e < m; ++e) {
+        ++m_outOffset[m_from[e] + 1];
+    }
+    for (size_t v = 0; v < n; ++v) {
+        m_outOffset[v + 1] += m_outOffset[v];
+    }
+    m_outEdge.resize(m);
+    std::vector<uint32_t> fill(m_outOffset.begin(), m_outOffset.end() - 1);
+    for (size_t i = 0; i < m; ++i) {
+        int e = sorted[i];
+        m_outEdge[fill[m_from[e]]++] = e;
+    }
+}
+
+bool LRPlanarity::test(int root) {
+    std::vector<uint32_t>& position = m_position;
+    std::vector<char>& returning = m_returning;
+    std::vector<int>& stack = m_stack;
+    stack.assign(1, root);
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        int e = m_parentEdge[v];
+        bool descended = false;
+        for (; position[v] < m_outOffset[v + 1]; ++position[v]) {
+            int ei = m_outEdge[position[v]];
+            int w = m_to[ei];
+            if (!returning[v]) {
+                m_stackBottom[ei] = m_conflicts.size();
+                if (ei == m_parentEdge[w]) { // Древесное ребро: сначала обрабатываем поддерево
+                    returning[v] = 1;
+                    stack.push_back(v);
+                    stack.push_back(w);
+                    descended = true;
+                    break;
+                }
+                // Обратное ребро
+                m_lowptEdge[ei] = ei;
+                ConflictPair pair;
+                pair.right = Interval(ei, ei);
+                m_conflicts.push_back(pair);
+            }
+            else {
+                returning[v] = 0;
+            }
+
+            // Учёт новых обратных рёбер
+            if (m_lowpt[ei] < m_height[v]) {
+                if (position[v] == m_outOffset[v]) {
+                    m_lowptEdge[e] = m_lowptEdge[ei];
+                }
+                else if (!addConstraints(ei, e)) {
+                    return false;
+                }
+            }
+        }
+        if (!descended && e >= 0) {
+            removeBackEdges(e);
+        }
+    }
+    return true;
+}
+
+bool LRPlanarity::addConstraints(int ei, int e) {
+    ConflictPair pair;
+
+    // Слияние обратных рёбер ei в правую сторону
+    do {
+        ConflictPair q = m_conflicts.back();
+        m_conflicts.pop_back();
+        if (!q.left.empty()) {
+            q.swap();
+        }
+        if (!q.left.empty()) {
+            return false; // Граф непланарен
+        }
+        if (m_lowpt[q.right.low] > m_lowpt[e]) {
+            if (pair.right.empty()) {
+                pair.right.high = q.right.high;
+            }
+            else if (pair.right.low >= 0) {
+                m_ref[pair.right.low] = q.right.high;
+            }
+            pair.right.low = q.right.low;
+        }
+        else if (q.right.low >= 0) {
+            m_ref[q.right.low] = m_lowptEdge[e];
+        }
+    } while (m_conflicts.size() != m_stackBottom[ei]);
+
+    // Слияние конфликтующих обратных рёбер предыдущих сыновей в левую сторону
+    while (!m_conflicts.empty() && (conflicting(m_conflicts.back().left, ei) || conflicting(m_conflicts.back().right, ei))) {
+        ConflictPair q = m_conflicts.back();
+        m_conflicts.pop_back();
+        if (conflicting(q.right, ei)) {
+            q.swap();
+        }
+        if (conflicting(q.right, ei)) {
+            return false; // Граф непланарен
+        }
+        if (pair.right.low >= 0) {
+            m_ref[pair.right.low] = q.right.high;
+        }
+        if (q.right.low >= 0) {
+            pair.right.low = q.right.low;
+        }
+        if (pair.left.empty()) {
+            pair.left.high = q.left.high;
+        }
+        else if (pair.left.low >= 0) {
+            m_ref[pair.left.low] = q.left.high;
+        }
+        pair.left.low = q.left.low;
+    }
+
+    if (!pair.left.empty() || !pair.right.empty()) {
+        m_conflicts.push_back(pair);
+    }
+    return true;
+}
+
+void LRPlanarity::removeBackEdges(int e) {
+    int u = m_from[e];
+
+    // Удаление пар, все рёбра которых возвращаются в u
+    while (!m_conflicts.empty() && lowest(m_conflicts.back()) == m_height[u]) {
+        ConflictPair pair = m_conflicts.back();
+        m_conflicts.pop_back();
+        if (pair.left.low >= 0) {
+            m_side[pair.left.low] = -1;
+        }
+    }
+
+    if (!m_conflicts.empty()) {
+        ConflictPair& pair = m_conflicts.back();
+
+        // Усечение левого интервала
+        while (pair.left.high >= 0 && m_to[pair.left.high] == u) {
+            pair.left.high = m_ref[pair.left.high];
+        }
+        if (pair.left.high < 0 && pair.left.low >= 0) {
+            m_ref[pair.left.low] = pair.right.low;
+            m_side[pair.left.low] = -1;
+            pair.left.low = -1;
+        }
+
+        // Усечение правого интервала
+        while (pair.right.high >= 0 && m_to[pair.right.high] == u) {
+            pair.right.high = m_ref[pair.right.high];
+        }
+        if (pair.right.high < 0 && pair.right.low >= 0) {
+            m_ref[pair.right.low] = pair.left.low;
+            m_side[pair.right.low] = -1;
+            pair.right.low = -1;
+        }
+    }
+
+    // Сторона ребра e совпадает со стороной его самого высокого обратного ребра
+    if (m_lowpt[e] < m_height[u] && !m_conflicts.empty()) {
+        int hl = m_conflicts.back().left.high;
+        int hr = m_conflicts.back().right.high;
+        if (hl >= 0 && (hr < 0 || m_lowpt[hl] > m_lowpt[hr])) {
+            m_ref[e] = hl;
+        }
+        else {
+            m_ref[e] = hr;
+        }
+    }
+}
+
+int LRPlanarity::sign(int e) {
+    // Итеративное разрешение цепочки ссылок: side[e] *= side[ref[e]], начиная с конца цепочки
+    std::vector<int>& chain = m_chain;
+    chain.clear();
+    for (int x = e; m_ref[x] >= 0; x = m_ref[x]) {
+        chain.push_back(x);
+    }
+    for (size_t i = chain.size(); i-- > 0;) {
+        int x = chain[i];
+        m_side[x] *= m_side[m_ref[x]];
+        m_ref[x] = -1;
+    }
+    return m_side[e];
+}
+
+void LRPlanarity::addHalfEdgeCw(int vertex, int halfEdge, int reference) {
+    if (reference < 0) {
+        m_cw[halfEdge] = halfEdge;
+        m_ccw[halfEdge] = halfEdge;
+        m_firstHalfEdge[vertex] = halfEdge;
+        return;
+    }
+    int next = m_cw[reference];
+    m_cw[reference] = halfEdge;
+    m_ccw[halfEdge] = reference;
+    m_cw[halfEdge] = next;
+    m_ccw[next] = halfEdge;
+}
+
+void LRPlanarity::addHalfEdgeCcw(int vertex, int halfEdge, int reference) {
+    if (reference < 0) {
+        addHalfEdgeCw(vertex, halfEdge, -1);
+        return;
+    }
+    addHalfEdgeCw(vertex, halfEdge, m_ccw[reference]);
+    if (reference == m_firstHalfEdge[vertex]) {
+        m_firstHalfEdge[vertex] = halfEdge;
+    }
+}
+
+void LRPlanarity::embed(int root) {
+    std::vector<uint32_t>& position = m_position;
+    std::vector<int>& stack = m_stack;
+    stack.assign(1, root);
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        while (position[v] < m_outOffset[v + 1]) {
+            int ei = m_outEdge[position[v]++];
+            int w = m_to[ei];
+            if (ei == m_parentEdge[w]) { // Древесное ребро
+                addHalfEdgeFirst(w, 2 * ei + 1);
+                m_leftRef[v] = 2 * ei;
+                m_rightRef[v] = 2 * ei;
+                stack.push_back(v);
+                stack.push_back(w);
+                break;
+            }
+            // Обратное ребро вставляется в список вершины w рядом с опорным полуребром
+            if (m_side[ei] == 1) {
+                addHalfEdgeCw(w, 2 * ei + 1, m_rightRef[w]);
+            }
+            else {
+                addHalfEdgeCcw(w, 2 * ei + 1, m_leftRef[w]);
+                m_leftRef[w] = 2 * ei + 1;
+            }
+        }
+    }
+}
+
+std::vector<std::vector<size_t>> LRPlanarity::embedding() const {
+    std::vector<std::vector<size_t>> result(m_graph.numVertices);
+    for (size_t v = 0; v < m_graph.numVertices; ++v) {
+        int first = m_firstHalfEdge[v];
+        if (first < 0) {
+            continue;
+        }
+        result[v].reserve(m_graph.adjOffset[v + 1] - m_graph.adjOffset[v]);
+        int halfEdge = first;
+        do {
+            int e = halfEdge >> 1;
+            result[v].push_back(static_cast<size_t>((halfEdge & 1) ? m_from[e] : m_to[e]));
+            halfEdge = m_cw[halfEdge];
+        } while (halfEdge != first);
+    }
+    return result;
+}
+
+// Подграфы исходного графа, заданные списком номеров рёбер. Вершины перенумеровываются,
+// поэтому стоимость операций пропорциональна размеру подграфа, а не всего графа.
+class SubgraphTester {
+public:
+    SubgraphTester(const SimpleGraph& graph, size_t workLimit)
+        : m_graph(graph), m_localId(graph.numVertices, UINT32_MAX), m_work(0), m_workLimit(workLimit) {}
+
+    // Суммарное число рёбер всех построенных подграфов превысило предел
+    bool exhausted() const { return m_work > m_workLimit; }
+
+    // Проверка планарности подграфа из рёбер subset[begin, end) и subset[skipEnd, size)
+    bool isPlanar(const std::vector<uint32_t>& subset, size_t begin, size_t skipEnd) {
+        SimpleGraph& sub = makeSubgraph(subset, begin, skipEnd);
+        LRPlanarity planarity(sub);
+        return planarity.run(false);
+    }
+
+    // Удаление висячих рёбер: вершины степени 1 не входят в минимальный непланарный подграф
+    void prunePendant(std::vector<uint32_t>& subset) {
+        SimpleGraph& sub = makeSubgraph(subset, subset.size(), subset.size());
+        std::vector<uint32_t> degree(sub.numVertices);
+        std::vector<uint32_t> queue;
+        for (uint32_t v = 0; v < sub.numVertices; ++v) {
+            degree[v] = sub.adjOffset[v + 1] - sub.adjOffset[v];
+            if (degree[v] == 1) {
+                queue.push_back(v);
+            }
+        }
+        std::vector<char> removed(subset.size(), 0);
+        while (!queue.empty()) {
+            uint32_t v = queue.back();
+            queue.pop_back();
+            for (uint32_t i = sub.adjOffset[v]; i < sub.adjOffset[v + 1]; ++i) {
+                uint32_t e = sub.adjEdge[i];
+                if (removed[e]) {
+                    continue;
+                }
+                removed[e] = 1;
+                uint32_t w = sub.edgeA[e] == v ? sub.edgeB[e] : sub.edgeA[e];
+                if (--degree[w] == 1) {
+                    queue.push_back(w);
+                }
+            }
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < subset.size(); ++i) {
+            if (!removed[i]) {
+                subset[count++] = subset[i];
+            }
+        }
+        subset.resize(count);
+    }
+
+    // Разбиение подграфа на цепочки: максимальные пути через вершины степени 2.
+    // Для минимальности все рёбра цепочки нужны или не нужны одновременно, поэтому их удобно удалять целиком.
+    std::vector<std::vector<uint32_t>> chains(const std::vector<uint32_t>& subset) {
+        SimpleGraph& sub = makeSubgraph(subset, subset.size(), subset.size());
+        std::vector<std::vector<uint32_t>> result;
+        std::vector<char> visited(subset.size(), 0);
+        for (int pass = 0; pass < 2; ++pass) {
+            // Первый проход начинает цепочки в вершинах степени не 2, второй собирает оставшиеся циклы
+            for (uint32_t v = 0; v < sub.numVertices; ++v) {
+                bool junction = sub.adjOffset[v + 1] - sub.adjOffset[v] != 2;
+                if (junction == (pass == 1)) {
+                    continue;
+                }
+                for (uint32_t i = sub.adjOffset[v]; i < sub.adjOffset[v + 1]; ++i) {
+                    uint32_t e = sub.adjEdge[i];
+                    if (visited[e]) {
+                        continue;
+                    }
+                    std::vector<uint32_t> chain;
+                    uint32_t current = v;
+                    while (!visited[e]) {
+                        visited[e] = 1;
+                        chain.push_back(subset[e]);
+                        current = sub.edgeA[e] == current ? sub.edgeB[e] : sub.edgeA[e];
+                        if (sub.adjOffset[current + 1] - sub.adjOffset[current] != 2) {
+                            break;
+                        }
+                        uint32_t first = sub.adjEdge[sub.adjOffset[current]];
+                        e = first == e ? sub.adjEdge[sub.adjOffset[current] + 1] : first;
+                    }
+                    result.push_back(chain);
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    SimpleGraph& makeSubgraph(const std::vector<uint32_t>& subset, size_t begin, size_t skipEnd) {
+        m_work += subset.size();
+        m_sub.numVertices = 0;
+        m_sub.edgeA.clear();
+        m_sub.edgeB.clear();
+        m_touched.clear();
+        for (size_t i = 0; i < subset.size(); ++i) {
+            if (i == begin) {
+                i = skipEnd;
+                if (i >= subset.size()) {
+                    break;
+                }
+            }
+            m_sub.edgeA.push_back(localId(m_graph.edgeA[subset[i]]));
+            m_sub.edgeB.push_back(localId(m_graph.edgeB[subset[i]]));
+        }
+        for (size_t i = 0; i < m_touched.size(); ++i) {
+            m_localId[m_touched[i]] = UINT32_MAX;
+        }
+        buildAdjacency(m_sub);
+        return m_sub;
+    }
+
+    uint32_t localId(uint32_t v) {
+        if (m_localId[v] == UINT32_MAX) {
+            m_localId[v] = static_cast<uint32_t>(m_sub.numVertices++);
+            m_touched.push_back(v);
+        }
+        return m_localId[v];
+    }
+
+    const SimpleGraph& m_graph;
+    SimpleGraph m_sub;
+    std::vector<uint32_t> m_localId;
+    std::vector<uint32_t> m_touched;
+    size_t m_work;
+    size_t m_workLimit;
+};
+
+// Выделение подразбиения Куратовского: удаляем рёбра блоками, пока граф остаётся непланарным.
+// Оставшийся рёберно-минимальный непланарный подграф по теореме Куратовского — подразбиение K5 или K3,3.
+// Требует O(k log E) проверок планарности, где k — число цепочек подразбиения, и каждая проверка стоит
+// O(E) на текущем подграфе, то есть всего O(k E log E). Если сумма рёбер проверяемых подграфов
+// превышает workLimit, поиск прекращается и возвращается пустой результат (тип None)
+KuratowskiSubgraph findKuratowskiSubgraph(const SimpleGraph& graph, size_t workLimit) {
+    SubgraphTester tester(graph, workLimit);
+    std::vector<uint32_t> kept(graph.numEdges());
+    for (size_t e = 0; e < kept.size(); ++e) {
+        kept[e] = static_cast<uint32_t>(e);
+    }
+
+    // Кратчайший непланарный префикс списка рёбер (двоичный поиск)
+    size_t planarPrefix = 0;
+    size_t nonPlanarPrefix = kept.size();
+    while (nonPlanarPrefix - planarPrefix > 1) {
+        size_t middle = planarPrefix + (nonPlanarPrefix - planarPrefix) / 2;
+        if (tester.isPlanar(kept, middle, kept.size())) {
+            planarPrefix = middle;
+        }
+        else {
+            nonPlanarPrefix = middle;
+        }
+        if (tester.exhausted()) {
+            return KuratowskiSubgraph();
+        }
+    }
+    kept.resize(nonPlanarPrefix);
+    tester.prunePendant(kept);
+
+    // Удаление блоков цепочек с уменьшением размера блока вплоть до одной цепочки.
+    // Заканчиваем, когда проход с блоком из одной цепочки ничего не удалил: тогда каждое ребро необходимо.
+    std::vector<std::vector<uint32_t>> units = tester.chains(kept);
+    std::vector<uint32_t> candidate;
+    for (size_t chunk = std::max<size_t>(units.size() / 2, 1);; chunk = std::max<size_t>(chunk / 2, 1)) {
+        bool removedAny = false;
+        for (size_t i = 0; i < units.size();) {
+            size_t end = std::min(i + chunk, units.size());
+            candidate.clear();
+            for (size_t u = 0; u < units.size(); ++u) {
+                if (u < i || u >= end) {
+                    candidate.insert(candidate.end(), units[u].begin(), units[u].end());
+                }
+            }
+            if (!tester.isPlanar(candidate, candidate.size(), candidate.size())) {
+                // Блок не нужен для непланарности
+                kept.swap(candidate);
+                tester.prunePendant(kept);
+                units = tester.chains(kept);
+                removedAny = true;
+            }
+            else {
+                i = end;
+            }
+            if (tester.exhausted()) {
+                return KuratowskiSubgraph();
+            }
+        }
+        if (chunk == 1 && !removedAny) {
+            break;
+        }
+    }
+
+    KuratowskiSubgraph result;
+    SimpleGraph witness;
+    witness.numVertices = graph.numVertices;
+    for (size_t i = 0; i < kept.size(); ++i) {
+        witness.edgeA.push_back(graph.edgeA[kept[i]]);
+        witness.edgeB.push_back(graph.edgeB[kept[i]]);
+        result.edges.push_back({ graph.edgeA[kept[i]], graph.edgeB[kept[i]] });
+    }
+    buildAdjacency(witness);
+
+    // Ветвящиеся вершины — вершины степени не меньше 3
+    for (size_t v = 0; v < witness.numVertices; ++v) {
+        if (witness.adjOffset[v + 1] - witness.adjOffset[v] >= 3) {
+            result.branchVertices.push_back(v);
+        }
+    }
+
+    // Пути между ветвящимися вершинами через вершины степени 2
+    std::vector<char> usedEdge(witness.numEdges(), 0);
+    std::vector<std::vector<char>> linked(result.branchVertices.size(), std::vector<char>(witness.numVertices, 0));
+    for (size_t b = 0; b < result.branchVertices.size(); ++b) {
+        uint32_t start = static_cast<uint32_t>(result.branchVertices[b]);
+        for (uint32_t i = witness.adjOffset[start]; i < witness.adjOffset[start + 1]; ++i) {
+            uint32_t e = witness.adjEdge[i];
+            if (usedEdge[e]) {
+                continue;
+            }
+            std::vector<size_t> path(1, start);
+            uint32_t current = start;
+            while (true) {
+                usedEdge[e] = 1;
+                current = witness.edgeA[e] == current ? witness.edgeB[e] : witness.edgeA[e];
+                path.push_back(current);
+                if (witness.adjOffset[current + 1] - witness.adjOffset[current] != 2) {
+                    break;
+                }
+                uint32_t first = witness.adjEdge[witness.adjOffset[current]];
+                e = first == e ? witness.adjEdge[witness.adjOffset[current] + 1] : first;
+            }
+            linked[b][current] = 1;
+            result.paths.push_back(path);
+        }
+    }
+
+    if (result.branchVertices.size() == 5) {
+        result.type = KuratowskiType::K5;
+    }
+    else if (result.branchVertices.size() == 6) {
+        result.type = KuratowskiType::K33;
+        // Первая доля: первая ветвящаяся вершина и вершины, не соединённые с ней путём
+        std::vector<size_t> sideA, sideB;
+        for (size_t i = 0; i < result.branchVertices.size(); ++i) {
+            size_t v = result.branchVertices[i];
+            (i == 0 || !linked[0][v] ? sideA : sideB).push_back(v);
+        }
+        result.branchVertices = sideA;
+        result.branchVertices.insert(result.branchVertices.end(), sideB.begin(), sideB.end());
+    }
+    return result;
+}
+
+// Перенос подразбиения, найденного в ядре, на исходный граф: вершины получают исходные номера,
+// а каждое ребро ядра на путях заменяется цепочкой, которую оно стягивает
+KuratowskiSubgraph mapKernelWitness(const KuratowskiSubgraph& witness, const PlanarityKernel& kernel) {
+    KuratowskiSubgraph result;
+    result.type = witness.type;
+    for (size_t v : witness.branchVertices) {
+        result.branchVertices.push_back(kernel.originalVertex[v]);
+    }
+    for (const auto& path : witness.paths) {
+        std::vector<size_t> original(1, kernel.originalVertex[path.front()]);
+        for (size_t i = 0; i + 1 < path.size(); ++i) {
+            std::vector<size_t> chain = kernel.originalPath(path[i], path[i + 1]);
+            original.insert(original.end(), chain.begin() + 1, chain.end());
+        }
+        for (size_t i = 0; i + 1 < original.size(); ++i) {
+            result.edges.push_back({ original[i], original[i + 1] });
+        }
+        result.paths.push_back(std::move(original));
+    }
+    return result;
+}
+
+} // namespace
+
+PlanarityResult testPlanarity(const GraphIndex& index, bool extractWitness) {
+    GRAPH_PROFILE_SCOPE("planarity.test");
+    PlanarityResult result;
+
+    // Граф, нарушающий оценки Эйлера, непланарен без полного теста; иначе полный тест на самом графе,
+    // потому что для планарного графа нужна укладка всех его вершин
+    if (checkEulerBounds(index) != PrefilterVerdict::NonPlanar) {
+        SimpleGraph graph = makeSimpleGraph(index);
+        LRPlanarity planarity(graph);
+        result.planar = planarity.run(true);
+        if (result.planar) {
+            result.embedding = planarity.embedding();
+            return result;
+        }
+    }
+    if (!extractWitness) {
+        return result;
+    }
+
+    // Подразбиение Куратовского ищется на ядре: поиск требует многих проверок планарности подграфов,
+    // и на меньшем графе каждая идёт быстрее. Если вершин степени не больше 2 мало, ядро почти совпадает
+    // с графом и не окупает своё построение
+    size_t lowDegree = 0;
+    for (size_t v = 0; v < index.numVertices(); ++v) {
+        lowDegree += index.degree(v) <= 2;
+    }
+    if (lowDegree * 8 >= index.numVertices()) {
+        PlanarityKernel kernel;
+        reducePlanarityKernel(index, kernel);
+        if (kernel.edges.size() <= kWitnessSearchEdges) {
+            KuratowskiSubgraph witness = findKuratowskiSubgraph(makeSimpleGraph(kernel), kWitnessSearchWork);
+            if (witness.type != KuratowskiType::None) {
+                result.kuratowski = mapKernelWitness(witness, kernel);
+            }
+        }
+    }
+    else if (index.numEdges() <= kWitnessSearchEdges) {
+        result.kuratowski = findKuratowskiSubgraph(makeSimpleGraph(index), kWitnessSearchWork);
+    }
+    return result;
+}
+
+bool isPlanar(const GraphIndex& index) {
+    GRAPH_PROFILE_SCOPE("planarity.test");
+    PrefilterVerdict verdict = checkEulerBounds(index);
+    if (verdict != PrefilterVerdict::Undecided) {
+        return verdict == PrefilterVerdict::Planar;
+    }
+    PlanarityKernel kernel;
+    verdict = reducePlanarityKernel(index, kernel);
+    if (verdict != PrefilterVerdict::Undecided) {
+        return verdict == PrefilterVerdict::Planar;
+    }
+    SimpleGraph graph = makeSimpleGraph(kernel);
+    LRPlanarity planarity(graph);
+    return planarity.run(false);
+}
+
+PlanarityResult testPlanarity(size_t numVertices, const std::vector<Edge>& edges, bool extractWitness) {
+    return testPlanarity(GraphIndex(numVertices, edges, false), extractWitness);
+}
+
+bool isPlanar(size_t numVertices, const std::vector<Edge>& edges) {
+    return isPlanar(GraphIndex(numVertices, edges, false));
+}
@@ -0,0 +1,127 @@
+#include "Profiler.h"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace {
+
+// Списки мест замера; дополняются только при первом проходе через место, поэтому хватает одного мьютекса
+struct SiteRegistry {
+    std::mutex mutex;
+    ProfileTimerSite* timers = nullptr;
+    ProfileCounterSite* counters = nullptr;
+};
+
+SiteRegistry& registry() {
+    static SiteRegistry instance;
+    return instance;
+}
+
+struct TimerTotals {
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+};
+
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (; *text != '\0'; ++text) {
+        if (*text == '"' || *text == '\\') {
+            out << '\\';
+        }
+        out << *text;
+    }
+    out << '"';
+}
+
+} // namespace
+
+ProfileTimerSite::ProfileTimerSite(const char* name) : name(name), calls(0), nanoseconds(0), next(nullptr) {
+    Profiler::registerSite(*this);
+}
+
+ProfileCounterSite::ProfileCounterSite(const char* name) : name(name), value(0), next(nullptr) {
+    Profiler::registerSite(*this);
+}
+
+bool Profiler::enabled() {
+#ifdef GRAPH_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::registerSite(ProfileTimerSite& site) {
+    SiteRegistry& sites = registry();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    site.next = sites.timers;
+    sites.timers = &site;
+}
+
+void Profiler::registerSite(ProfileCounterSite& site) {
+    SiteRegistry& sites = registry();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    site.next = sites.counters;
+    sites.counters = &site;
+}
+
+void Profiler::reset() {
+    SiteRegistry& sites = registry();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    for (ProfileTimerSite* site = sites.timers; site != nullptr; site = site->next) {
+        site->calls = 0;
+        site->nanoseconds = 0;
+    }
+    for (ProfileCounterSite* site = sites.counters; site != nullptr; site = site->next) {
+        site->value = 0;
+    }
+}
+
+void Profiler::writeJson(std::ostream& out) {
+    // Места с одинаковым именем (например, один счётчик в нескольких функциях) складываются
+    std::map<std::string, TimerTotals> timers;
+    std::map<std::string, uint64_t> counters;
+    {
+        SiteRegistry& sites = registry();
+        std::lock_guard<std::mutex> lock(sites.mutex);
+        for (ProfileTimerSite* site = sites.timers; site != nullptr; site = site->next) {
+            TimerTotals& totals = timers[site->name];
+            totals.calls += site->calls.load(std::memory_order_relaxed);
+            totals.nanoseconds += site->nanoseconds.load(std::memory_order_relaxed);
+        }
+        for (ProfileCounterSite* site = sites.counters; site != nullptr; site = site->next) {
+            counters[site->name] += site->value.load(std::memory_order_relaxed);
+        }
+    }
+
+    out << "{\n  \"enabled\": " << (enabled() ? "true" : "false") << ",\n  \"timers\": {";
+    const char* separator = "\n";
+    for (const auto& timer : timers) {
+        double totalMs = timer.second.nanoseconds / 1e6;
+        double meanUs = timer.second.calls > 0 ? timer.second.nanoseconds / 1e3 / timer.second.calls : 0.0;
+        out << separator << "    ";
+        writeJsonString(out, timer.first.c_str());
+        out << ": {\"calls\": " << timer.second.calls << ", \"total_ms\": " << totalMs << ", \"mean_us\": " << meanUs << "}";
+        separator = ",\n";
+    }
+    out << (timers.empty() ? "" : "\n  ") << "},\n  \"counters\": {";
+    separator = "\n";
+    for (const auto& counter : counters) {
+        out << separator << "    ";
+        writeJsonString(out, counter.first.c_str());
+        out << ": " << counter.second;
+        separator = ",\n";
+    }
+    out << (counters.empty() ? "" : "\n  ") << "}\n}\n";
+}
+
+bool Profiler::writeJson(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    writeJson(file);
+    return file.good();
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Встроенная инструментация горячих путей: таймеры областей и счётчики событий.
+// Макросы GRAPH_PROFILE_SCOPE и GRAPH_PROFILE_COUNT порождают код только при сборке с GRAPH_PROFILING
+// (опция CMake GRAPH_PROFILING); иначе они раскрываются в пустую инструкцию, а выражение количества
+// не вычисляется. Каждое место замера — статический объект, который регистрируется при первом
+// проходе; дальше замер стоит двух чтений часов (таймер) или одного атомарного сложения (счётчик).
+
+// Таймер одного места в коде: число входов и суммарное время
+struct ProfileTimerSite {
+    const char* name;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> nanoseconds;
+    ProfileTimerSite* next;
+
+    explicit ProfileTimerSite(const char* name);
+};
+
+// Счётчик событий; одно имя может встречаться в нескольких местах — в отчёте значения складываются
+struct ProfileCounterSite {
+    const char* name;
+    std::atomic<uint64_t> value;
+    ProfileCounterSite* next;
+
+    explicit ProfileCounterSite(const char* name);
+};
+
+// Замер времени до конца области видимости
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileTimerSite& site) : m_site(site), m_start(std::chrono::steady_clock::now()) {}
+    ~ProfileScope() {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_site.calls.fetch_add(1, std::memory_order_relaxed);
+        m_site.nanoseconds.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+            std::memory_order_relaxed);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileTimerSite& m_site;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Отчёт по всем зарегистрированным местам замера
+class Profiler {
+public:
+    // Собрана ли программа с инструментацией
+    static bool enabled();
+
+    // Обнуление всех таймеров и счётчиков
+    static void reset();
+
+    // Отчёт JSON: {"enabled": ..., "timers": {имя: {calls, total_ms, mean_us}}, "counters": {имя: значение}};
+    // имена отсортированы, поэтому отчёты разных запусков удобно сравнивать построчно
+    static void writeJson(std::ostream& out);
+    static bool writeJson(const std::string& filename);
+
+    static void registerSite(ProfileTimerSite& site);
+    static void registerSite(ProfileCounterSite& site);
+};
+
+#ifdef GRAPH_PROFILING
+#define GRAPH_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GRAPH_PROFILE_CONCAT(a, b) GRAPH_PROFILE_CONCAT_IMPL(a, b)
+#define GRAPH_PROFILE_SCOPE(name) \
+    static ProfileTimerSite GRAPH_PROFILE_CONCAT(profileSite, __LINE__)(name); \
+    ProfileScope GRAPH_PROFILE_CONCAT(profileScope, __LINE__)(GRAPH_PROFILE_CONCAT(profileSite, __LINE__))
+#define GRAPH_PROFILE_COUNT(name, amount) \
+    do { \
+        static ProfileCounterSite profileCounter(name); \
+        profileCounter.value.fetch_add(static_cast<uint64_t>(amount), std::memory_order_relaxed); \
+    } while (0)
+#else
+#define GRAPH_PROFILE_SCOPE(name) ((void)0)
+// sizeof не вычисляет выражение, но переменные в нём считаются использованными
+#define GRAPH_PROFILE_COUNT(name, amount) ((void)sizeof(amount))
+#endif
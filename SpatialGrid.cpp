@@ -0,0 +1,89 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(int width, int height, int cellSize) : m_cellSize(std::max(cellSize, 1)) {
+    m_columns = std::max((width + m_cellSize - 1) / m_cellSize, 1);
+    m_rows = std::max((height + m_cellSize - 1) / m_cellSize, 1);
+    m_cells.resize(static_cast<size_t>(m_columns) * m_rows);
+}
+
+int SpatialGrid::clampColumn(int x) const {
+    return std::min(std::max(x, 0) / m_cellSize, m_columns - 1);
+}
+
+int SpatialGrid::clampRow(int y) const {
+    return std::min(std::max(y, 0) / m_cellSize, m_rows - 1);
+}
+
+void SpatialGrid::rectCells(int x0, int y0, int x1, int y1, std::vector<uint32_t>& cells) const {
+    int lastColumn = clampColumn(x1);
+    int lastRow = clampRow(y1);
+    for (int row = clampRow(y0); row <= lastRow; ++row) {
+        for (int column = clampColumn(x0); column <= lastColumn; ++column) {
+            cells.push_back(static_cast<uint32_t>(row * m_columns + column));
+        }
+    }
+}
+
+void SpatialGrid::segmentCells(int x0, int y0, int x1, int y1, std::vector<uint32_t>& cells) const {
+    // По каждому столбцу ячеек берётся отрезок y, который прямая проходит внутри столбца,
+    // с запасом в полпикселя на толщину линии
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    const int firstColumn = clampColumn(x0);
+    const int lastColumn = clampColumn(x1);
+    const double slope = x1 != x0 ? static_cast<double>(y1 - y0) / (x1 - x0) : 0;
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+        // Крайние столбцы отрезка уходят до его концов, в том числе за пределы холста
+        double left = column == firstColumn ? x0 : column * m_cellSize - 0.5;
+        double right = column == lastColumn ? x1 : (column + 1) * m_cellSize - 0.5;
+        double yLeft = x1 != x0 ? y0 + (left - x0) * slope : y0;
+        double yRight = x1 != x0 ? y0 + (right - x0) * slope : y1;
+        int top = static_cast<int>(std::floor(std::min(yLeft, yRight) - 0.5));
+        int bottom = static_cast<int>(std::ceil(std::max(yLeft, yRight) + 0.5));
+        int lastRow = clampRow(bottom);
+        for (int row = clampRow(top); row <= lastRow; ++row) {
+            cells.push_back(static_cast<uint32_t>(row * m_columns + column));
+        }
+    }
+}
+
+uint32_t SpatialGrid::pointCell(double x, double y) const {
+    double column = std::floor((x + 0.5) / m_cellSize);
+    double row = std::floor((y + 0.5) / m_cellSize);
+    column = std::min(std::max(column, 0.0), static_cast<double>(m_columns - 1));
+    row = std::min(std::max(row, 0.0), static_cast<double>(m_rows - 1));
+    return static_cast<uint32_t>(static_cast<int>(row) * m_columns + static_cast<int>(column));
+}
+
+void SpatialGrid::insert(uint32_t item, const std::vector<uint32_t>& cells) {
+    for (uint32_t cell : cells) {
+        m_cells[cell].push_back(item);
+    }
+}
+
+void SpatialGrid::insertRect(uint32_t item, int x0, int y0, int x1, int y1) {
+    m_scratch.clear();
+    rectCells(x0, y0, x1, y1, m_scratch);
+    insert(item, m_scratch);
+}
+
+void SpatialGrid::insertSegment(uint32_t item, int x0, int y0, int x1, int y1) {
+    m_scratch.clear();
+    segmentCells(x0, y0, x1, y1, m_scratch);
+    insert(item, m_scratch);
+}
+
+void SpatialGrid::insertSegment(uint32_t item, int x0, int y0, int x1, int y1, size_t cellLimit) {
+    m_scratch.clear();
+    segmentCells(x0, y0, x1, y1, m_scratch);
+    for (uint32_t cell : m_scratch) {
+        if (m_cells[cell].size() < cellLimit) {
+            m_cells[cell].push_back(item);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Равномерная сетка корзин над холстом width x height с квадратными ячейками cellSize x cellSize.
+// Элемент (номер прямоугольника или отрезка) записывается во все ячейки, которых касается, и запрос
+// просматривает только ячейки своей области. Элементы можно добавлять по ходу работы.
+// Координаты за пределами холста прижимаются к крайним ячейкам
+class SpatialGrid {
+public:
+    SpatialGrid(int width, int height, int cellSize);
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+
+    // Номера ячеек (row * columns + column), которых касается прямоугольник [x0, x1] x [y0, y1]
+    // (границы включительно) или отрезок; номера добавляются в cells
+    void rectCells(int x0, int y0, int x1, int y1, std::vector<uint32_t>& cells) const;
+    void segmentCells(int x0, int y0, int x1, int y1, std::vector<uint32_t>& cells) const;
+    // Ячейка точки с дробными координатами: столбец c занимает [c * cellSize - 0.5, (c + 1) * cellSize - 0.5),
+    // как пиксели, по которым считают ячейки rectCells и segmentCells
+    uint32_t pointCell(double x, double y) const;
+
+    void insert(uint32_t item, const std::vector<uint32_t>& cells);
+    void insertRect(uint32_t item, int x0, int y0, int x1, int y1);
+    void insertSegment(uint32_t item, int x0, int y0, int x1, int y1);
+    // То же с ограничением заполнения: в ячейки, где уже cellLimit элементов, элемент не записывается
+    void insertSegment(uint32_t item, int x0, int y0, int x1, int y1, size_t cellLimit);
+
+    // Элементы ячейки в порядке вставки
+    const std::vector<uint32_t>& cell(uint32_t cell) const { return m_cells[cell]; }
+
+private:
+    int clampColumn(int x) const;
+    int clampRow(int y) const;
+
+    int m_cellSize;
+    int m_columns;
+    int m_rows;
+    std::vector<std::vector<uint32_t>> m_cells;
+    std::vector<uint32_t> m_scratch; // Ячейки последней вставки
+};
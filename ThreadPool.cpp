@@ -0,0 +1,79 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads)
+    : m_task(nullptr), m_count(0), m_next(0), m_generation(0), m_busy(0), m_stop(false) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (m_workers.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_busy = m_workers.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    drain();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::workerLoop() {
+    size_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::drain() {
+    // Задания раздаются по одному через атомарный счётчик, поэтому быстрые потоки берут больше
+    for (size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1)) {
+        (*m_task)(i);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул рабочих потоков для параллельной обработки независимых заданий с номерами 0..count-1.
+// Вызывающий поток участвует в работе, поэтому пул из одного потока не создаёт рабочих потоков.
+class ThreadPool {
+public:
+    // threads == 0 — по числу аппаратных потоков
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return m_workers.size() + 1; }
+
+    // Выполнение task(i) для всех i из [0, count); возвращается после завершения всех заданий
+    void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    void workerLoop();
+    void drain();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t)>* m_task; // Текущая пачка заданий
+    size_t m_count;
+    std::atomic<size_t> m_next; // Номер следующего невыданного задания
+    size_t m_generation; // Номер пачки: рабочие просыпаются при его изменении
+    size_t m_busy; // Рабочие, ещё обрабатывающие текущую пачку
+    bool m_stop;
+};
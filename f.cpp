@@ -1,56 +1,154 @@
+#include <algorithm>
 #include <iostream>
 #include "BMPGenerator.h"
 #include "FileReader.h"
+#include "BatchRunner.h"
+#include "BinaryGraph.h"
+#include "ForceLayout.h"
+#include "GraphIndex.h"
+#include "PlanarLayout.h"
+#include "Profiler.h"
 
+int main(int argc, char* argv[]) {
+    // Отчёт инструментации в JSON по завершении (сборка с GRAPH_PROFILING), в любом режиме:
+    // GraphVisualization ... --profile report.json
+    std::string profileFile;
+    if (argc >= 3 && std::string(argv[argc - 2]) == "--profile") {
+        profileFile = argv[argc - 1];
+        argc -= 2;
+        if (!Profiler::enabled()) {
+            std::cerr << "Warning: built without GRAPH_PROFILING, the profile report will be empty." << std::endl;
+        }
+    }
+    // Формат выходного изображения: GraphVisualization ... --format png (bmp, rle8, png; по умолчанию bmp).
+    // Файл называется graph.png или graph.bmp
+    ImageFormat outputFormat = ImageFormat::Bmp;
+    if (argc >= 3 && std::string(argv[argc - 2]) == "--format") {
+        if (!parseImageFormat(argv[argc - 1], outputFormat)) {
+            std::cerr << "Unknown image format: " << argv[argc - 1] << " (expected bmp, rle8 or png)" << std::endl;
+            return 1;
+        }
+        argc -= 2;
+    }
+    const std::string outputFile = std::string("graph.") + imageFormatExtension(outputFormat);
+    auto finish = [&](int code) {
+        if (!profileFile.empty() && !Profiler::writeJson(profileFile)) {
+            return 1;
+        }
+        return code;
+    };
 
-// Шаблонная функция для преобразования значения в строку
-template<typename T>
-std::string to_string(T value) {
-    std::ostringstream os;
-    os << value;
-    return os.str();
-}
+    // Однократное преобразование текстового графа в двоичный формат:
+    // GraphVisualization --convert graphs_data.txt edge_data.txt graph.bin
+    if (argc == 5 && std::string(argv[1]) == "--convert") {
+        if (!convertTextGraphToBinary(argv[2], argv[3], argv[4])) {
+            std::cerr << "Conversion failed." << std::endl;
+            return finish(1);
+        }
+        return finish(0);
+    }
 
-int main() {
-    int numVertices, width, height;
+    // Пакетная обработка графов из манифеста (строки «заголовок рёбра выходной_файл»):
+    // GraphVisualization --batch manifest.txt
+    if (argc == 3 && std::string(argv[1]) == "--batch") {
+        std::vector<BatchEntry> entries;
+        if (!BatchRunner::readManifest(argv[2], entries)) {
+            return finish(1);
+        }
+        BatchRunner runner;
+        size_t written = runner.run(entries);
+        runner.printReport(std::cout);
+        return finish(written == entries.size() ? 0 : 1);
+    }
 
-    readInputFromFile("graphs_data.txt", numVertices, width, height);
+    // Файлы графа можно передать аргументами; двоичный файл содержит и заголовок, и рёбра
+    std::string headerFile = argc > 1 ? argv[1] : "graphs_data.txt";
+    std::string edgeFile = argc > 2 ? argv[2] : (argc > 1 ? headerFile : "test1.txt");
 
-    std::vector<Vertex> vertices; // Вектор вершин графа
-    std::vector<Edge> edges; // Вектор ребер графа
+    int numVertices, width, height;
 
-    srand(time(NULL)); // Инициализация генератора случайных чисел 
+    readInputFromFile(headerFile, numVertices, width, height);
 
-    // Генерация случайных координат для вершин графа и их меток
-    for (int i = 0; i < numVertices; ++i) {
-        vertices.push_back({ rand() % width, rand() % height, to_string(i) });
-    }
+    std::vector<Vertex> vertices; // Вектор вершин графа
+    GraphStorage graph; // Хранилище графа: рёбра читаются прямо в него, вершины добавляются после укладки
 
-    readEdgesFromFile("test1.txt", edges);
+    // Координаты задаёт укладка после чтения рёбер, метки (номера вершин) — хранилище графа
+    vertices.resize(std::max(numVertices, 0));
 
-    int numEdges = edges.size(); // Количество ребер графа
-    int numFaces = 2 - numVertices + numEdges; // Количество граней в графе
+    readEdgesFromFileFast(edgeFile, graph, numVertices); // Рёбра с неверными номерами вершин пропускаются
 
-    if (numFaces == 2) {
-        std::cout << "Graph is planar." << std::endl;
+    // Очень плотный граф рисуется картой плотности: отдельные линии, круги и метки на нём неразличимы.
+    // Решение принимается по числу рёбер до укладки: для карты плотности подграф Куратовского не ищется,
+    // а силовая укладка ограничена kDensityLayoutIterations итерациями (на 100000 вершинах и 2.5M рёбрах
+    // полный бюджет занимал большую часть времени работы)
+    const bool densityRender = graph.edgeCount() >= BMPGenerator::kDensityRenderThreshold;
 
-        // Проверка наличия подграфов K5 и K33
-        BMPGenerator bmpGenerator(width, height, vertices, edges);
-        if (!bmpGenerator.containsK33()) {
-            bmpGenerator.modifyForK5(); // Изменение графа для удаления K5
-            std::cout << "Graph contains K33. It is not planar." << std::endl;
-            //bmpGenerator.generate("graph.bmp");
+    // Решение о планарности принимает проверка с предварительным фильтром. Планарный граф рисуется
+    // по своей укладке без пересечений, остальные — силовой укладкой, и найденный подграф K5 или K33
+    // выделяется цветом. Поиск подграфа ограничен (kWitnessSearchEdges, kWitnessSearchWork): на большом
+    // графе он может не дать результата
+    PlanarityResult planarity = testPlanarity(GraphIndex(vertices.size(), graph.endpoints(), false), !densityRender);
+    if (planarity.planar) {
+        if (!PlanarLayout().run(vertices, planarity.embedding, width, height)) {
+            std::cerr << "Warning: the planar grid layout of " << vertices.size() << " vertices does not fit "
+                << width << "x" << height << " pixels; rounding to pixels may introduce edge crossings." << std::endl;
         }
-        else if (!bmpGenerator.containsK5()) {
-            bmpGenerator.modifyForK5(); // Изменение графа для удаления K33
-            std::cout << "Graph contains K5. It is not planar." << std::endl;
-           // bmpGenerator.generate("graph.bmp");
+    }
+    else {
+        ForceLayoutSettings settings; // Фиксированное зерно: одинаковый граф всегда даёт одинаковую картинку
+        if (densityRender) {
+            settings.iterations = BMPGenerator::kDensityLayoutIterations;
+        }
+        ForceLayout(settings).run(vertices, graph.endpoints(), width, height);
+    }
+
+    // Уложенные вершины переносятся в хранилище и дальше не нужны
+    graph.appendVertices(vertices);
+    std::vector<Vertex>().swap(vertices);
+    graph.setIndexLabels();
+    BMPGenerator bmpGenerator(width, height, std::move(graph));
+    bmpGenerator.setOutputFormat(outputFormat);
+    if (densityRender) {
+        std::cout << (planarity.planar ? "Graph is planar." : "Graph is not planar.") << std::endl;
+        std::cout << "Dense graph: rendering edge density." << std::endl;
+        bmpGenerator.generateDensity(outputFile);
+        return finish(0);
+    }
+    bmpGenerator.placeLabels(); // Метки без наложений друг на друга и на круги вершин
+    // Точный подсчёт пересечений ограничен kCrossingPairBudget проверками пар рёбер: у плотной силовой
+    // укладки пересечений порядка E^2, и сверх бюджета печатается оценка по случайной выборке пар
+    auto printCrossings = [&](const char* title) {
+        CrossingEstimate crossings = bmpGenerator.estimateCrossings(BMPGenerator::kCrossingPairBudget);
+        std::cout << title << ": ";
+        if (crossings.exact) {
+            std::cout << crossings.count << std::endl;
         }
         else {
-            std::cout << "And without k5 and k33." << std::endl;
-            bmpGenerator.generate("graph.bmp"); // Генерация изображения графа
+            std::cout << "about " << crossings.count << " (estimated from " << crossings.sampled << " sampled edge pairs)" << std::endl;
         }
-
-        return 0;
+    };
+    printCrossings("Edge crossings");
+    if (planarity.planar) {
+        std::cout << "Graph is planar." << std::endl;
+        std::cout << "And without k5 and k33." << std::endl;
+        bmpGenerator.generate(outputFile); // Генерация изображения графа
+    }
+    else if (planarity.kuratowski.type == KuratowskiType::K33) {
+        bmpGenerator.modifyForK33(planarity.kuratowski); // Изменение графа для удаления K33
+        std::cout << "Graph contains K33. It is not planar." << std::endl;
+        printCrossings("Edge crossings after modification");
+        bmpGenerator.generateColor(outputFile); // Изображение с выделенным подграфом K33
+    }
+    else if (planarity.kuratowski.type == KuratowskiType::K5) {
+        bmpGenerator.modifyForK5(planarity.kuratowski); // Изменение графа для удаления K5
+        std::cout << "Graph contains K5. It is not planar." << std::endl;
+        printCrossings("Edge crossings after modification");
+        bmpGenerator.generateColor(outputFile); // Изображение с выделенным подграфом K5
+    }
+    else {
+        std::cout << "Graph is not planar." << std::endl;
+        std::cout << "Kuratowski subgraph search limit exceeded, nothing is highlighted." << std::endl;
+        bmpGenerator.generate(outputFile);
     }
+    return finish(0);
 }